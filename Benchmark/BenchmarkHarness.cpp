@@ -0,0 +1,482 @@
+#include "BenchmarkHarness.hpp"
+#include "ShapeDetector/AllocationTracker.hpp"
+#include "ShapeDetector/Degradation.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <omp.h>
+#include <sstream>
+#include <stdexcept>
+
+constexpr double SHAPES_PER_MEGAPIXEL_LOW = 16.0;
+constexpr double SHAPES_PER_MEGAPIXEL_MEDIUM = 64.0;
+constexpr double SHAPES_PER_MEGAPIXEL_HIGH = 256.0;
+constexpr int MAX_CALIBRATED_ITERATIONS = 1 << 20;
+
+namespace {
+
+std::vector<std::string> SplitList(const std::string &text) {
+  std::vector<std::string> items;
+  std::stringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (!item.empty())
+      items.push_back(item);
+  }
+  return items;
+}
+
+// Sizes must be positive and durations or tolerances not negative; out of
+// range values throw like unparsable ones so Parse reports both the same way
+int ParsePositive(const std::string &text) {
+  const int value = std::stoi(text);
+  if (value <= 0)
+    throw std::out_of_range(text);
+  return value;
+}
+
+double ParseNonNegative(const std::string &text) {
+  const double value = std::stod(text);
+  if (value < 0.0)
+    throw std::out_of_range(text);
+  return value;
+}
+
+void PrintUsage(const char *program) {
+  std::cerr
+      << "Usage: " << program << " [options]\n"
+      << "  --suite NAME[,NAME]   micro, regression, scaling, pareto, "
+         "latency, stress\n"
+      << "                        (default: micro,regression)\n"
+      << "  --filter TEXT         only cases whose name contains TEXT\n"
+      << "  --sizes N[,N]         square frame sizes (default 256,512,1024,"
+         "2048)\n"
+      << "  --densities D[,D]     low, medium, high (default all)\n"
+      << "  --threads N[,N]       scaling suite thread counts (default 1, 2, "
+         "4 ... max)\n"
+      << "  --resolutions R[,R]   scaling suite frames: vga, hd, fhd, 4k, 8k "
+         "(default all)\n"
+      << "  --repetitions N       timed samples per case (default 10)\n"
+      << "  --warmup N            untimed calls per case (default 2)\n"
+      << "  --min-sample-ms X     minimum duration of one sample (default 2)\n"
+      << "  --quick               small sizes and few repetitions\n"
+      << "  --json PATH           write results as JSON\n"
+      << "  --csv PATH            write results as CSV\n"
+      << "  --trace PATH          write detector spans as Chrome trace JSON\n"
+      << "  --list                list case names without timing\n"
+      << "  --counters            report IPC and misses per item from "
+         "hardware counters\n"
+      << "  --baseline PATH       fail when the regression suite is worse "
+         "than PATH\n"
+      << "  --record-baseline PATH  write regression results as a new "
+         "baseline\n"
+      << "  --latency-tolerance X   allowed latency increase (default "
+         "0.15 = 15%)\n"
+      << "  --accuracy-tolerance X  allowed precision/recall drop (default "
+         "0.02)\n"
+      << "  --pareto-csv PATH     write every pareto configuration as CSV\n"
+      << "  --stress-budget X     stress suite worst-case ms per megapixel "
+         "(default 2000)\n"
+      << "  --frames N            latency suite frames (default 500)\n"
+      << "  --hgrm-dir DIR        write latency histograms as HdrHistogram "
+         "text\n"
+      << "Sizes must be positive; X values must not be negative.\n";
+}
+
+double ItemsPerSecond(const BenchmarkResult &result) {
+  return (result.median > 0.0 && result.benchmark.items > 0.0)
+             ? result.benchmark.items * 1e9 / result.median
+             : 0.0;
+}
+
+std::string FormatDuration(double nanoseconds) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(2);
+  if (nanoseconds < 1e3)
+    out << nanoseconds << " ns";
+  else if (nanoseconds < 1e6)
+    out << nanoseconds / 1e3 << " us";
+  else if (nanoseconds < 1e9)
+    out << nanoseconds / 1e6 << " ms";
+  else
+    out << nanoseconds / 1e9 << " s";
+  return out.str();
+}
+
+// Event count per work unit, e.g. cache misses per pixel
+double PerItem(const BenchmarkResult &result, PerfEvent event) {
+  return (result.counters.Has(event) && result.benchmark.items > 0.0)
+             ? result.counters[event] / result.benchmark.items
+             : 0.0;
+}
+
+std::string JsonEscape(const std::string &text) {
+  std::string escaped;
+  for (char c : text) {
+    if (c == '"' || c == '\\')
+      escaped += '\\';
+    escaped += c;
+  }
+  return escaped;
+}
+
+} // namespace
+
+bool BenchmarkOptions::Parse(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+
+    // The parsers throw on values that are not numbers, do not fit or are
+    // out of range
+    try {
+      if (arg == "--quick") {
+        sizes = {256, 512};
+        resolutions = {"vga", "hd"};
+        repetitions = 5;
+        frames = 100;
+        warmup = 1;
+        minSampleMs = 1.0;
+      } else if (arg == "--list") {
+        list = true;
+      } else if (arg == "--counters") {
+        counters = true;
+      } else if (arg == "--help" || arg == "-h") {
+        PrintUsage(argv[0]);
+        return false;
+      } else if (hasValue && arg == "--suite") {
+        for (const auto &suite : SplitList(argv[++i]))
+          suites.push_back(suite);
+      } else if (hasValue && arg == "--filter") {
+        filter = argv[++i];
+      } else if (hasValue && arg == "--sizes") {
+        sizes.clear();
+        for (const auto &size : SplitList(argv[++i]))
+          sizes.push_back(ParsePositive(size));
+      } else if (hasValue && arg == "--densities") {
+        densities = SplitList(argv[++i]);
+      } else if (hasValue && arg == "--threads") {
+        threads.clear();
+        for (const auto &count : SplitList(argv[++i]))
+          threads.push_back(std::max(1, std::stoi(count)));
+      } else if (hasValue && arg == "--resolutions") {
+        resolutions = SplitList(argv[++i]);
+      } else if (hasValue && arg == "--repetitions") {
+        repetitions = std::max(1, std::stoi(argv[++i]));
+      } else if (hasValue && arg == "--warmup") {
+        warmup = std::max(0, std::stoi(argv[++i]));
+      } else if (hasValue && arg == "--min-sample-ms") {
+        minSampleMs = ParseNonNegative(argv[++i]);
+      } else if (hasValue && arg == "--json") {
+        jsonPath = argv[++i];
+      } else if (hasValue && arg == "--csv") {
+        csvPath = argv[++i];
+      } else if (hasValue && arg == "--trace") {
+        tracePath = argv[++i];
+      } else if (hasValue && arg == "--baseline") {
+        baselinePath = argv[++i];
+      } else if (hasValue && arg == "--record-baseline") {
+        recordPath = argv[++i];
+      } else if (hasValue && arg == "--latency-tolerance") {
+        latencyTolerance = ParseNonNegative(argv[++i]);
+      } else if (hasValue && arg == "--accuracy-tolerance") {
+        accuracyTolerance = ParseNonNegative(argv[++i]);
+      } else if (hasValue && arg == "--pareto-csv") {
+        paretoPath = argv[++i];
+      } else if (hasValue && arg == "--stress-budget") {
+        stressBudgetMs = ParseNonNegative(argv[++i]);
+      } else if (hasValue && arg == "--frames") {
+        frames = std::max(1, std::stoi(argv[++i]));
+      } else if (hasValue && arg == "--hgrm-dir") {
+        histogramDir = argv[++i];
+      } else {
+        std::cerr << "Error: Unknown argument " << arg << std::endl;
+        PrintUsage(argv[0]);
+        return false;
+      }
+    } catch (const std::exception &) {
+      std::cerr << "Error: Invalid value " << argv[i] << " for " << arg
+                << std::endl;
+      PrintUsage(argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool BenchmarkOptions::WantsSuite(const std::string &suite,
+                                  bool byDefault) const {
+  if (suites.empty())
+    return byDefault;
+  return std::find(suites.begin(), suites.end(), suite) != suites.end();
+}
+
+BenchmarkRunner::BenchmarkRunner(const BenchmarkOptions &options)
+    : options_(options) {
+  if (options_.counters && !options_.list && !counters_.Open()) {
+    std::cerr << "Warning: Hardware counters unavailable ("
+              << counters_.Error() << "), reporting wall time only"
+              << std::endl;
+  }
+}
+
+void BenchmarkRunner::PrintHeader() {
+  if (headerPrinted_)
+    return;
+  headerPrinted_ = true;
+  std::cout << std::left << std::setw(44) << "case" << std::right
+            << std::setw(6) << "size" << std::setw(8) << "density"
+            << std::setw(13) << "median" << "  stddev%   throughput";
+  if (AllocationTracker::Available())
+    std::cout << "  allocs/call";
+  if (CountersEnabled())
+    std::cout << "    IPC  miss/item  br-miss/item";
+  std::cout << "\n";
+}
+
+bool BenchmarkRunner::Selected(const std::string &name) const {
+  return options_.filter.empty() ||
+         name.find(options_.filter) != std::string::npos;
+}
+
+void BenchmarkRunner::Run(const BenchmarkCase &benchmark,
+                          const std::function<void()> &body) {
+  if (!Selected(benchmark.name))
+    return;
+
+  if (options_.list) {
+    std::cout << benchmark.name << " size=" << benchmark.size
+              << " density=" << benchmark.density << "\n";
+    return;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  auto elapsedNs = [](Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start)
+        .count();
+  };
+
+  for (int i = 0; i < options_.warmup; ++i) {
+    body();
+  }
+
+  // Calibrate so one sample lasts at least minSampleMs; fast kernels are
+  // batched so clock resolution does not dominate
+  auto start = Clock::now();
+  body();
+  const double single = std::max(elapsedNs(start), 1.0);
+  const int iterations = static_cast<int>(std::clamp(
+      std::ceil(options_.minSampleMs * 1e6 / single), 1.0,
+      static_cast<double>(MAX_CALIBRATED_ITERATIONS)));
+
+  BenchmarkResult result;
+  result.benchmark = benchmark;
+  result.iterations = iterations;
+  result.samples.reserve(options_.repetitions);
+
+  // Counters span all timed samples; the two ioctls per case stay outside
+  // the sample clocks
+  const double calls = static_cast<double>(options_.repetitions) * iterations;
+  const AllocationScope allocations;
+  if (CountersEnabled())
+    counters_.Start();
+  for (int r = 0; r < options_.repetitions; ++r) {
+    start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      body();
+    }
+    result.samples.push_back(elapsedNs(start) / iterations);
+  }
+  if (CountersEnabled())
+    result.counters = counters_.Stop().Scaled(calls);
+  const AllocationCounts heap = allocations.Counts();
+  result.allocations = heap.allocations / calls;
+  result.allocatedBytes = heap.bytes / calls;
+
+  std::vector<double> sorted = result.samples;
+  std::sort(sorted.begin(), sorted.end());
+  result.min = sorted.front();
+  result.max = sorted.back();
+  result.median = Percentile(sorted, 0.5);
+  result.p90 = Percentile(sorted, 0.9);
+
+  double sum = 0.0;
+  for (double sample : sorted)
+    sum += sample;
+  result.mean = sum / sorted.size();
+
+  double variance = 0.0;
+  for (double sample : sorted)
+    variance += (sample - result.mean) * (sample - result.mean);
+  result.stddev =
+      sorted.size() > 1 ? std::sqrt(variance / (sorted.size() - 1)) : 0.0;
+
+  PrintHeader();
+  std::cout << std::left << std::setw(44) << benchmark.name << std::right
+            << std::setw(6) << benchmark.size << std::setw(8)
+            << benchmark.density << std::setw(13)
+            << FormatDuration(result.median) << " +/- " << std::setw(5)
+            << std::fixed << std::setprecision(1)
+            << (result.mean > 0 ? 100.0 * result.stddev / result.mean : 0.0)
+            << "%";
+  if (const double rate = ItemsPerSecond(result); rate > 0.0) {
+    std::cout << std::setw(12) << std::setprecision(2) << rate / 1e6
+              << " M/s";
+  } else if (AllocationTracker::Available() || CountersEnabled()) {
+    std::cout << std::setw(16) << "";
+  }
+  if (AllocationTracker::Available())
+    std::cout << std::setprecision(1) << std::setw(13) << result.allocations;
+  if (CountersEnabled()) {
+    std::cout << std::setprecision(2) << std::setw(7) << result.counters.Ipc()
+              << std::setprecision(3) << std::setw(11)
+              << PerItem(result, PerfEvent::CacheMisses) << std::setw(14)
+              << PerItem(result, PerfEvent::BranchMisses);
+  }
+  std::cout << std::endl;
+
+  results_.push_back(std::move(result));
+}
+
+void BenchmarkRunner::WriteJson(std::ostream &out) const {
+  out << "{\n  \"context\": {\"threads\": " << omp_get_max_threads()
+      << ", \"warmup\": " << options_.warmup
+      << ", \"repetitions\": " << options_.repetitions << "},\n";
+  out << "  \"benchmarks\": [\n";
+  out << std::setprecision(6);
+  for (size_t i = 0; i < results_.size(); ++i) {
+    const BenchmarkResult &r = results_[i];
+    out << "    {\"name\": \"" << JsonEscape(r.benchmark.name)
+        << "\", \"size\": " << r.benchmark.size << ", \"density\": \""
+        << JsonEscape(r.benchmark.density)
+        << "\", \"items\": " << r.benchmark.items
+        << ", \"iterations\": " << r.iterations
+        << ", \"min_ns\": " << r.min << ", \"median_ns\": " << r.median
+        << ", \"mean_ns\": " << r.mean << ", \"stddev_ns\": " << r.stddev
+        << ", \"p90_ns\": " << r.p90 << ", \"max_ns\": " << r.max
+        << ", \"items_per_second\": " << ItemsPerSecond(r)
+        << ", \"allocations_per_call\": " << r.allocations
+        << ", \"allocated_bytes_per_call\": " << r.allocatedBytes;
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+      const PerfEvent event = static_cast<PerfEvent>(e);
+      if (r.counters.Has(event)) {
+        out << ", \"" << PerfCounters::Name(event)
+            << "\": " << r.counters[event];
+      }
+    }
+    if (r.counters.Has(PerfEvent::Cycles)) {
+      out << ", \"ipc\": " << r.counters.Ipc()
+          << ", \"cache_misses_per_item\": "
+          << PerItem(r, PerfEvent::CacheMisses)
+          << ", \"branch_misses_per_item\": "
+          << PerItem(r, PerfEvent::BranchMisses);
+    }
+    out << "}" << (i + 1 < results_.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+}
+
+void BenchmarkRunner::WriteCsv(std::ostream &out) const {
+  // Counter columns are always present; events that were not measured
+  // are -1
+  out << "name,size,density,items,iterations,min_ns,median_ns,mean_ns,"
+         "stddev_ns,p90_ns,max_ns,items_per_second,allocations_per_call,"
+         "allocated_bytes_per_call,cycles,instructions,cache_misses,"
+         "branch_misses,ipc\n";
+  out << std::setprecision(6);
+  for (const BenchmarkResult &r : results_) {
+    out << r.benchmark.name << "," << r.benchmark.size << ","
+        << r.benchmark.density << "," << r.benchmark.items << ","
+        << r.iterations << "," << r.min << "," << r.median << "," << r.mean
+        << "," << r.stddev << "," << r.p90 << "," << r.max << ","
+        << ItemsPerSecond(r) << "," << r.allocations << ","
+        << r.allocatedBytes;
+    for (double value : r.counters.values)
+      out << "," << value;
+    out << "," << r.counters.Ipc() << "\n";
+  }
+}
+
+bool BenchmarkRunner::WriteReports() const {
+  bool ok = true;
+  if (!options_.jsonPath.empty()) {
+    std::ofstream file(options_.jsonPath);
+    if (!file) {
+      std::cerr << "Error: Cannot write " << options_.jsonPath << std::endl;
+      ok = false;
+    } else {
+      WriteJson(file);
+    }
+  }
+  if (!options_.csvPath.empty()) {
+    std::ofstream file(options_.csvPath);
+    if (!file) {
+      std::cerr << "Error: Cannot write " << options_.csvPath << std::endl;
+      ok = false;
+    } else {
+      WriteCsv(file);
+    }
+  }
+  return ok;
+}
+
+double Percentile(const std::vector<double> &sorted, double fraction) {
+  if (sorted.empty())
+    return 0.0;
+  const double position = fraction * (sorted.size() - 1);
+  const size_t low = static_cast<size_t>(position);
+  const size_t high = std::min(low + 1, sorted.size() - 1);
+  const double weight = position - low;
+  return sorted[low] * (1.0 - weight) + sorted[high] * weight;
+}
+
+BenchmarkFrame MakeBenchmarkFrame(int size, const std::string &density,
+                                  uint64_t seed) {
+  return MakeBenchmarkFrame(size, size, density, seed);
+}
+
+BenchmarkFrame MakeBenchmarkFrame(int width, int height,
+                                  const std::string &density, uint64_t seed) {
+  double perMegapixel = SHAPES_PER_MEGAPIXEL_MEDIUM;
+  if (density == "low")
+    perMegapixel = SHAPES_PER_MEGAPIXEL_LOW;
+  else if (density == "high")
+    perMegapixel = SHAPES_PER_MEGAPIXEL_HIGH;
+
+  const double megapixels = static_cast<double>(width) * height / 1e6;
+  const int shapes = std::max(4, static_cast<int>(perMegapixel * megapixels));
+
+  SceneConfig config;
+  config.width = width;
+  config.height = height;
+  config.rectangleCount = shapes * 4 / 10;
+  config.circleCount = shapes * 3 / 10;
+  config.ellipseCount = shapes * 15 / 100;
+  config.distractorCount = shapes * 15 / 100;
+  config.minSize = 24;
+  config.maxSize = 64;
+  config.spacing = 6;
+
+  BenchmarkFrame frame{SceneGenerator(config).Generate(seed), Image(0, 0)};
+  frame.degraded = frame.scene.image;
+  Degradation::Apply(frame.degraded, DegradationConfig::Production(), seed);
+  return frame;
+}
+
+std::vector<Scene> MakeLabeledCorpus(int width, int height,
+                                     uint64_t firstSeed, int frames) {
+  SceneConfig config;
+  config.width = width;
+  config.height = height;
+
+  std::vector<Scene> corpus =
+      SceneGenerator(config).GenerateBatch(firstSeed, frames);
+  for (int i = 0; i < frames; ++i) {
+    Degradation::Apply(corpus[i].image, DegradationConfig::Production(),
+                       firstSeed + i);
+  }
+  return corpus;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "PerfCounters.hpp"
+#include "ShapeDetector/SceneGenerator.hpp"
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct BenchmarkOptions {
+  int warmup = 2;          // untimed calls before calibration
+  int repetitions = 10;    // timed samples per case
+  double minSampleMs = 2.0; // each sample repeats the body at least this long
+  std::string filter;      // run only cases whose name contains this
+  std::vector<std::string> suites;
+  std::vector<int> sizes = {256, 512, 1024, 2048};
+  std::vector<std::string> densities = {"low", "medium", "high"};
+  std::vector<int> threads; // scaling suite; empty means 1, 2, 4 ... max
+  std::vector<std::string> resolutions = {"vga", "hd", "fhd", "4k", "8k"};
+  std::string jsonPath;    // machine-readable results, skipped when empty
+  std::string csvPath;
+  std::string tracePath;   // Chrome trace of every detector call, if set
+  bool list = false;       // print case names instead of timing them
+  bool counters = false;   // read hardware counters around timed samples
+  std::string baselinePath; // regression baseline to compare against
+  std::string recordPath;   // where to write a new regression baseline
+  double latencyTolerance = 0.15; // allowed relative latency increase
+  double accuracyTolerance = 0.02; // allowed absolute precision/recall drop
+  std::string paretoPath; // every explored configuration as CSV, if set
+  double stressBudgetMs = 2000.0; // stress suite worst case per megapixel
+  int frames = 500;        // latency suite frames per run
+  std::string histogramDir; // latency suite .hgrm files, skipped when empty
+
+  // Returns false and prints usage on bad arguments
+  bool Parse(int argc, char **argv);
+  // Suites that are not run by default must be named with --suite
+  bool WantsSuite(const std::string &suite, bool byDefault = true) const;
+};
+
+struct BenchmarkCase {
+  std::string name;    // stage, e.g. "rectangle/preprocess/aggressive"
+  int size = 0;        // square frame side in pixels, 0 when not applicable
+  std::string density; // shape density of the frame, empty when not applicable
+  double items = 0;    // work units per call (pixels, points, contours)
+};
+
+struct BenchmarkResult {
+  BenchmarkCase benchmark;
+  int iterations = 0;          // body calls per sample
+  std::vector<double> samples; // nanoseconds per call
+  double min = 0, median = 0, mean = 0, stddev = 0, p90 = 0, max = 0;
+  PerfReading counters; // per call, over all timed samples
+  double allocations = 0; // heap allocations per call, all threads
+  double allocatedBytes = 0;
+};
+
+// Runs timed cases with warm-up, auto-calibrated batching and summary
+// statistics, then reports them as a table and optionally JSON or CSV
+class BenchmarkRunner {
+public:
+  explicit BenchmarkRunner(const BenchmarkOptions &options);
+
+  bool Selected(const std::string &name) const;
+  void Run(const BenchmarkCase &benchmark, const std::function<void()> &body);
+
+  const BenchmarkOptions &Options() const { return options_; }
+  const std::vector<BenchmarkResult> &Results() const { return results_; }
+
+  void WriteJson(std::ostream &out) const;
+  void WriteCsv(std::ostream &out) const;
+  // Writes the files requested on the command line
+  bool WriteReports() const;
+
+  // True when --counters was given and the counters could be opened
+  bool CountersEnabled() const { return counters_.Available(); }
+
+private:
+  void PrintHeader();
+
+  BenchmarkOptions options_;
+  std::vector<BenchmarkResult> results_;
+  PerfCounters counters_;
+  bool headerPrinted_ = false;
+};
+
+// Frame of a given size and density with its ground truth; the degraded
+// copy carries production-like noise
+struct BenchmarkFrame {
+  Scene scene;
+  Image degraded;
+};
+
+BenchmarkFrame MakeBenchmarkFrame(int size, const std::string &density,
+                                  uint64_t seed = 1);
+BenchmarkFrame MakeBenchmarkFrame(int width, int height,
+                                  const std::string &density,
+                                  uint64_t seed = 1);
+
+// Seeded scenes with their ground truth, each degraded with its own seed
+std::vector<Scene> MakeLabeledCorpus(int width, int height,
+                                     uint64_t firstSeed, int frames);
+
+// Linearly interpolated percentile of ascending samples, fraction in [0, 1]
+double Percentile(const std::vector<double> &sorted, double fraction);
+
+// Keeps the optimizer from discarding a result that is otherwise unused
+template <typename T> inline void KeepAlive(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
@@ -0,0 +1,39 @@
+#include "BenchmarkHarness.hpp"
+#include "BenchmarkSuites.hpp"
+#include "ShapeDetector/Trace.hpp"
+
+int main(int argc, char **argv) {
+  BenchmarkOptions options;
+  if (!options.Parse(argc, argv))
+    return 1;
+
+  BenchmarkRunner runner(options);
+
+  bool ok = true;
+
+  // Benchmarks repeat every call many times, so keep traced runs short,
+  // e.g. with --quick and a --filter
+  if (!options.tracePath.empty())
+    Trace::Start();
+
+  if (options.WantsSuite("micro"))
+    RunMicroBenchmarks(runner);
+  if (options.WantsSuite("regression") && !options.list)
+    ok = RunRegression(options) && ok;
+  if (options.WantsSuite("scaling", false))
+    RunScalingBenchmarks(runner);
+  if (options.WantsSuite("pareto", false) && !options.list)
+    ok = RunParetoExplorer(options) && ok;
+  if (options.WantsSuite("stress", false))
+    ok = RunStressBenchmarks(runner) && ok;
+  if (options.WantsSuite("latency", false) && !options.list)
+    ok = RunLatencySuite(options) && ok;
+
+  if (!options.tracePath.empty()) {
+    Trace::Stop();
+    ok = Trace::WriteChromeJson(options.tracePath) && ok;
+  }
+
+  ok = runner.WriteReports() && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "BenchmarkHarness.hpp"
+
+// Per-stage timings of every kernel, classifier step, renderer and writer
+void RunMicroBenchmarks(BenchmarkRunner &runner);
+
+// Latency percentiles and precision/recall over a fixed seeded corpus;
+// returns false when results regress past the baseline tolerances
+bool RunRegression(const BenchmarkOptions &options);
+
+// Detection speedup, parallel efficiency and pixels/s across thread counts,
+// resolutions from VGA to 8K and shape densities
+void RunScalingBenchmarks(BenchmarkRunner &runner);
+
+// Recall, precision and latency of every ordered subset of the rectangle
+// strategies under every set of approximation branches, and the Pareto
+// frontier among them; returns false when the CSV cannot be written
+bool RunParetoExplorer(const BenchmarkOptions &options);
+
+// Per-frame and per-stage latency histograms over a long run, with p50,
+// p99, p99.9 and max and the slowest frames; returns false when the
+// histogram files cannot be written
+bool RunLatencySuite(const BenchmarkOptions &options);
+
+// Detectors on adversarial inputs (checkerboards, noise, ragged blobs,
+// meshes, spirals); returns false when the slowest sample of any case
+// exceeds the per-megapixel budget
+bool RunStressBenchmarks(BenchmarkRunner &runner);
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "ShapeDetector/ContourSet.hpp"
+#include "ShapeDetector/RectangleDetector.hpp"
+#include "ShapeDetector/SphereDetector.hpp"
+#include <algorithm>
+#include <vector>
+
+// Friend of the detectors that exposes individual pipeline stages, so each
+// one can be timed on realistic inputs without widening the public API
+struct DetectorProbe {
+  static constexpr int STRATEGY_COUNT =
+      static_cast<int>(RectangleStrategy::Count);
+
+  static const char *StrategyName(int strategy) {
+    return RectangleDetector::StrategyName(
+        static_cast<RectangleStrategy>(strategy));
+  }
+
+  static Image Preprocess(const RectangleDetector &detector, int strategy,
+                          const Image &image) {
+    Image processed(image.width, image.height);
+    detector.Preprocess(static_cast<RectangleStrategy>(strategy), image,
+                        processed);
+    return processed;
+  }
+
+  static ContourSet FindContours(const RectangleDetector &detector,
+                                 const Image &binary) {
+    ContourSet contours;
+    detector.FindContours(binary, contours);
+    return contours;
+  }
+
+  // Filled regions as found by the scanline fill, before boundary extraction
+  static std::vector<std::vector<Point>>
+  FindRegions(const RectangleDetector &detector, const Image &binary) {
+    std::vector<std::vector<Point>> regions;
+    std::vector<std::vector<bool>> visited(
+        binary.height, std::vector<bool>(binary.width, false));
+    for (int y = 0; y < binary.height; ++y) {
+      for (int x = 0; x < binary.width; ++x) {
+        if (!visited[y][x] && binary.pixels[y][x] == 255) {
+          std::vector<Point> region;
+          detector.ScanlineFillContour(binary, x, y, region, visited);
+          regions.push_back(std::move(region));
+        }
+      }
+    }
+    return regions;
+  }
+
+  static std::vector<Point> ExtractBoundary(const RectangleDetector &detector,
+                                            const std::vector<Point> &region,
+                                            const Image &binary) {
+    ContourSet boundary;
+    detector.ExtractBoundary(region, binary, boundary);
+    boundary.Close();
+    return boundary.Points(0);
+  }
+
+  static std::vector<Point>
+  ApproximateContour(const RectangleDetector &detector,
+                     const ContourView &contour) {
+    std::vector<Point> approx;
+    detector.ApproximateContour(contour, detector.approxEpsilon_, approx);
+    return approx;
+  }
+
+  // Individual ApproximateContour branches
+  static std::vector<Point> MomentCorners(const RectangleDetector &detector,
+                                          const ContourView &contour) {
+    std::vector<Point> corners;
+    detector.FindRectangleCornersMomentBased(contour, corners);
+    return corners;
+  }
+
+  static std::vector<Point> HoughCorners(const RectangleDetector &detector,
+                                         const ContourView &contour) {
+    std::vector<Point> corners;
+    detector.FindRectangleUsingHoughLines(contour, corners);
+    return corners;
+  }
+
+  static std::vector<Point> CurvatureCorners(const RectangleDetector &detector,
+                                             const ContourView &contour) {
+    ContourSet smoothed;
+    std::vector<Point> corners;
+    detector.SmoothContourForRotation(contour, smoothed);
+    detector.FindCornersRotationInvariant(smoothed.View(0), corners);
+    return corners;
+  }
+
+  static std::vector<Point> DouglasPeucker(const RectangleDetector &detector,
+                                           const ContourView &contour) {
+    // Contours too short to simplify are kept whole
+    std::vector<bool> keep(contour.size(), contour.size() < 3);
+    if (contour.size() >= 3) {
+      const double epsilon = std::max(
+          detector.approxEpsilon_ * detector.CalculatePerimeter(contour), 2.0);
+      keep.front() = keep.back() = true;
+      detector.DouglasPeucker(contour, 0, contour.size() - 1, epsilon, keep);
+    }
+    std::vector<Point> approx;
+    for (size_t i = 0; i < contour.size(); ++i) {
+      if (keep[i])
+        approx.push_back(contour[i]);
+    }
+    return approx;
+  }
+
+  static std::vector<Point> ConvexHull(const RectangleDetector &detector,
+                                       const ContourView &points) {
+    std::vector<Point> hull;
+    detector.ConvexHull(points, hull);
+    return hull;
+  }
+
+  // Classifies contours and appends the accepted rectangles, as one
+  // strategy does before duplicate removal
+  static void Classify(RectangleDetector &detector, const ContourSet &contours,
+                       const Image &image, std::vector<Rectangle> &rectangles) {
+    detector.ProcessContoursAtScale(contours, rectangles, 1.0, image);
+  }
+
+  static bool IsRectangle(const RectangleDetector &detector,
+                          const ContourView &contour) {
+    return detector.IsRectangle(contour);
+  }
+
+  static void RemoveDuplicates(const RectangleDetector &detector,
+                               std::vector<Rectangle> &rectangles) {
+    detector.RemoveDuplicateRectangles(rectangles);
+  }
+
+  static Image Preprocess(const ObloidDetector &detector, const Image &image) {
+    Image processed(image.width, image.height);
+    detector.PreprocessImage(image, processed);
+    return processed;
+  }
+
+  static ContourSet FindContours(const ObloidDetector &detector,
+                                 const Image &binary) {
+    ContourSet contours;
+    detector.FindContours(binary, contours);
+    return contours;
+  }
+
+  static Obloid FitCircle(const ObloidDetector &detector,
+                          const ContourView &contour) {
+    return detector.FitCircleToContour(contour);
+  }
+
+  static bool IsObloid(const ObloidDetector &detector,
+                       const ContourView &contour) {
+    Obloid obloid;
+    return detector.IsObloid(contour, obloid);
+  }
+
+  static void RemoveDuplicates(const ObloidDetector &detector,
+                               std::vector<Obloid> &obloids) {
+    detector.RemoveDuplicateObloids(obloids);
+  }
+};
@@ -0,0 +1,225 @@
+#include "BenchmarkSuites.hpp"
+#include "ShapeDetector/LatencyHistogram.hpp"
+#include "ShapeDetector/SphereDetector.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+// Distinct degraded scenes the long run cycles through
+constexpr int FRAME_POOL = 16;
+constexpr uint64_t FRAME_POOL_FIRST_SEED = 3000;
+constexpr int FRAME_WIDTH = 640;
+constexpr int FRAME_HEIGHT = 480;
+constexpr int WORST_FRAMES = 5;
+constexpr double NS_PER_MS = 1e6;
+
+namespace {
+
+// One histogram per stage, kept in first-seen order for reporting
+class StageHistograms {
+public:
+  void Record(const std::string &stage, double ms) {
+    auto it = std::find_if(stages_.begin(), stages_.end(),
+                           [&](const auto &entry) {
+                             return entry.first == stage;
+                           });
+    if (it == stages_.end()) {
+      stages_.emplace_back(stage, LatencyHistogram());
+      it = std::prev(stages_.end());
+    }
+    it->second.Record(static_cast<int64_t>(ms * NS_PER_MS));
+  }
+
+  const std::vector<std::pair<std::string, LatencyHistogram>> &
+  Stages() const {
+    return stages_;
+  }
+
+private:
+  std::vector<std::pair<std::string, LatencyHistogram>> stages_;
+};
+
+// What a rectangle frame did, to tell what its slow outliers have in common
+struct FrameRecord {
+  int frame = 0;
+  double ms = 0.0;
+  std::string slowestStage;
+  double slowestStageMs = 0.0;
+  int contours = 0;
+  uint64_t allocations = 0;
+};
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+FrameRecord RecordRectangleStages(const DetectionStats &stats,
+                                  StageHistograms &histograms) {
+  FrameRecord record;
+  double stagesMs = 0.0;
+  auto stage = [&](const std::string &name, double ms) {
+    histograms.Record("rectangle/" + name, ms);
+    stagesMs += ms;
+    if (ms > record.slowestStageMs) {
+      record.slowestStage = name;
+      record.slowestStageMs = ms;
+    }
+  };
+
+  for (int s = 0; s < stats.strategyCount; ++s) {
+    const StrategyStats &strategy = stats.strategies[s];
+    if (!strategy.name)
+      continue;
+    const std::string name = strategy.name;
+    stage(name + "/preprocess", strategy.preprocessMs);
+    stage(name + "/contours", strategy.contoursMs);
+    stage(name + "/classify", strategy.classifyMs);
+    record.contours += strategy.contours;
+  }
+  // Duplicate removal and per-call setup
+  stage("other", std::max(0.0, stats.totalMs - stagesMs));
+  record.allocations = stats.heapAllocations;
+  return record;
+}
+
+template <typename T> T Median(std::vector<T> values) {
+  if (values.empty())
+    return T();
+  std::nth_element(values.begin(), values.begin() + values.size() / 2,
+                   values.end());
+  return values[values.size() / 2];
+}
+
+void PrintHistograms(const StageHistograms &histograms) {
+  std::cout << "\n" << std::left << std::setw(38) << "stage" << std::right
+            << std::setw(8) << "count" << std::setw(10) << "mean"
+            << std::setw(10) << "p50" << std::setw(10) << "p99"
+            << std::setw(10) << "p99.9" << std::setw(10) << "max"
+            << "  (ms)\n";
+  for (const auto &[stage, histogram] : histograms.Stages()) {
+    std::cout << std::left << std::setw(38) << stage << std::right
+              << std::setw(8) << histogram.Count() << std::fixed
+              << std::setprecision(3) << std::setw(10)
+              << histogram.Mean() / NS_PER_MS;
+    for (double percentile : {50.0, 99.0, 99.9}) {
+      std::cout << std::setw(10)
+                << histogram.ValueAtPercentile(percentile) / NS_PER_MS;
+    }
+    std::cout << std::setw(10) << histogram.Max() / NS_PER_MS << "\n";
+  }
+}
+
+// A spike with typical contour and allocation counts points at the
+// scheduler; one with many more contours or allocations points at the input
+// or the allocator
+void PrintWorstFrames(std::vector<FrameRecord> records) {
+  std::vector<int> contours;
+  std::vector<uint64_t> allocations;
+  for (const FrameRecord &record : records) {
+    contours.push_back(record.contours);
+    allocations.push_back(record.allocations);
+  }
+
+  const size_t worst = std::min<size_t>(WORST_FRAMES, records.size());
+  std::partial_sort(records.begin(), records.begin() + worst, records.end(),
+                    [](const FrameRecord &a, const FrameRecord &b) {
+                      return a.ms > b.ms;
+                    });
+
+  std::cout << "\nslowest rectangle frames (median " << Median(contours)
+            << " contours, " << Median(allocations) << " allocations)\n"
+            << std::setw(8) << "frame" << std::setw(10) << "ms"
+            << std::setw(10) << "contours" << std::setw(8) << "allocs"
+            << "  slowest stage\n";
+  for (size_t i = 0; i < worst; ++i) {
+    const FrameRecord &record = records[i];
+    std::cout << std::setw(8) << record.frame << std::fixed
+              << std::setprecision(2) << std::setw(10) << record.ms
+              << std::setw(10) << record.contours << std::setw(8)
+              << record.allocations << "  " << record.slowestStage << " ("
+              << record.slowestStageMs << " ms)\n";
+  }
+}
+
+bool WriteHistograms(const StageHistograms &histograms,
+                     const std::string &directory) {
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error) {
+    std::cerr << "Error: Cannot create " << directory << ": "
+              << error.message() << std::endl;
+    return false;
+  }
+
+  bool ok = true;
+  for (const auto &[stage, histogram] : histograms.Stages()) {
+    std::string file = stage;
+    std::replace(file.begin(), file.end(), '/', '.');
+    ok = histogram.WritePercentileDistribution(
+             (std::filesystem::path(directory) / (file + ".hgrm")).string(),
+             NS_PER_MS) &&
+         ok;
+  }
+  if (ok)
+    std::cout << "Histograms written to " << directory << std::endl;
+  return ok;
+}
+
+} // namespace
+
+bool RunLatencySuite(const BenchmarkOptions &options) {
+  std::vector<Image> frames;
+  for (int i = 0; i < FRAME_POOL; ++i) {
+    frames.push_back(MakeBenchmarkFrame(FRAME_WIDTH, FRAME_HEIGHT, "medium",
+                                        FRAME_POOL_FIRST_SEED + i)
+                         .degraded);
+  }
+
+  RectangleDetector rectangleDetector;
+  SphereDetector sphereDetector;
+  StageHistograms histograms;
+  std::vector<FrameRecord> records;
+  records.reserve(options.frames);
+
+  std::cout << "\nlatency run: " << options.frames << " frames "
+            << FRAME_WIDTH << "x" << FRAME_HEIGHT << " cycling " << FRAME_POOL
+            << " degraded scenes" << std::endl;
+
+  for (int i = 0; i < options.warmup; ++i) {
+    KeepAlive(rectangleDetector.DetectRectangles(frames[i % FRAME_POOL]));
+    KeepAlive(sphereDetector.DetectSpheres(frames[i % FRAME_POOL]));
+  }
+
+  for (int frame = 0; frame < options.frames; ++frame) {
+    const Image &image = frames[frame % FRAME_POOL];
+
+    // Stats add a few clock reads per stage, well below the stage times
+    DetectionStats stats;
+    auto start = std::chrono::steady_clock::now();
+    KeepAlive(rectangleDetector.DetectRectangles(image, stats));
+    const double rectangleMs = ElapsedMs(start);
+    histograms.Record("rectangle/frame", rectangleMs);
+
+    FrameRecord record;
+    if (DETECTION_STATS_ENABLED)
+      record = RecordRectangleStages(stats, histograms);
+    record.frame = frame;
+    record.ms = rectangleMs;
+    records.push_back(record);
+
+    start = std::chrono::steady_clock::now();
+    KeepAlive(sphereDetector.DetectSpheres(image));
+    histograms.Record("sphere/frame", ElapsedMs(start));
+  }
+
+  PrintHistograms(histograms);
+  if (DETECTION_STATS_ENABLED)
+    PrintWorstFrames(records);
+
+  return options.histogramDir.empty() ||
+         WriteHistograms(histograms, options.histogramDir);
+}
@@ -0,0 +1,219 @@
+#include "BenchmarkSuites.hpp"
+#include "DetectorProbe.hpp"
+#include "ShapeDetector/ImageProcessor.hpp"
+#include <filesystem>
+#include <string>
+
+constexpr int DUPLICATES_PER_RECTANGLE = 5; // one report per strategy
+constexpr int MIN_REGION_SIZE = 50;         // matches FindContours
+
+namespace {
+
+double PointCount(const std::vector<std::vector<Point>> &contours) {
+  double count = 0;
+  for (const auto &contour : contours) {
+    count += contour.size();
+  }
+  return count;
+}
+
+// Times one per-contour stage over every contour of the frame, read from
+// the arena as the classifier reads it
+template <typename Stage>
+void RunContourStage(BenchmarkRunner &runner, const std::string &name,
+                     int size, const std::string &density,
+                     const ContourSet &contours, Stage stage) {
+  runner.Run({name, size, density,
+              static_cast<double>(contours.TotalPoints())},
+             [&] {
+               for (size_t i = 0; i < contours.Size(); ++i) {
+                 KeepAlive(stage(contours.View(i)));
+               }
+             });
+}
+
+void RectangleStages(BenchmarkRunner &runner, const BenchmarkFrame &frame,
+                     int size, const std::string &density) {
+  RectangleDetector detector;
+  const double pixels = static_cast<double>(size) * size;
+
+  for (int s = 0; s < DetectorProbe::STRATEGY_COUNT; ++s) {
+    runner.Run({std::string("rectangle/preprocess/") +
+                    DetectorProbe::StrategyName(s),
+                size, density, pixels},
+               [&] {
+                 KeepAlive(DetectorProbe::Preprocess(detector, s,
+                                                     frame.degraded));
+               });
+  }
+
+  const Image binary = DetectorProbe::Preprocess(detector, 0, frame.degraded);
+
+  runner.Run({"rectangle/find_contours", size, density, pixels}, [&] {
+    KeepAlive(DetectorProbe::FindContours(detector, binary));
+  });
+
+  std::vector<std::vector<Point>> regions;
+  for (auto &region : DetectorProbe::FindRegions(detector, binary)) {
+    if (region.size() >= MIN_REGION_SIZE)
+      regions.push_back(std::move(region));
+  }
+  runner.Run({"rectangle/extract_boundary", size, density, PointCount(regions)},
+             [&] {
+               for (const auto &region : regions) {
+                 KeepAlive(
+                     DetectorProbe::ExtractBoundary(detector, region, binary));
+               }
+             });
+
+  const ContourSet contours = DetectorProbe::FindContours(detector, binary);
+  RunContourStage(runner, "rectangle/approximate/full", size, density,
+                  contours, [&](const ContourView &c) {
+                    return DetectorProbe::ApproximateContour(detector, c);
+                  });
+  RunContourStage(runner, "rectangle/approximate/moments", size, density,
+                  contours, [&](const ContourView &c) {
+                    return DetectorProbe::MomentCorners(detector, c);
+                  });
+  RunContourStage(runner, "rectangle/approximate/hough", size, density,
+                  contours, [&](const ContourView &c) {
+                    return DetectorProbe::HoughCorners(detector, c);
+                  });
+  RunContourStage(runner, "rectangle/approximate/curvature", size, density,
+                  contours, [&](const ContourView &c) {
+                    return DetectorProbe::CurvatureCorners(detector, c);
+                  });
+  RunContourStage(runner, "rectangle/approximate/douglas_peucker", size,
+                  density, contours, [&](const ContourView &c) {
+                    return DetectorProbe::DouglasPeucker(detector, c);
+                  });
+  RunContourStage(runner, "rectangle/approximate/convex_hull", size, density,
+                  contours, [&](const ContourView &c) {
+                    return DetectorProbe::ConvexHull(detector, c);
+                  });
+  RunContourStage(runner, "rectangle/is_rectangle", size, density, contours,
+                  [&](const ContourView &c) {
+                    return DetectorProbe::IsRectangle(detector, c);
+                  });
+
+  // Every strategy reports most rectangles again with slight jitter
+  std::vector<Rectangle> candidates;
+  for (int copy = 0; copy < DUPLICATES_PER_RECTANGLE; ++copy) {
+    for (Rectangle rect : frame.scene.rectangles) {
+      rect.center.x += copy % 3 - 1;
+      rect.center.y += copy % 2;
+      candidates.push_back(rect);
+    }
+  }
+  runner.Run({"rectangle/remove_duplicates", size, density,
+              static_cast<double>(candidates.size())},
+             [&] {
+               std::vector<Rectangle> rectangles = candidates;
+               DetectorProbe::RemoveDuplicates(detector, rectangles);
+               KeepAlive(rectangles);
+             });
+
+  runner.Run({"rectangle/detect", size, density, pixels},
+             [&] { KeepAlive(detector.DetectRectangles(frame.degraded)); });
+}
+
+void SphereStages(BenchmarkRunner &runner, const BenchmarkFrame &frame,
+                  int size, const std::string &density) {
+  ObloidDetector detector;
+  SphereDetector sphereDetector;
+  const double pixels = static_cast<double>(size) * size;
+
+  runner.Run({"sphere/preprocess", size, density, pixels}, [&] {
+    KeepAlive(DetectorProbe::Preprocess(detector, frame.degraded));
+  });
+
+  const Image binary = DetectorProbe::Preprocess(detector, frame.degraded);
+  runner.Run({"sphere/find_contours", size, density, pixels}, [&] {
+    KeepAlive(DetectorProbe::FindContours(detector, binary));
+  });
+
+  const ContourSet contours = DetectorProbe::FindContours(detector, binary);
+  RunContourStage(runner, "sphere/fit_circle", size, density, contours,
+                  [&](const ContourView &c) {
+                    return DetectorProbe::FitCircle(detector, c);
+                  });
+  RunContourStage(runner, "sphere/is_obloid", size, density, contours,
+                  [&](const ContourView &c) {
+                    return DetectorProbe::IsObloid(detector, c);
+                  });
+
+  runner.Run({"sphere/detect", size, density, pixels},
+             [&] { KeepAlive(sphereDetector.DetectSpheres(frame.degraded)); });
+}
+
+void RenderingStages(BenchmarkRunner &runner, const BenchmarkFrame &frame,
+                     int size, const std::string &density) {
+  const Image &gray = frame.scene.image;
+  const auto &rectangles = frame.scene.rectangles;
+  const auto &spheres = frame.scene.circles;
+  const double pixels = static_cast<double>(size) * size;
+
+  runner.Run({"render/color_image", size, density, pixels}, [&] {
+    KeepAlive(
+        ImageProcessor::CreateColorImageWithSpheres(gray, rectangles, spheres));
+  });
+  runner.Run({"render/rgb_image", size, density, pixels}, [&] {
+    KeepAlive(ImageProcessor::CreateRgbImage(gray, rectangles, spheres));
+  });
+
+  RgbImage rgb(size, size);
+  runner.Run({"render/expand_gray", size, density, pixels}, [&] {
+    ImageProcessor::ExpandGrayToRgb(gray, rgb.View());
+    KeepAlive(rgb.data);
+  });
+  runner.Run({"render/draw_overlay", size, density, pixels}, [&] {
+    ImageProcessor::DrawOverlay(rgb.View(), rectangles, spheres);
+    KeepAlive(rgb.data);
+  });
+
+  Overlay overlay(size, size);
+  runner.Run({"render/overlay_shapes", size, density, pixels}, [&] {
+    Overlay layer(size, size);
+    ImageProcessor::DrawRectangles(layer, rectangles);
+    ImageProcessor::DrawSpheres(layer, spheres);
+    KeepAlive(layer.rows);
+  });
+  ImageProcessor::DrawRectangles(overlay, rectangles);
+  ImageProcessor::DrawSpheres(overlay, spheres);
+
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path();
+  const std::string pgmPath = (directory / "shape_benchmark.pgm").string();
+  const std::string ppmPath = (directory / "shape_benchmark.ppm").string();
+  const ColorImage color =
+      ImageProcessor::CreateColorImageWithSpheres(gray, rectangles, spheres);
+
+  runner.Run({"io/save_pgm", size, density, pixels},
+             [&] { ImageProcessor::SavePGMImage(gray, pgmPath); });
+  runner.Run({"io/load_pgm", size, density, pixels},
+             [&] { KeepAlive(ImageProcessor::LoadPGMImage(pgmPath)); });
+  runner.Run({"io/save_ppm_color", size, density, pixels},
+             [&] { ImageProcessor::SavePPMImage(color, ppmPath); });
+  runner.Run({"io/save_ppm_rgb", size, density, pixels},
+             [&] { ImageProcessor::SavePPMImage(rgb, ppmPath); });
+  runner.Run({"io/save_ppm_overlay", size, density, pixels},
+             [&] { ImageProcessor::SavePPMImage(gray, overlay, ppmPath); });
+
+  std::filesystem::remove(pgmPath);
+  std::filesystem::remove(ppmPath);
+}
+
+} // namespace
+
+void RunMicroBenchmarks(BenchmarkRunner &runner) {
+  const BenchmarkOptions &options = runner.Options();
+
+  for (int size : options.sizes) {
+    for (const std::string &density : options.densities) {
+      const BenchmarkFrame frame = MakeBenchmarkFrame(size, density);
+      RectangleStages(runner, frame, size, density);
+      SphereStages(runner, frame, size, density);
+      RenderingStages(runner, frame, size, density);
+    }
+  }
+}
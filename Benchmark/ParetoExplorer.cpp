@@ -0,0 +1,369 @@
+#include "BenchmarkSuites.hpp"
+#include "DetectorProbe.hpp"
+#include "ShapeDetector/Evaluation.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+// Kept apart from the regression corpus so tuning against one does not
+// overfit the other
+constexpr int PARETO_FRAMES = 8;
+constexpr uint64_t PARETO_FIRST_SEED = 2000;
+constexpr int PARETO_WIDTH = 640;
+constexpr int PARETO_HEIGHT = 480;
+
+namespace {
+
+constexpr int STRATEGIES = static_cast<int>(RectangleStrategy::Count);
+
+// Steps of ApproximateContour that can be switched off and reordered; the
+// final Douglas-Peucker fallback always runs last
+constexpr ApproximationBranch OPTIONAL_BRANCHES[] = {
+    ApproximationBranch::Moments, ApproximationBranch::Hough,
+    ApproximationBranch::Curvature, ApproximationBranch::DouglasPeucker,
+    ApproximationBranch::ConvexHull};
+constexpr int OPTIONAL_BRANCH_COUNT = std::size(OPTIONAL_BRANCHES);
+
+// The optional steps ApproximateContour tries, in order
+using Chain = std::vector<ApproximationBranch>;
+
+using Clock = std::chrono::steady_clock;
+
+// What one strategy produced on one frame with one branch chain
+struct StrategyRun {
+  double ms = 0.0; // preprocessing, contour tracing and classification
+  std::vector<Rectangle> candidates; // before duplicate removal
+};
+
+// runs[frame][strategy][chain]
+using RunTable = std::vector<std::array<std::vector<StrategyRun>, STRATEGIES>>;
+
+struct Configuration {
+  std::vector<RectangleStrategy> strategies; // in run order
+  int chain = 0; // index into BranchChains()
+  double latencyMs = 0.0; // mean per frame
+  MatchCounts matches{};
+  double precision = 0.0, recall = 0.0;
+  bool frontier = false;
+};
+
+double ElapsedMs(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+// Median of the timed repetitions after the warm-up calls
+template <typename Body>
+double MedianMs(const BenchmarkOptions &options, Body body) {
+  for (int i = 0; i < options.warmup; ++i)
+    body();
+  std::vector<double> samples;
+  for (int r = 0; r < options.repetitions; ++r) {
+    const auto start = Clock::now();
+    body();
+    samples.push_back(ElapsedMs(start));
+  }
+  std::sort(samples.begin(), samples.end());
+  return Percentile(samples, 0.5);
+}
+
+// Every ordered selection of distinct optional branches, the empty chain
+// (final fallback only) first
+const std::vector<Chain> &BranchChains() {
+  static const std::vector<Chain> chains = [] {
+    std::vector<Chain> result;
+    for (int subset = 0; subset < (1 << OPTIONAL_BRANCH_COUNT); ++subset) {
+      Chain chain;
+      for (int b = 0; b < OPTIONAL_BRANCH_COUNT; ++b) {
+        if (subset & (1 << b))
+          chain.push_back(OPTIONAL_BRANCHES[b]);
+      }
+      do {
+        result.push_back(chain);
+      } while (std::next_permutation(chain.begin(), chain.end()));
+    }
+    return result;
+  }();
+  return chains;
+}
+
+int BranchMask(const Chain &chain) {
+  int mask = 0;
+  for (ApproximationBranch branch : chain)
+    mask |= 1 << static_cast<int>(branch);
+  return mask;
+}
+
+void SetChain(RectangleDetector &detector, const Chain &chain) {
+  for (ApproximationBranch branch : OPTIONAL_BRANCHES) {
+    detector.SetApproximationBranch(
+        branch, std::find(chain.begin(), chain.end(), branch) != chain.end());
+  }
+  detector.SetApproximationOrder(chain);
+}
+
+// A strategy's output does not depend on which strategies run alongside
+// it, so each one is measured once per frame and branch chain and every
+// combination is assembled from these runs
+RunTable MeasureStrategies(const BenchmarkOptions &options,
+                           const std::vector<Scene> &corpus) {
+  const std::vector<Chain> &chains = BranchChains();
+  RectangleDetector detector;
+  RunTable runs(corpus.size());
+
+  for (size_t f = 0; f < corpus.size(); ++f) {
+    const Image &image = corpus[f].image;
+    for (int s = 0; s < STRATEGIES; ++s) {
+      const Image binary = DetectorProbe::Preprocess(detector, s, image);
+      const auto contours = DetectorProbe::FindContours(detector, binary);
+      const double tracingMs = MedianMs(options, [&] {
+        KeepAlive(DetectorProbe::FindContours(
+            detector, DetectorProbe::Preprocess(detector, s, image)));
+      });
+
+      runs[f][s].resize(chains.size());
+      for (size_t c = 0; c < chains.size(); ++c) {
+        SetChain(detector, chains[c]);
+        StrategyRun &run = runs[f][s][c];
+        DetectorProbe::Classify(detector, contours, image, run.candidates);
+        run.ms = tracingMs + MedianMs(options, [&] {
+                   std::vector<Rectangle> rectangles;
+                   DetectorProbe::Classify(detector, contours, image,
+                                           rectangles);
+                   KeepAlive(rectangles);
+                 });
+      }
+    }
+    std::cout << "  measured frame " << f + 1 << "/" << corpus.size()
+              << std::endl;
+  }
+  return runs;
+}
+
+// Every non-empty ordered selection of distinct strategies
+std::vector<std::vector<RectangleStrategy>> StrategyOrders() {
+  std::vector<std::vector<RectangleStrategy>> orders;
+  for (int subset = 1; subset < (1 << STRATEGIES); ++subset) {
+    std::vector<RectangleStrategy> order;
+    for (int s = 0; s < STRATEGIES; ++s) {
+      if (subset & (1 << s))
+        order.push_back(static_cast<RectangleStrategy>(s));
+    }
+    do {
+      orders.push_back(order);
+    } while (std::next_permutation(order.begin(), order.end()));
+  }
+  return orders;
+}
+
+// Concatenates the strategies' candidates in order and removes duplicates
+// the way DetectRectangles does, timing only the duplicate removal
+Configuration Evaluate(const RectangleDetector &detector,
+                       const RunTable &runs, const std::vector<Scene> &corpus,
+                       const std::vector<RectangleStrategy> &order,
+                       int chain) {
+  Configuration config{.strategies = order, .chain = chain};
+  std::vector<Rectangle> rectangles;
+
+  for (size_t f = 0; f < corpus.size(); ++f) {
+    rectangles.clear();
+    double ms = 0.0;
+    for (RectangleStrategy strategy : order) {
+      const StrategyRun &run = runs[f][static_cast<int>(strategy)][chain];
+      ms += run.ms;
+      rectangles.insert(rectangles.end(), run.candidates.begin(),
+                        run.candidates.end());
+    }
+
+    const auto start = Clock::now();
+    DetectorProbe::RemoveDuplicates(detector, rectangles);
+    ms += ElapsedMs(start);
+
+    config.latencyMs += ms / corpus.size();
+    config.matches +=
+        Evaluation::MatchRectangles(rectangles, corpus[f].rectangles);
+  }
+
+  config.precision = config.matches.Precision();
+  config.recall = config.matches.Recall();
+  return config;
+}
+
+bool Dominates(const Configuration &a, const Configuration &b) {
+  return a.latencyMs <= b.latencyMs && a.precision >= b.precision &&
+         a.recall >= b.recall &&
+         (a.latencyMs < b.latencyMs || a.precision > b.precision ||
+          a.recall > b.recall);
+}
+
+// Sorts by latency and marks the configurations no other one beats on
+// latency, precision and recall at once. Anything dominating a candidate
+// sorts before it, and dominance is transitive, so comparing against the
+// frontier found so far is enough.
+void MarkFrontier(std::vector<Configuration> &configs) {
+  std::sort(configs.begin(), configs.end(),
+            [](const Configuration &a, const Configuration &b) {
+              if (a.latencyMs != b.latencyMs)
+                return a.latencyMs < b.latencyMs;
+              if (a.recall != b.recall)
+                return a.recall > b.recall;
+              return a.precision > b.precision;
+            });
+
+  std::vector<const Configuration *> frontier;
+  for (Configuration &config : configs) {
+    config.frontier = std::none_of(
+        frontier.begin(), frontier.end(),
+        [&](const Configuration *other) { return Dominates(*other, config); });
+    if (config.frontier)
+      frontier.push_back(&config);
+  }
+}
+
+std::string StrategyList(const std::vector<RectangleStrategy> &order) {
+  std::string list;
+  for (RectangleStrategy strategy : order) {
+    if (!list.empty())
+      list += ">";
+    list += RectangleDetector::StrategyName(strategy);
+  }
+  return list;
+}
+
+std::string BranchList(int chain) {
+  std::string list;
+  for (ApproximationBranch branch : BranchChains()[chain]) {
+    if (!list.empty())
+      list += ">";
+    list += DetectionStats::Name(branch);
+  }
+  return list.empty() ? "final_only" : list;
+}
+
+void PrintRow(const Configuration &config, const char *label) {
+  std::cout << std::left << std::setw(10) << label << std::right
+            << std::fixed << std::setprecision(2) << std::setw(10)
+            << config.latencyMs << std::setprecision(3) << std::setw(11)
+            << config.precision << std::setw(9) << config.recall
+            << std::setw(8) << config.matches.F1() << "  "
+            << BranchList(config.chain) << "  "
+            << StrategyList(config.strategies) << "\n";
+}
+
+int StrategySubset(const Configuration &config) {
+  int subset = 0;
+  for (RectangleStrategy strategy : config.strategies)
+    subset |= 1 << static_cast<int>(strategy);
+  return subset;
+}
+
+// Orders of the same strategies only differ in how duplicate removal
+// breaks ties, while the branch order decides which corner finder wins;
+// report how many sets grouped by Group changed outcome with the order
+template <typename Group>
+int OrderSensitiveSets(const std::vector<Configuration> &configs,
+                       Group group) {
+  using Key = decltype(group(configs.front()));
+  std::map<Key, std::pair<int, int>> outcomes;
+  int sensitive = 0;
+  for (const Configuration &config : configs) {
+    const std::pair<int, int> result = {config.matches.truePositives,
+                                        config.matches.falsePositives};
+    auto [it, inserted] = outcomes.try_emplace(group(config), result);
+    if (!inserted && it->second != result && it->second.first >= 0) {
+      ++sensitive;
+      it->second.first = -1; // count each set once
+    }
+  }
+  return sensitive;
+}
+
+bool WriteCsv(const std::vector<Configuration> &configs,
+              const std::string &path) {
+  std::ofstream file(path);
+  if (!file) {
+    std::cerr << "Error: Cannot write " << path << std::endl;
+    return false;
+  }
+  file << "strategies,branches,latency_ms,precision,recall,f1,frontier\n"
+       << std::setprecision(6);
+  for (const Configuration &config : configs) {
+    file << StrategyList(config.strategies) << ","
+         << BranchList(config.chain) << "," << config.latencyMs << ","
+         << config.precision << "," << config.recall << ","
+         << config.matches.F1() << "," << (config.frontier ? 1 : 0) << "\n";
+  }
+  std::cout << "Configurations written to " << path << std::endl;
+  return true;
+}
+
+} // namespace
+
+bool RunParetoExplorer(const BenchmarkOptions &options) {
+  const std::vector<Scene> corpus = MakeLabeledCorpus(
+      PARETO_WIDTH, PARETO_HEIGHT, PARETO_FIRST_SEED, PARETO_FRAMES);
+
+  std::cout << "\npareto corpus: " << PARETO_FRAMES << " frames "
+            << PARETO_WIDTH << "x" << PARETO_HEIGHT << ", seeds "
+            << PARETO_FIRST_SEED << "-"
+            << PARETO_FIRST_SEED + PARETO_FRAMES - 1 << std::endl;
+  const RunTable runs = MeasureStrategies(options, corpus);
+
+  const RectangleDetector detector;
+  const auto orders = StrategyOrders();
+  const std::vector<Chain> &chains = BranchChains();
+  const int chainCount = static_cast<int>(chains.size());
+  std::vector<Configuration> configs;
+  configs.reserve(orders.size() * chains.size());
+  for (const auto &order : orders) {
+    for (int chain = 0; chain < chainCount; ++chain)
+      configs.push_back(Evaluate(detector, runs, corpus, order, chain));
+  }
+  MarkFrontier(configs);
+
+  std::cout << configs.size() << " configurations (" << orders.size()
+            << " strategy orders x " << chainCount
+            << " branch chains); latency is the mean per frame\n\n"
+            << std::left << std::setw(10) << "" << std::right
+            << std::setw(10) << "ms" << std::setw(11) << "precision"
+            << std::setw(9) << "recall" << std::setw(8) << "f1"
+            << "  branches  strategies\n";
+  for (const Configuration &config : configs) {
+    if (config.frontier)
+      PrintRow(config, "frontier");
+  }
+
+  // Default detector: all strategies and branches in enum order
+  const Chain defaultChain(std::begin(OPTIONAL_BRANCHES),
+                           std::end(OPTIONAL_BRANCHES));
+  const auto isDefault = [&](const Configuration &config) {
+    return chains[config.chain] == defaultChain &&
+           static_cast<int>(config.strategies.size()) == STRATEGIES &&
+           std::is_sorted(config.strategies.begin(), config.strategies.end());
+  };
+  const auto defaults = std::find_if(configs.begin(), configs.end(), isDefault);
+  PrintRow(*defaults, defaults->frontier ? "default*" : "default");
+
+  // Same strategies in any order with the same chain, and same strategy
+  // order with the same branches in any order
+  const auto byStrategySet = [](const Configuration &config) {
+    return std::pair(StrategySubset(config), config.chain);
+  };
+  const auto byBranchSet = [&](const Configuration &config) {
+    return std::pair(BranchMask(chains[config.chain]), config.strategies);
+  };
+  std::cout << "\nStrategy order changed the matches of "
+            << OrderSensitiveSets(configs, byStrategySet) << " of "
+            << ((1 << STRATEGIES) - 1) * chainCount
+            << " strategy sets x branch chains\n"
+            << "Branch order changed the matches of "
+            << OrderSensitiveSets(configs, byBranchSet) << " of "
+            << orders.size() * (1 << OPTIONAL_BRANCH_COUNT)
+            << " strategy orders x branch sets\n";
+
+  return options.paretoPath.empty() || WriteCsv(configs, options.paretoPath);
+}
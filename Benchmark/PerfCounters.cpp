@@ -0,0 +1,194 @@
+#include "PerfCounters.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <omp.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+double PerfReading::Ipc() const {
+  if (!Has(PerfEvent::Cycles) || !Has(PerfEvent::Instructions) ||
+      (*this)[PerfEvent::Cycles] <= 0.0)
+    return 0.0;
+  return (*this)[PerfEvent::Instructions] / (*this)[PerfEvent::Cycles];
+}
+
+PerfReading PerfReading::Scaled(double divisor) const {
+  PerfReading scaled = *this;
+  for (double &value : scaled.values) {
+    if (value >= 0.0 && divisor > 0.0)
+      value /= divisor;
+  }
+  return scaled;
+}
+
+const char *PerfCounters::Name(PerfEvent event) {
+  switch (event) {
+  case PerfEvent::Cycles:
+    return "cycles";
+  case PerfEvent::Instructions:
+    return "instructions";
+  case PerfEvent::CacheMisses:
+    return "cache_misses";
+  case PerfEvent::BranchMisses:
+    return "branch_misses";
+  default:
+    return "unknown";
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (Group &group : groups_)
+    CloseGroup(group);
+}
+
+#ifdef __linux__
+
+namespace {
+
+constexpr uint64_t EVENT_CONFIGS[PERF_EVENT_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+int OpenEvent(uint64_t config, int groupFd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.disabled = groupFd == -1 ? 1 : 0; // members follow the leader
+  attr.exclude_kernel = 1; // allowed at the default paranoid level
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // pid 0, cpu -1: the calling thread on whichever CPU it runs
+  return static_cast<int>(
+      syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+} // namespace
+
+PerfCounters::Group PerfCounters::OpenGroup(int &error) {
+  Group group;
+  error = 0;
+  for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+    const int fd = OpenEvent(EVENT_CONFIGS[e], group.leader);
+    if (fd < 0) {
+      if (group.leader == -1)
+        error = errno;
+      continue; // e.g. no cache-miss event inside some VMs
+    }
+    if (group.leader == -1)
+      group.leader = fd;
+    group.fds[e] = fd;
+    group.slots[e] = group.members++;
+  }
+  return group;
+}
+
+void PerfCounters::CloseGroup(Group &group) {
+  for (int &fd : group.fds) {
+    if (fd >= 0)
+      close(fd);
+    fd = -1;
+  }
+  group.leader = -1;
+}
+
+bool PerfCounters::Open() {
+  // Opened from inside a parallel region so each OpenMP thread counts its
+  // own work; the runtime keeps reusing these threads afterwards
+  const int threads = omp_get_max_threads();
+  std::vector<Group> groups(threads);
+  std::vector<int> errors(threads, 0);
+
+#pragma omp parallel num_threads(threads)
+  {
+    const int t = omp_get_thread_num();
+    groups[t] = OpenGroup(errors[t]);
+  }
+
+  for (int t = 0; t < threads; ++t) {
+    if (groups[t].leader == -1) {
+      error_ = std::strerror(errors[t] ? errors[t] : ENOENT);
+      for (Group &group : groups)
+        CloseGroup(group);
+      return false;
+    }
+  }
+
+  groups_ = std::move(groups);
+  return true;
+}
+
+void PerfCounters::Start() {
+  for (const Group &group : groups_) {
+    ioctl(group.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(group.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+}
+
+PerfReading PerfCounters::Stop() {
+  for (const Group &group : groups_)
+    ioctl(group.leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+  PerfReading reading;
+  if (groups_.empty())
+    return reading;
+
+  std::array<double, PERF_EVENT_COUNT> totals{};
+  std::array<bool, PERF_EVENT_COUNT> counted;
+  counted.fill(true);
+
+  for (const Group &group : groups_) {
+    // nr, time_enabled, time_running, then one value per member
+    uint64_t buffer[3 + PERF_EVENT_COUNT] = {};
+    if (read(group.leader, buffer, sizeof(buffer)) <
+        static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+      counted.fill(false);
+      break;
+    }
+    const double enabled = static_cast<double>(buffer[1]);
+    const double running = static_cast<double>(buffer[2]);
+    const double scale = running > 0.0 ? enabled / running : 0.0;
+
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+      // An event only counts when every thread could open it
+      if (group.slots[e] < 0 || group.slots[e] >= static_cast<int>(buffer[0]))
+        counted[e] = false;
+      else
+        totals[e] += buffer[3 + group.slots[e]] * scale;
+    }
+  }
+
+  for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+    if (counted[e])
+      reading.values[e] = totals[e];
+  }
+  return reading;
+}
+
+#else
+
+PerfCounters::Group PerfCounters::OpenGroup(int &error) {
+  error = ENOSYS;
+  return Group();
+}
+
+void PerfCounters::CloseGroup(Group &group) { group.leader = -1; }
+
+bool PerfCounters::Open() {
+  error_ = "perf_event_open is only available on Linux";
+  return false;
+}
+
+void PerfCounters::Start() {}
+
+PerfReading PerfCounters::Stop() { return PerfReading(); }
+
+#endif
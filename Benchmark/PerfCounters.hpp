@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+enum class PerfEvent { Cycles, Instructions, CacheMisses, BranchMisses, Count };
+
+constexpr int PERF_EVENT_COUNT = static_cast<int>(PerfEvent::Count);
+
+// Event totals of one measurement; events that could not be counted read -1
+struct PerfReading {
+  std::array<double, PERF_EVENT_COUNT> values{-1.0, -1.0, -1.0, -1.0};
+
+  bool Has(PerfEvent event) const { return (*this)[event] >= 0.0; }
+  double operator[](PerfEvent event) const {
+    return values[static_cast<int>(event)];
+  }
+  double &operator[](PerfEvent event) {
+    return values[static_cast<int>(event)];
+  }
+  // Instructions per cycle, 0 when either event is missing
+  double Ipc() const;
+  // Every available event divided by divisor
+  PerfReading Scaled(double divisor) const;
+};
+
+// Linux perf_event_open counters covering the calling thread and the OpenMP
+// worker threads. One group per thread keeps the events of a thread
+// scheduled together so ratios such as IPC stay meaningful; counts are
+// scaled up when the kernel multiplexes groups.
+class PerfCounters {
+public:
+  PerfCounters() = default;
+  ~PerfCounters();
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  // Returns false and keeps the reason in Error() when counters cannot be
+  // opened, e.g. without kernel support or under perf_event_paranoid
+  bool Open();
+  bool Available() const { return !groups_.empty(); }
+  const std::string &Error() const { return error_; }
+
+  // Resets and enables every group
+  void Start();
+  // Disables every group and returns the totals since Start()
+  PerfReading Stop();
+
+  static const char *Name(PerfEvent event);
+
+private:
+  struct Group {
+    int leader = -1;
+    std::array<int, PERF_EVENT_COUNT> fds{-1, -1, -1, -1};
+    // Position of each event in the group read, -1 when not opened
+    std::array<int, PERF_EVENT_COUNT> slots{-1, -1, -1, -1};
+    int members = 0;
+  };
+
+  static Group OpenGroup(int &error);
+  static void CloseGroup(Group &group);
+
+  std::vector<Group> groups_;
+  std::string error_;
+};
@@ -0,0 +1,239 @@
+#include "BenchmarkSuites.hpp"
+#include "ShapeDetector/Evaluation.hpp"
+#include "ShapeDetector/SphereDetector.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+
+// The corpus is part of the baseline: changing any of these invalidates
+// every stored baseline
+constexpr int CORPUS_FRAMES = 24;
+constexpr uint64_t CORPUS_FIRST_SEED = 1000;
+constexpr int CORPUS_WIDTH = 640;
+constexpr int CORPUS_HEIGHT = 480;
+
+namespace {
+
+// Flat "detector.metric" -> value, the same shape as the baseline file
+using Metrics = std::map<std::string, double>;
+
+struct DetectorRun {
+  std::vector<double> latenciesMs; // every timed call over the corpus
+  MatchCounts matches;
+};
+
+// Times detect(scene) per frame and scores the output of its first call
+template <typename Detect, typename Score>
+DetectorRun RunDetector(const BenchmarkOptions &options,
+                        const std::vector<Scene> &corpus, Detect detect,
+                        Score score) {
+  using Clock = std::chrono::steady_clock;
+  DetectorRun run;
+  run.latenciesMs.reserve(corpus.size() * options.repetitions);
+
+  for (const Scene &scene : corpus) {
+    auto detected = detect(scene.image);
+    run.matches += score(scene, detected);
+
+    for (int i = 0; i < options.warmup; ++i) {
+      KeepAlive(detect(scene.image));
+    }
+    for (int r = 0; r < options.repetitions; ++r) {
+      const auto start = Clock::now();
+      KeepAlive(detect(scene.image));
+      run.latenciesMs.push_back(
+          std::chrono::duration<double, std::milli>(Clock::now() - start)
+              .count());
+    }
+  }
+  return run;
+}
+
+void AddMetrics(Metrics &metrics, const std::string &detector,
+                DetectorRun run) {
+  std::sort(run.latenciesMs.begin(), run.latenciesMs.end());
+  metrics[detector + ".latency_p50_ms"] = Percentile(run.latenciesMs, 0.50);
+  metrics[detector + ".latency_p90_ms"] = Percentile(run.latenciesMs, 0.90);
+  metrics[detector + ".latency_p99_ms"] = Percentile(run.latenciesMs, 0.99);
+  metrics[detector + ".latency_max_ms"] = run.latenciesMs.back();
+  metrics[detector + ".precision"] = run.matches.Precision();
+  metrics[detector + ".recall"] = run.matches.Recall();
+  metrics[detector + ".f1"] = run.matches.F1();
+}
+
+void PrintSummary(const Metrics &metrics) {
+  std::cout << "\nregression corpus: " << CORPUS_FRAMES << " frames "
+            << CORPUS_WIDTH << "x" << CORPUS_HEIGHT << ", seeds "
+            << CORPUS_FIRST_SEED << "-"
+            << CORPUS_FIRST_SEED + CORPUS_FRAMES - 1 << "\n";
+  std::cout << std::left << std::setw(12) << "detector" << std::right
+            << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms"
+            << std::setw(10) << "p99 ms" << std::setw(10) << "max ms"
+            << std::setw(11) << "precision" << std::setw(9) << "recall"
+            << std::setw(8) << "f1" << "\n";
+  for (const std::string detector : {"rectangle", "sphere"}) {
+    std::cout << std::left << std::setw(12) << detector << std::right
+              << std::fixed << std::setprecision(2);
+    for (const char *metric : {".latency_p50_ms", ".latency_p90_ms",
+                               ".latency_p99_ms", ".latency_max_ms"}) {
+      std::cout << std::setw(10) << metrics.at(detector + metric);
+    }
+    std::cout << std::setprecision(3) << std::setw(11)
+              << metrics.at(detector + ".precision") << std::setw(9)
+              << metrics.at(detector + ".recall") << std::setw(8)
+              << metrics.at(detector + ".f1") << "\n";
+  }
+}
+
+bool WriteBaseline(const Metrics &metrics, const std::string &path) {
+  std::ofstream file(path);
+  if (!file) {
+    std::cerr << "Error: Cannot write " << path << std::endl;
+    return false;
+  }
+  file << "{\n  \"metrics\": {\n" << std::setprecision(9);
+  size_t index = 0;
+  for (const auto &[name, value] : metrics) {
+    file << "    \"" << name << "\": " << value
+         << (++index < metrics.size() ? ",\n" : "\n");
+  }
+  file << "  }\n}\n";
+  std::cout << "Baseline written to " << path << std::endl;
+  return true;
+}
+
+// Reads the flat metrics object written by WriteBaseline
+bool ReadBaseline(const std::string &path, Metrics &metrics) {
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "Error: Cannot open baseline " << path << std::endl;
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  const std::string text = buffer.str();
+
+  static const std::regex entry(
+      R"re("([A-Za-z0-9_.]+)"\s*:\s*(-?[0-9.]+(?:[eE][-+]?[0-9]+)?))re");
+  for (std::sregex_iterator it(text.begin(), text.end(), entry), end;
+       it != end; ++it) {
+    metrics[(*it)[1].str()] = std::stod((*it)[2].str());
+  }
+  if (metrics.empty()) {
+    std::cerr << "Error: No metrics in baseline " << path << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Latency may grow by a relative tolerance, accuracy may drop by an
+// absolute one. Tail percentiles and max are recorded but not checked: with
+// a few hundred samples they mostly measure scheduler noise.
+bool CompareWithBaseline(const Metrics &current, const Metrics &baseline,
+                         const BenchmarkOptions &options) {
+  for (const auto &[name, value] : current) {
+    if (name.starts_with("corpus.") &&
+        (!baseline.contains(name) || baseline.at(name) != value)) {
+      std::cerr << "Error: Baseline was recorded on a different corpus ("
+                << name << ")" << std::endl;
+      return false;
+    }
+  }
+
+  struct Check {
+    const char *metric;
+    bool latency;
+  };
+  constexpr Check CHECKS[] = {{".latency_p50_ms", true},
+                              {".latency_p90_ms", true},
+                              {".precision", false},
+                              {".recall", false}};
+
+  bool ok = true;
+  std::cout << "\n" << std::left << std::setw(28) << "metric" << std::right
+            << std::setw(12) << "baseline" << std::setw(12) << "current"
+            << std::setw(10) << "change" << "\n";
+  for (const std::string detector : {"rectangle", "sphere"}) {
+    for (const Check &check : CHECKS) {
+      const std::string name = detector + check.metric;
+      if (!baseline.contains(name)) {
+        std::cerr << "Warning: " << name << " missing from baseline"
+                  << std::endl;
+        continue;
+      }
+      const double before = baseline.at(name);
+      const double now = current.at(name);
+      const bool regressed =
+          check.latency ? now > before * (1.0 + options.latencyTolerance)
+                        : now < before - options.accuracyTolerance;
+
+      std::cout << std::left << std::setw(28) << name << std::right
+                << std::fixed << std::setprecision(3) << std::setw(12)
+                << before << std::setw(12) << now << std::setw(9)
+                << std::setprecision(1)
+                << (before != 0.0 ? 100.0 * (now - before) / before : 0.0)
+                << "%" << (regressed ? "  REGRESSED" : "") << "\n";
+      ok = ok && !regressed;
+    }
+  }
+
+  std::cout << (ok ? "No regressions against baseline\n"
+                   : "Regression beyond tolerance\n");
+  return ok;
+}
+
+} // namespace
+
+bool RunRegression(const BenchmarkOptions &options) {
+  const std::vector<Scene> corpus = MakeLabeledCorpus(
+      CORPUS_WIDTH, CORPUS_HEIGHT, CORPUS_FIRST_SEED, CORPUS_FRAMES);
+
+  Metrics metrics;
+  metrics["corpus.frames"] = CORPUS_FRAMES;
+  metrics["corpus.first_seed"] = static_cast<double>(CORPUS_FIRST_SEED);
+  metrics["corpus.width"] = CORPUS_WIDTH;
+  metrics["corpus.height"] = CORPUS_HEIGHT;
+
+  RectangleDetector rectangleDetector;
+  AddMetrics(metrics, "rectangle",
+             RunDetector(
+                 options, corpus,
+                 [&](const Image &image) {
+                   return rectangleDetector.DetectRectangles(image);
+                 },
+                 [](const Scene &scene,
+                    const std::vector<Rectangle> &rectangles) {
+                   return Evaluation::MatchRectangles(rectangles,
+                                                      scene.rectangles);
+                 }));
+
+  SphereDetector sphereDetector;
+  AddMetrics(metrics, "sphere",
+             RunDetector(
+                 options, corpus,
+                 [&](const Image &image) {
+                   return sphereDetector.DetectSpheres(image);
+                 },
+                 [](const Scene &scene, const std::vector<Sphere> &spheres) {
+                   return Evaluation::MatchSpheres(spheres, scene.circles,
+                                                   scene.ellipses);
+                 }));
+
+  PrintSummary(metrics);
+
+  bool ok = true;
+  if (!options.recordPath.empty())
+    ok = WriteBaseline(metrics, options.recordPath);
+
+  if (!options.baselinePath.empty()) {
+    Metrics baseline;
+    ok = ReadBaseline(options.baselinePath, baseline) &&
+         CompareWithBaseline(metrics, baseline, options) && ok;
+  }
+  return ok;
+}
@@ -0,0 +1,187 @@
+#include "BenchmarkSuites.hpp"
+#include "ShapeDetector/SphereDetector.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <omp.h>
+
+namespace {
+
+struct Resolution {
+  const char *name;
+  int width, height;
+};
+
+// Parallel efficiency below this is flagged in the scaling rows
+constexpr double EFFICIENCY_THRESHOLD = 0.7;
+// Instrumented calls averaged into the per-stage times of each row
+constexpr int STAGE_SAMPLES = 3;
+
+constexpr Resolution RESOLUTIONS[] = {{"vga", 640, 480},
+                                      {"hd", 1280, 720},
+                                      {"fhd", 1920, 1080},
+                                      {"4k", 3840, 2160},
+                                      {"8k", 7680, 4320}};
+
+// Mean time per call in each stage, summed over strategies
+struct StageTimes {
+  double preprocessMs = 0.0;
+  double contoursMs = 0.0;
+  double classifyMs = 0.0;
+};
+
+// Ascending and distinct, since speedup and efficiency are relative to the
+// first count
+std::vector<int> ThreadCounts(const BenchmarkOptions &options) {
+  if (!options.threads.empty()) {
+    std::vector<int> counts = options.threads;
+    std::sort(counts.begin(), counts.end());
+    counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+    return counts;
+  }
+
+  std::vector<int> counts;
+  const int max = omp_get_max_threads();
+  for (int t = 1; t < max; t *= 2)
+    counts.push_back(t);
+  counts.push_back(max);
+  return counts;
+}
+
+std::string CaseName(const std::string &name, int threads) {
+  return name + "/t" + std::to_string(threads);
+}
+
+StageTimes MeasureStages(
+    const std::function<void(DetectionStats &)> &instrumented) {
+  DetectionStats stats;
+  for (int i = 0; i < STAGE_SAMPLES; ++i)
+    instrumented(stats);
+
+  StageTimes times;
+  for (int s = 0; s < stats.strategyCount; ++s) {
+    times.preprocessMs += stats.strategies[s].preprocessMs / STAGE_SAMPLES;
+    times.contoursMs += stats.strategies[s].contoursMs / STAGE_SAMPLES;
+    times.classifyMs += stats.strategies[s].classifyMs / STAGE_SAMPLES;
+  }
+  return times;
+}
+
+void PrintStage(const char *stage, double ms, double baselineMs) {
+  std::cout << " " << stage << " " << std::setprecision(2) << ms << "ms "
+            << (ms > 0.0 ? baselineMs / ms : 0.0) << "x";
+}
+
+// Speedup and parallel efficiency relative to the smallest thread count,
+// with '!' after efficiencies below EFFICIENCY_THRESHOLD, then the same
+// split by stage so a stage that stays serial stands out
+void PrintScaling(const std::string &name, const std::string &density,
+                  const BenchmarkResult *runs, const std::vector<int> &threads,
+                  const std::vector<StageTimes> &stages) {
+  const double baseline = runs[0].median;
+  std::cout << "  " << name << " " << density << ":" << std::fixed;
+  for (size_t i = 0; i < threads.size(); ++i) {
+    const double median = runs[i].median;
+    const double speedup = median > 0.0 ? baseline / median : 0.0;
+    const double efficiency = speedup * threads.front() / threads[i];
+    const double pixelsPerSecond =
+        median > 0.0 ? runs[i].benchmark.items * 1e9 / median : 0.0;
+    std::cout << "  t" << threads[i] << " " << std::setprecision(2)
+              << speedup << "x " << std::setprecision(0)
+              << 100.0 * efficiency << "%"
+              << (efficiency < EFFICIENCY_THRESHOLD ? "!" : "") << " "
+              << std::setprecision(1) << pixelsPerSecond / 1e6 << " Mpx/s";
+  }
+  std::cout << std::endl;
+
+  for (size_t i = 0; i < stages.size(); ++i) {
+    std::cout << "    t" << threads[i] << ":";
+    PrintStage("preprocess", stages[i].preprocessMs, stages[0].preprocessMs);
+    PrintStage("contours", stages[i].contoursMs, stages[0].contoursMs);
+    PrintStage("classify", stages[i].classifyMs, stages[0].classifyMs);
+    std::cout << std::endl;
+  }
+}
+
+// Times body at every thread count, runs the instrumented call outside
+// the timed samples for per-stage times, then prints how it scaled
+void RunAtThreadCounts(
+    BenchmarkRunner &runner, const std::string &name,
+    const std::string &density, int width, double pixels,
+    const std::vector<int> &threads, const std::function<void()> &body,
+    const std::function<void(DetectionStats &)> &instrumented) {
+  const int originalThreads = omp_get_max_threads();
+  std::vector<int> measured;
+  std::vector<StageTimes> stages;
+  for (int t : threads) {
+    omp_set_num_threads(t);
+    const size_t before = runner.Results().size();
+    runner.Run({CaseName(name, t), width, density, pixels}, body);
+    if (runner.Results().size() > before) {
+      measured.push_back(t);
+      if (DETECTION_STATS_ENABLED)
+        stages.push_back(MeasureStages(instrumented));
+    }
+  }
+  omp_set_num_threads(originalThreads);
+
+  if (!measured.empty()) {
+    const auto &results = runner.Results();
+    PrintScaling(name, density, &results[results.size() - measured.size()],
+                 measured, stages);
+  }
+}
+
+} // namespace
+
+void RunScalingBenchmarks(BenchmarkRunner &runner) {
+  const BenchmarkOptions &options = runner.Options();
+  const std::vector<int> threads = ThreadCounts(options);
+
+  RectangleDetector rectangleDetector;
+  SphereDetector sphereDetector;
+
+  for (const Resolution &resolution : RESOLUTIONS) {
+    if (std::find(options.resolutions.begin(), options.resolutions.end(),
+                  resolution.name) == options.resolutions.end())
+      continue;
+
+    const std::string rectangleName =
+        std::string("scaling/") + resolution.name + "/rectangle";
+    const std::string sphereName =
+        std::string("scaling/") + resolution.name + "/sphere";
+    const bool anySelected =
+        std::any_of(threads.begin(), threads.end(), [&](int t) {
+          return runner.Selected(CaseName(rectangleName, t)) ||
+                 runner.Selected(CaseName(sphereName, t));
+        });
+    if (!anySelected)
+      continue;
+
+    const double pixels =
+        static_cast<double>(resolution.width) * resolution.height;
+
+    for (const std::string &density : options.densities) {
+      // --list never calls the bodies, so skip rendering 8K frames
+      const BenchmarkFrame frame =
+          options.list
+              ? BenchmarkFrame{Scene(0, 0), Image(0, 0)}
+              : MakeBenchmarkFrame(resolution.width, resolution.height,
+                                   density);
+
+      const Image &image = frame.degraded;
+      RunAtThreadCounts(
+          runner, rectangleName, density, resolution.width, pixels, threads,
+          [&] { KeepAlive(rectangleDetector.DetectRectangles(image)); },
+          [&](DetectionStats &stats) {
+            KeepAlive(rectangleDetector.DetectRectangles(image, stats));
+          });
+      RunAtThreadCounts(
+          runner, sphereName, density, resolution.width, pixels, threads,
+          [&] { KeepAlive(sphereDetector.DetectSpheres(image)); },
+          [&](DetectionStats &stats) {
+            KeepAlive(sphereDetector.DetectSpheres(image, stats));
+          });
+    }
+  }
+}
@@ -0,0 +1,160 @@
+#include "BenchmarkSuites.hpp"
+#include "ShapeDetector/SphereDetector.hpp"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+
+namespace {
+
+// SplitMix64 finalizer, so every input is the same on every run
+uint64_t Mix(uint64_t value) {
+  value += 0x9E3779B97F4A7C15ull;
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+  return value ^ (value >> 31);
+}
+
+uint64_t Noise(int x, int y) {
+  return Mix((static_cast<uint64_t>(y) << 32) | static_cast<uint32_t>(x));
+}
+
+template <typename Pixel> Image Generate(int size, Pixel pixel) {
+  Image image(size, size);
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x)
+      image.pixels[y][x] = pixel(x, y);
+  }
+  return image;
+}
+
+Image Checkerboard(int size, int cell) {
+  return Generate(size, [=](int x, int y) {
+    return (x / cell + y / cell) % 2 * 255;
+  });
+}
+
+// Distance from the frame center, for the radial inputs
+double Radius(int size, int x, int y) {
+  return std::hypot(x - size / 2.0, y - size / 2.0);
+}
+
+// Inputs that maximize per-component or per-pixel work rather than look
+// like real frames
+struct StressInput {
+  const char *name;
+  Image (*generate)(int size);
+};
+
+const StressInput STRESS_INPUTS[] = {
+    // Thousands of tiny components
+    {"checkerboard2", [](int size) { return Checkerboard(size, 2); }},
+    {"checkerboard8", [](int size) { return Checkerboard(size, 8); }},
+    {"salt-pepper",
+     [](int size) {
+       return Generate(size,
+                       [](int x, int y) { return (Noise(x, y) & 1) * 255; });
+     }},
+    {"uniform-noise",
+     [](int size) {
+       return Generate(size,
+                       [](int x, int y) { return int(Noise(x, y) & 255); });
+     }},
+    // One huge component with a ragged boundary
+    {"noisy-blob",
+     [](int size) {
+       return Generate(size, [=](int x, int y) {
+         const double jitter = static_cast<double>(Noise(x, y) % 25) - 12.0;
+         return Radius(size, x, y) + jitter < 0.45 * size ? 255 : 0;
+       });
+     }},
+    // One component spanning the frame around thousands of holes
+    {"mesh",
+     [](int size) {
+       return Generate(size,
+                       [](int x, int y) { return x % 4 && y % 4 ? 0 : 255; });
+     }},
+    // Long closed and open curves
+    {"rings",
+     [](int size) {
+       return Generate(size, [=](int x, int y) {
+         return static_cast<int>(Radius(size, x, y)) / 3 % 2 * 255;
+       });
+     }},
+    {"spiral",
+     [](int size) {
+       return Generate(size, [=](int x, int y) {
+         const double angle = std::atan2(y - size / 2.0, x - size / 2.0);
+         const double turn =
+             Radius(size, x, y) / 8.0 - angle / (2 * std::numbers::pi);
+         return turn - std::floor(turn) < 0.3 ? 255 : 0;
+       });
+     }},
+    {"radial-gradient",
+     [](int size) {
+       return Generate(size, [=](int x, int y) {
+         return static_cast<int>(255.0 * Radius(size, x, y) /
+                                 (size / 2.0 * std::numbers::sqrt2));
+       });
+     }},
+    {"solid",
+     [](int size) { return Generate(size, [](int, int) { return 255; }); }},
+};
+
+} // namespace
+
+bool RunStressBenchmarks(BenchmarkRunner &runner) {
+  const BenchmarkOptions &options = runner.Options();
+  RectangleDetector rectangleDetector;
+  SphereDetector sphereDetector;
+
+  struct Verdict {
+    std::string name;
+    int size;
+    double msPerMegapixel;
+  };
+  std::vector<Verdict> verdicts;
+
+  auto run = [&](const std::string &name, int size,
+                 const std::function<void()> &body) {
+    const size_t before = runner.Results().size();
+    const double pixels = static_cast<double>(size) * size;
+    runner.Run({name, size, "", pixels}, body);
+    if (runner.Results().size() > before) {
+      // Budget the slowest sample: worst case, not typical cost
+      verdicts.push_back(
+          {name, size, runner.Results().back().max / 1e6 / (pixels / 1e6)});
+    }
+  };
+
+  for (int size : options.sizes) {
+    for (const StressInput &input : STRESS_INPUTS) {
+      const std::string prefix = std::string("stress/") + input.name;
+      if (!runner.Selected(prefix + "/rectangle") &&
+          !runner.Selected(prefix + "/sphere"))
+        continue;
+
+      const Image image = options.list ? Image(0, 0) : input.generate(size);
+      run(prefix + "/rectangle", size,
+          [&] { KeepAlive(rectangleDetector.DetectRectangles(image)); });
+      run(prefix + "/sphere", size,
+          [&] { KeepAlive(sphereDetector.DetectSpheres(image)); });
+    }
+  }
+
+  if (verdicts.empty())
+    return true;
+
+  bool ok = true;
+  std::cout << "\nslowest sample in ms per megapixel, budget " << std::fixed
+            << std::setprecision(0) << options.stressBudgetMs << "\n";
+  for (const Verdict &verdict : verdicts) {
+    const bool over = verdict.msPerMegapixel > options.stressBudgetMs;
+    ok = ok && !over;
+    std::cout << "  " << std::left << std::setw(34) << verdict.name
+              << std::right << std::setw(6) << verdict.size << std::setw(10)
+              << verdict.msPerMegapixel
+              << (over ? "  OVER BUDGET" : "") << "\n";
+  }
+  return ok;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Build with -DSHAPE_DETECTOR_ALLOC_HOOKS=1 to replace the global operator
+// new; without it the tracker reports nothing
+#ifndef SHAPE_DETECTOR_ALLOC_HOOKS
+#define SHAPE_DETECTOR_ALLOC_HOOKS 0
+#endif
+
+struct AllocationCounts {
+  uint64_t allocations = 0;
+  uint64_t frees = 0;
+  uint64_t bytes = 0; // requested by the allocations
+
+  AllocationCounts operator-(const AllocationCounts &other) const {
+    return {allocations - other.allocations, frees - other.frees,
+            bytes - other.bytes};
+  }
+};
+
+// Counts global operator new/delete calls while enabled. Each thread bumps
+// its own cache-line sized slot, so counting adds no contention between
+// OpenMP workers; totals sum the slots of all threads.
+class AllocationTracker {
+public:
+  // False when the operator new hooks are compiled out
+  static bool Available();
+
+  // Enabled while switched on here or while any AllocationScope is alive
+  static void Enable();
+  static void Disable();
+  static bool Enabled();
+
+  // Since process start, counting only while enabled
+  static AllocationCounts Total();
+  static AllocationCounts ThisThread();
+};
+
+// Counts allocations of every thread from construction until Counts(),
+// keeping the tracker enabled for its lifetime. Scopes nest: counting
+// stays on until the last one is destroyed.
+class AllocationScope {
+public:
+  AllocationScope();
+  ~AllocationScope();
+  AllocationScope(const AllocationScope &) = delete;
+  AllocationScope &operator=(const AllocationScope &) = delete;
+
+  AllocationCounts Counts() const;
+
+private:
+  AllocationCounts start_;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ContourSet.hpp"
+#include "GeometryPolicy.hpp"
+#include <vector>
+
+// Shape features of one closed contour
+struct ContourFeatures {
+  double area = 0.0;      // shoelace area of the closed polygon
+  double perimeter = 0.0; // length of the closed polyline
+  double centroidX = 0.0; // mean of the points
+  double centroidY = 0.0;
+  // Standard deviation of the point distances to the centroid over their
+  // mean; small for circles
+  double radialSpread = 0.0;
+
+  // perimeter^2 / (4 pi area): 1 for a circle, larger for anything else;
+  // 0 when the contour encloses no area
+  double Circularity() const;
+};
+
+// Measures every contour of a ContourSet in unit-stride sweeps over its
+// coordinate arrays. The wrap padding stands in for the (i + 1) % n of the
+// per-contour helpers, so each sweep is a plain reduction the compiler
+// vectorizes. Kernels compute in the precision of the build unless one is
+// named; all three are instantiated.
+class ContourGeometry {
+public:
+  template <GeometryPrecision Precision = GEOMETRY_PRECISION>
+  static void Measure(const ContourSet &contours,
+                      std::vector<ContourFeatures> &features);
+  template <GeometryPrecision Precision = GEOMETRY_PRECISION>
+  static ContourFeatures Measure(const ContourSet &contours, size_t contour);
+  template <GeometryPrecision Precision = GEOMETRY_PRECISION>
+  static ContourFeatures Measure(const ContourView &contour);
+
+  // Index of the point strictly between first and last farthest from the
+  // line through them, the first one on ties; first when none is off the
+  // line. distanceSquared receives its squared distance.
+  template <GeometryPrecision Precision = GEOMETRY_PRECISION>
+  static size_t FarthestFromChord(const ContourSet::Coordinate *xs,
+                                  const ContourSet::Coordinate *ys,
+                                  size_t first, size_t last,
+                                  double &distanceSquared);
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "RectangleDetector.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+struct ContourView;
+
+// Traced contours stored as structure-of-arrays in one flat arena: the x
+// and y coordinates of every contour sit back to back in two contiguous
+// arrays, and an offset table marks where each contour starts. Tracing a
+// frame costs a handful of allocations instead of one per contour, and
+// sweeps over a contour's coordinates are unit-stride loads.
+class ContourSet {
+public:
+  // Wide enough for any image the detectors accept
+  using Coordinate = int32_t;
+  // Each contour is followed by a copy of its first point, so closed-loop
+  // sweeps read point i + 1 without wrapping the index
+  static constexpr size_t WRAP_PADDING = 1;
+
+  size_t Size() const { return offsets_.size() - 1; }
+  bool Empty() const { return Size() == 0; }
+  size_t TotalPoints() const { return xs_.size() - Size() * WRAP_PADDING; }
+  size_t PointCount(size_t contour) const {
+    return offsets_[contour + 1] - offsets_[contour] - WRAP_PADDING;
+  }
+
+  // First coordinate of a contour; PointCount(contour) follow it, then the
+  // wrap padding
+  const Coordinate *X(size_t contour) const {
+    return xs_.data() + offsets_[contour];
+  }
+  const Coordinate *Y(size_t contour) const {
+    return ys_.data() + offsets_[contour];
+  }
+  Point At(size_t contour, size_t index) const {
+    const size_t i = offsets_[contour] + index;
+    return Point(xs_[i], ys_[i]);
+  }
+
+  // The points of one contour without a copy
+  ContourView View(size_t contour) const;
+
+  void Append(const std::vector<Point> &contour);
+  // Appends every stride-th point of a contour of another set, in order
+  void Append(const ContourSet &from, size_t contour, size_t stride = 1);
+  // Replaces out with every stride-th point of the contour, in order
+  void CopyTo(size_t contour, std::vector<Point> &out,
+              size_t stride = 1) const;
+  std::vector<Point> Points(size_t contour) const;
+
+  // Tracing builds a contour in place: Push adds a point to the open
+  // contour after the last one, then Close keeps it and Discard drops it
+  void Push(Coordinate x, Coordinate y) {
+    xs_.push_back(x);
+    ys_.push_back(y);
+  }
+  size_t OpenPointCount() const { return xs_.size() - offsets_.back(); }
+  void Close();
+  void Discard();
+  // Orders the open contour's points as std::sort would a vector of them
+  template <typename Compare> void SortOpen(Compare compare);
+
+  void Reserve(size_t contours, size_t points);
+  // Drops all contours but keeps the arena for the next frame
+  void Clear();
+  size_t CapacityBytes() const;
+
+private:
+  class OpenIterator;
+
+  std::vector<Coordinate> xs_;
+  std::vector<Coordinate> ys_;
+  std::vector<uint32_t> offsets_{0};
+};
+
+// Read-only window onto the coordinates of one contour, which its set or
+// scratch buffer owns: count points, then the wrap padding
+struct ContourView {
+  const ContourSet::Coordinate *xs;
+  const ContourSet::Coordinate *ys;
+  size_t count;
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  Point operator[](size_t i) const { return Point(xs[i], ys[i]); }
+};
+
+inline ContourView ContourSet::View(size_t contour) const {
+  return {X(contour), Y(contour), PointCount(contour)};
+}
+
+// Random-access iterator over the open contour whose references write
+// through to both coordinate arrays, so std::sort permutes them in place
+class ContourSet::OpenIterator {
+public:
+  struct Reference {
+    Coordinate *x;
+    Coordinate *y;
+
+    operator Point() const { return Point(*x, *y); }
+    Reference &operator=(const Point &p) {
+      *x = p.x;
+      *y = p.y;
+      return *this;
+    }
+    Reference &operator=(const Reference &other) {
+      return *this = static_cast<Point>(other);
+    }
+    friend void swap(Reference a, Reference b) {
+      std::swap(*a.x, *b.x);
+      std::swap(*a.y, *b.y);
+    }
+  };
+
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = Point;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = Reference;
+
+  OpenIterator(Coordinate *x, Coordinate *y) : x_(x), y_(y) {}
+
+  Reference operator*() const { return {x_, y_}; }
+  Reference operator[](difference_type n) const { return {x_ + n, y_ + n}; }
+  OpenIterator &operator++() { return *this += 1; }
+  OpenIterator &operator--() { return *this -= 1; }
+  OpenIterator operator++(int) {
+    OpenIterator old = *this;
+    ++*this;
+    return old;
+  }
+  OpenIterator operator--(int) {
+    OpenIterator old = *this;
+    --*this;
+    return old;
+  }
+  OpenIterator &operator+=(difference_type n) {
+    x_ += n;
+    y_ += n;
+    return *this;
+  }
+  OpenIterator &operator-=(difference_type n) { return *this += -n; }
+  OpenIterator operator+(difference_type n) const {
+    return OpenIterator(x_ + n, y_ + n);
+  }
+  OpenIterator operator-(difference_type n) const {
+    return OpenIterator(x_ - n, y_ - n);
+  }
+  difference_type operator-(const OpenIterator &other) const {
+    return x_ - other.x_;
+  }
+  auto operator<=>(const OpenIterator &other) const {
+    return x_ <=> other.x_;
+  }
+  bool operator==(const OpenIterator &other) const {
+    return x_ == other.x_;
+  }
+
+private:
+  Coordinate *x_;
+  Coordinate *y_;
+};
+
+template <typename Compare> void ContourSet::SortOpen(Compare compare) {
+  const size_t first = offsets_.back();
+  std::sort(OpenIterator(xs_.data() + first, ys_.data() + first),
+            OpenIterator(xs_.data() + xs_.size(), ys_.data() + ys_.size()),
+            [&compare](const Point &a, const Point &b) {
+              return compare(a, b);
+            });
+}
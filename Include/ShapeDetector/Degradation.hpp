@@ -0,0 +1,41 @@
+#pragma once
+
+#include "RectangleDetector.hpp"
+#include <cstdint>
+
+// Parameters of the sensor and transport effects applied to a clean frame.
+// A zero value disables the corresponding stage.
+struct DegradationConfig {
+  int occluderCount = 0;       // random gray boxes covering parts of the frame
+  double occluderSize = 0.1;   // largest box side as a fraction of the frame
+  double gradientStrength = 0; // illumination falloff across the frame, 0..1
+  double blurSigma = 0;        // Gaussian blur in pixels
+  double noiseSigma = 0;       // additive Gaussian noise in gray levels
+  int blockSize = 0;           // JPEG-like block size, typically 8
+  int blockQuantization = 32;  // residual quantization step inside a block
+  double saltPepperRate = 0;   // fraction of pixels forced to 0 or 255
+
+  // Settings that resemble our noisy production captures
+  static DegradationConfig Production();
+};
+
+// Seeded degradation pipeline for synthetic frames. Every stage draws its
+// randomness from a counter-based hash of (seed, stage, x, y), so results are
+// identical regardless of thread count and inner loops vectorize.
+class Degradation {
+public:
+  // Stages run in capture order: occlusion, illumination, blur, noise,
+  // blocking, salt-and-pepper
+  static void Apply(Image &image, const DegradationConfig &config,
+                    uint64_t seed);
+
+  static void AddOcclusions(Image &image, int count, double maxSize,
+                            uint64_t seed);
+  static void ApplyIlluminationGradient(Image &image, double strength,
+                                        uint64_t seed);
+  static void ApplyBlur(Image &image, double sigma);
+  static void AddGaussianNoise(Image &image, double sigma, uint64_t seed);
+  static void ApplyBlockArtifacts(Image &image, int blockSize,
+                                  int quantization);
+  static void AddSaltAndPepper(Image &image, double rate, uint64_t seed);
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Build with -DSHAPE_DETECTOR_STATS=0 to compile all collection out; the
+// struct stays so callers do not need their own #ifs
+#ifndef SHAPE_DETECTOR_STATS
+#define SHAPE_DETECTOR_STATS 1
+#endif
+
+inline constexpr bool DETECTION_STATS_ENABLED = SHAPE_DETECTOR_STATS != 0;
+
+// Why a contour was not reported as a shape
+enum class RejectReason {
+  TooFewPoints,     // contour shorter than the classifier minimum
+  VertexCount,      // approximation did not give 4-6 corners
+  Area,             // outside the min/max area
+  NotQuadrilateral, // opposite sides not parallel
+  Circular,         // contour hugs its hull like a circle
+  Moments,          // relaxed corner check failed the moment test
+  Rectangularity,   // too little of the bounding box covered
+  Degenerate,       // corners did not form a rectangle with positive size
+  NotCircular,      // circularity below threshold
+  CircleGeometry,   // radial profile does not match the fitted circle
+  RadiusRange,      // fitted radius outside min/max radius
+  LowConfidence,    // circle fit error too large
+  Count
+};
+
+// Which step of RectangleDetector::ApproximateContour produced the corners
+enum class ApproximationBranch {
+  Moments,
+  Hough,
+  Curvature,
+  DouglasPeucker, // one of the multi-epsilon passes
+  ConvexHull,
+  FinalDouglasPeucker,
+  Count
+};
+
+struct StrategyStats {
+  const char *name = nullptr;
+  double preprocessMs = 0.0;
+  double contoursMs = 0.0;
+  double classifyMs = 0.0;
+  int contours = 0; // contours handed to the classifier
+  int accepted = 0; // shapes produced before duplicate removal
+  uint64_t allocations = 0; // heap allocations, see AllocationTracker
+  uint64_t allocatedBytes = 0;
+};
+
+// Optional record of what a detection call did. Counters accumulate, so one
+// instance can summarize a whole batch of calls.
+struct DetectionStats {
+  static constexpr int MAX_STRATEGIES = 5;
+
+  std::array<StrategyStats, MAX_STRATEGIES> strategies{};
+  int strategyCount = 0;
+  std::array<int, static_cast<int>(RejectReason::Count)> rejections{};
+  std::array<int, static_cast<int>(ApproximationBranch::Count)> branches{};
+  int decimatedContours = 0; // subsampled by the contour size guard
+  int duplicateInput = 0;  // candidates entering duplicate removal
+  int duplicateOutput = 0; // shapes left after duplicate removal
+  size_t bytesAllocated = 0; // intermediate images and contour buffers
+  // Measured by AllocationTracker on all threads; 0 when its hooks are
+  // compiled out
+  uint64_t heapAllocations = 0;
+  uint64_t heapBytes = 0;
+  double totalMs = 0.0;
+
+  int Rejections(RejectReason reason) const {
+    return rejections[static_cast<int>(reason)];
+  }
+  int Branch(ApproximationBranch branch) const {
+    return branches[static_cast<int>(branch)];
+  }
+
+  static const char *Name(RejectReason reason);
+  static const char *Name(ApproximationBranch branch);
+};
+
+// Counter update safe to call from OpenMP worker threads; expands to nothing
+// when collection is compiled out
+#if SHAPE_DETECTOR_STATS
+#define DETECTION_STATS_INCREMENT(stats, counter)                              \
+  do {                                                                         \
+    if (stats) {                                                               \
+      _Pragma("omp atomic") (stats)->counter++;                                \
+    }                                                                          \
+  } while (0)
+#else
+#define DETECTION_STATS_INCREMENT(stats, counter)                              \
+  do {                                                                         \
+  } while (0)
+#endif
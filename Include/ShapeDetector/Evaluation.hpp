@@ -0,0 +1,39 @@
+#pragma once
+
+#include "SceneGenerator.hpp"
+#include <vector>
+
+// One-to-one matching outcome of detections against ground truth
+struct MatchCounts {
+  int truePositives = 0;
+  int falsePositives = 0; // detections without a ground-truth shape
+  int falseNegatives = 0; // ground-truth shapes nobody reported
+
+  // Both are 1.0 when there is nothing to get wrong
+  double Precision() const;
+  double Recall() const;
+  double F1() const;
+
+  MatchCounts &operator+=(const MatchCounts &other);
+};
+
+struct SceneEvaluation {
+  MatchCounts rectangles;
+  MatchCounts spheres; // circles and ellipses of the scene
+};
+
+// Scores detector output against a generated scene. Each ground-truth shape
+// is matched to the nearest unclaimed detection whose center and size agree
+// within a tolerance that grows with the shape; distractors only ever show
+// up as false positives.
+class Evaluation {
+public:
+  static MatchCounts MatchRectangles(const std::vector<Rectangle> &detected,
+                                     const std::vector<Rectangle> &truth);
+  static MatchCounts MatchSpheres(const std::vector<Sphere> &detected,
+                                  const std::vector<Sphere> &circles,
+                                  const std::vector<Ellipse> &ellipses);
+  static SceneEvaluation Evaluate(const Scene &scene,
+                                  const std::vector<Rectangle> &rectangles,
+                                  const std::vector<Sphere> &spheres);
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+// Polynomial approximations of the inverse and forward trigonometric
+// functions the classifier needs, with bounded absolute error. Each one is
+// branch-free (selects only) and inline, so loops calling them vectorize
+// instead of stopping at a libm call.
+//
+// Where only a threshold on an angle matters, the cosine tests below avoid
+// trigonometry and square roots altogether: they compare the dot product of
+// two vectors against a constant scaled by their squared lengths.
+class FastMath {
+public:
+  // Largest absolute error in radians, from Abramowitz & Stegun 4.4.46 and
+  // 4.4.49, plus rounding
+  static constexpr double ACOS_MAX_ERROR = 3e-8;
+  static constexpr double ATAN2_MAX_ERROR = 3e-8;
+  // For |angle| up to SINCOS_MAX_ANGLE
+  static constexpr double SINCOS_MAX_ERROR = 1e-10;
+  static constexpr double SINCOS_MAX_ANGLE = 1e6;
+
+  // Arc cosine of x, clamped to [-1, 1]
+  static double Acos(double x) {
+    x = std::clamp(x, -1.0, 1.0);
+    const double a = std::abs(x);
+    const double p =
+        1.5707963050 +
+        a * (-0.2145988016 +
+             a * (0.0889789874 +
+                  a * (-0.0501743046 +
+                       a * (0.0308918810 +
+                            a * (-0.0170881256 +
+                                 a * (0.0066700901 + a * -0.0012624911))))));
+    const double angle = std::sqrt(1.0 - a) * p;
+    return x < 0.0 ? std::numbers::pi - angle : angle;
+  }
+
+  // Angle of (x, y) in [-pi, pi]; 0 for the origin
+  static double Atan2(double y, double x) {
+    const double ax = std::abs(x);
+    const double ay = std::abs(y);
+    const double high = std::max(ax, ay);
+    const double t = high > 0.0 ? std::min(ax, ay) / high : 0.0;
+    const double t2 = t * t;
+    const double p =
+        1.0 +
+        t2 * (-0.3333314528 +
+              t2 * (0.1999355085 +
+                    t2 * (-0.1420889944 +
+                          t2 * (0.1065626393 +
+                                t2 * (-0.0752896400 +
+                                      t2 * (0.0429096138 +
+                                            t2 * (-0.0161657367 +
+                                                  t2 * 0.0028662257)))))));
+    double angle = t * p;
+    angle = ay > ax ? std::numbers::pi / 2.0 - angle : angle;
+    angle = x < 0.0 ? std::numbers::pi - angle : angle;
+    return std::copysign(angle, y);
+  }
+
+  // Sine and cosine together, reduced to [-pi/4, pi/4] by quadrant
+  static void SinCos(double angle, double &sine, double &cosine) {
+    const double quadrant =
+        std::floor(angle * (2.0 / std::numbers::pi) + 0.5);
+    const double r = angle - quadrant * (std::numbers::pi / 2.0);
+    const double r2 = r * r;
+    const double s =
+        r * (1.0 +
+             r2 * (-1.0 / 6.0 +
+                   r2 * (1.0 / 120.0 +
+                         r2 * (-1.0 / 5040.0 +
+                               r2 * (1.0 / 362880.0 +
+                                     r2 * (-1.0 / 39916800.0))))));
+    const double c =
+        1.0 +
+        r2 * (-0.5 +
+              r2 * (1.0 / 24.0 +
+                    r2 * (-1.0 / 720.0 +
+                          r2 * (1.0 / 40320.0 +
+                                r2 * (-1.0 / 3628800.0 +
+                                      r2 * (1.0 / 479001600.0))))));
+
+    // Quadrant q maps (s, c) to (s, c), (c, -s), (-s, -c), (-c, s)
+    const int64_t q = static_cast<int64_t>(quadrant);
+    const bool swap = q & 1;
+    const double sineBase = swap ? c : s;
+    const double cosineBase = swap ? s : c;
+    sine = (q & 2) ? -sineBase : sineBase;
+    cosine = ((q + 1) & 2) ? -cosineBase : cosineBase;
+  }
+
+  // Angle tests on vectors u and v through their cosine, dot / (|u| |v|).
+  // limit is a cosine in [0, 1]; a zero vector has cosine 1.
+  static bool AbsCosineAbove(double ux, double uy, double vx, double vy,
+                             double limit) {
+    const double dot = ux * vx + uy * vy;
+    const double lengths = (ux * ux + uy * uy) * (vx * vx + vy * vy);
+    return lengths == 0.0 || dot * dot > limit * limit * lengths;
+  }
+  static bool AbsCosineBelow(double ux, double uy, double vx, double vy,
+                             double limit) {
+    const double dot = ux * vx + uy * vy;
+    const double lengths = (ux * ux + uy * uy) * (vx * vx + vy * vy);
+    return lengths != 0.0 && dot * dot < limit * limit * lengths;
+  }
+
+  // cos |cos| of the angle between u and v: ordered like the cosine, so
+  // like the angle reversed, without a root or an arc cosine
+  static double SignedCosineSquared(double ux, double uy, double vx,
+                                    double vy) {
+    const double dot = ux * vx + uy * vy;
+    const double lengths = (ux * ux + uy * uy) * (vx * vx + vy * vy);
+    return lengths == 0.0 ? 1.0 : dot * std::abs(dot) / lengths;
+  }
+
+  // Folds an angle difference into [0, pi / 2]: the angle between two
+  // undirected lines at those orientations
+  static double LineAngleDifference(double a, double b) {
+    double difference = std::abs(a - b);
+    difference -=
+        std::numbers::pi * std::floor(difference * std::numbers::inv_pi);
+    return std::min(difference, std::numbers::pi - difference);
+  }
+};
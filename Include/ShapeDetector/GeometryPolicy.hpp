@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+// Arithmetic of the batched contour geometry kernels. Contour coordinates
+// are small integers, so double is rarely needed: float doubles the SIMD
+// lanes, and fixed point (no fractional bits) keeps products and sums of
+// coordinates in 32-bit integer lanes, exact within the limits below, using
+// float only for square roots.
+enum class GeometryPrecision { Double, Float, Fixed };
+
+// Configure with -DSHAPE_DETECTOR_GEOMETRY=float or fixed to change the
+// kernels the detectors use; every precision stays available to callers
+// that name it explicitly
+#if defined(SHAPE_DETECTOR_GEOMETRY_FIXED) && SHAPE_DETECTOR_GEOMETRY_FIXED
+inline constexpr GeometryPrecision GEOMETRY_PRECISION =
+    GeometryPrecision::Fixed;
+#elif defined(SHAPE_DETECTOR_GEOMETRY_FLOAT) && SHAPE_DETECTOR_GEOMETRY_FLOAT
+inline constexpr GeometryPrecision GEOMETRY_PRECISION =
+    GeometryPrecision::Float;
+#else
+inline constexpr GeometryPrecision GEOMETRY_PRECISION =
+    GeometryPrecision::Double;
+#endif
+
+// Fixed point holds a chord residual a x + b y + c in 32 bits as long as
+// every coordinate is within this bound, i.e. for frames up to 16k pixels
+inline constexpr int32_t FIXED_COORDINATE_LIMIT = 16383;
+// Fixed-point sums wrap modulo 2^32 and are exact when the true sum stays
+// below this; half the int32 range leaves room for the float estimate the
+// kernels bound it with
+inline constexpr double FIXED_SUM_LIMIT = 1 << 30;
+
+template <GeometryPrecision Precision> struct GeometryTypes;
+
+template <> struct GeometryTypes<GeometryPrecision::Double> {
+  using Exact = double; // products and sums of coordinates
+  using Real = double;  // roots and ratios
+};
+
+template <> struct GeometryTypes<GeometryPrecision::Float> {
+  using Exact = float;
+  using Real = float;
+};
+
+template <> struct GeometryTypes<GeometryPrecision::Fixed> {
+  using Exact = int32_t;
+  using Real = float;
+};
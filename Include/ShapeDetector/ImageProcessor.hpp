@@ -1,6 +1,7 @@
 #pragma once
 
 #include "RectangleDetector.hpp"
+#include <cstdio>
 #include <fstream>
 #include <string>
 
@@ -20,6 +21,41 @@ struct ColorImage {
   }
 };
 
+// Non-owning view of an interleaved RGB buffer (3 bytes per pixel). The
+// buffer may belong to the caller, e.g. a camera frame already holding the
+// source image.
+struct RgbView {
+  unsigned char *data;
+  int width, height;
+  int stride; // bytes between the starts of consecutive rows
+};
+
+// Contiguous interleaved RGB image, row-major without padding
+struct RgbImage {
+  int width, height;
+  std::vector<unsigned char> data;
+
+  RgbImage(int w, int h)
+      : width(w), height(h), data(static_cast<size_t>(w) * h * 3) {}
+
+  RgbView View() { return {data.data(), width, height, width * 3}; }
+};
+
+// Horizontal run of overlay pixels on one row, inclusive of both ends
+struct OverlaySpan {
+  int x1, x2;
+  ColorPixel color;
+};
+
+// Sparse annotation layer: span lists per row, painted in insertion order on
+// top of a grey frame when it is encoded
+struct Overlay {
+  int width, height;
+  std::vector<std::vector<OverlaySpan>> rows;
+
+  Overlay(int w, int h) : width(w), height(h), rows(h) {}
+};
+
 class ImageProcessor {
 public:
   static Image LoadPGMImage(const std::string &filepath);
@@ -28,6 +64,14 @@ public:
                            const std::string &filepath);
   static void SavePNGImage(const ColorImage &image,
                            const std::string &filepath);
+  static void SavePPMImage(const RgbImage &image, const std::string &filepath);
+  static void SavePNGImage(const RgbImage &image, const std::string &filepath);
+  // Composite grey input and overlay row by row while encoding, without
+  // materializing a full colour frame
+  static void SavePPMImage(const Image &grayImage, const Overlay &overlay,
+                           const std::string &filepath);
+  static void SavePNGImage(const Image &grayImage, const Overlay &overlay,
+                           const std::string &filepath);
   static ColorImage CreateColorImage(const Image &grayImage,
                                      const std::vector<Rectangle> &rectangles);
   static ColorImage CreateColorImageWithObloids(const Image &grayImage,
@@ -36,6 +80,22 @@ public:
   static ColorImage CreateColorImageWithSpheres(const Image &grayImage,
                                                 const std::vector<Rectangle> &rectangles,
                                                 const std::vector<Sphere> &spheres);
+  static RgbImage CreateRgbImage(const Image &grayImage,
+                                 const std::vector<Rectangle> &rectangles,
+                                 const std::vector<Sphere> &spheres = {},
+                                 const std::vector<Obloid> &obloids = {});
+  // Writes grey values into every pixel of target (SIMD where available)
+  static void ExpandGrayToRgb(const Image &grayImage, const RgbView &target);
+  // Overlay-only rendering: draws outlines into a frame that already holds
+  // the source image, touching only the outline pixels
+  static void DrawOverlay(const RgbView &target,
+                          const std::vector<Rectangle> &rectangles,
+                          const std::vector<Sphere> &spheres = {},
+                          const std::vector<Obloid> &obloids = {});
+  static RegionOfInterest ClipRegion(const RegionOfInterest &region,
+                                     int width, int height);
+  static Image ExtractRegion(const Image &image,
+                             const RegionOfInterest &region);
   static Image ApplyThreshold(const Image &image, int threshold = 127);
   static Image ApplyGaussianBlur(const Image &image, int kernelSize = 5);
   static void DrawRectangles(Image &image,
@@ -44,6 +104,10 @@ public:
                           const std::vector<Obloid> &obloids);
   static void DrawSpheres(ColorImage &image,
                           const std::vector<Sphere> &spheres);
+  static void DrawRectangles(Overlay &overlay,
+                             const std::vector<Rectangle> &rectangles);
+  static void DrawObloids(Overlay &overlay, const std::vector<Obloid> &obloids);
+  static void DrawSpheres(Overlay &overlay, const std::vector<Sphere> &spheres);
   static Image CreateTestImage(int width, int height);
   static Image CreateTestImageWithMixedShapes(int width, int height);
   static void DrawCircle(Image &image, int centerX, int centerY, int radius,
@@ -65,12 +129,17 @@ public:
                                      double angleRadians);
 
 private:
+  template <typename Canvas>
+  static void DrawShapes(Canvas &canvas,
+                         const std::vector<Rectangle> &rectangles,
+                         const std::vector<Sphere> &spheres,
+                         const std::vector<Obloid> &obloids);
+  static bool WriteCompositedPPM(FILE *file, const Image &grayImage,
+                                 const Overlay &overlay);
   static std::vector<std::vector<double>> CreateGaussianKernel(int size);
   static void
   FillRotatedRectangle(Image &image,
                        const std::vector<std::pair<int, int>> &corners);
-  static bool IsPointInPolygon(int x, int y,
-                               const std::vector<std::pair<int, int>> &polygon);
   static std::vector<Point>
   CleanupRectangleCorners(const std::vector<Point> &corners);
   static std::vector<Point> GenerateRectangleCorners(const Rectangle &rect);
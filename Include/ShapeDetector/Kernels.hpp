@@ -0,0 +1,225 @@
+#pragma once
+
+#include "RectangleDetector.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+// Window sizes with a fully unrolled kernel: the 3, 5 and 7 pixel windows
+// the detectors' preprocessing actually uses
+template <int Size>
+concept UnrolledKernelSize = Size == 3 || Size == 5 || Size == 7;
+
+// Neighbourhood kernels of the preprocessing strategies. When the window
+// size (or the blur sigma) is a compile-time constant, the coefficients are
+// built at compile time and an unrolled kernel is picked with no runtime
+// dispatch: each output pixel is a fixed sequence of loads and
+// multiply-adds or min/max the compiler vectorizes across the row. The
+// runtime-sized overloads run generic loops and produce the same pixels.
+class Kernels {
+public:
+  // exp(x) in constant expressions, to about double precision
+  static constexpr double Exp(double x) {
+    // Halve into [-0.5, 0.5], sum the series there, then square back
+    int halvings = 0;
+    while (x < -0.5 || x > 0.5) {
+      x *= 0.5;
+      ++halvings;
+    }
+    double term = 1.0, sum = 1.0;
+    for (int n = 1; n < 20; ++n) {
+      term *= x / n;
+      sum += term;
+    }
+    for (int i = 0; i < halvings; ++i)
+      sum *= sum;
+    return sum;
+  }
+
+  // Taps of a Gaussian reaching three standard deviations each side
+  static constexpr int GaussianSize(double sigma) {
+    const double reach = 3.0 * sigma;
+    const int half = static_cast<int>(reach);
+    return 2 * (half < reach ? half + 1 : half) + 1;
+  }
+
+  // Normalized Gaussian weights, centre tap at Size / 2
+  template <int Size>
+  static constexpr std::array<double, Size> GaussianWeights(double sigma) {
+    std::array<double, Size> weights{};
+    double sum = 0.0;
+    for (int i = 0; i < Size; ++i) {
+      const int x = i - Size / 2;
+      weights[i] = Exp(-(x * x) / (2.0 * sigma * sigma));
+      sum += weights[i];
+    }
+    for (double &weight : weights)
+      weight /= sum;
+    return weights;
+  }
+  static std::vector<double> GaussianWeights(double sigma);
+
+  // Separable blur: a row pass then a column pass, clamped at the borders
+  // and rounded after each pass
+  template <double Sigma> static Image GaussianBlur(const Image &image) {
+    constexpr int size = GaussianSize(Sigma);
+    if constexpr (UnrolledKernelSize<size>) {
+      static constexpr std::array<double, size> weights =
+          GaussianWeights<size>(Sigma);
+      return Convolve<size>(image, weights);
+    } else {
+      return Convolve(image, GaussianWeights(Sigma));
+    }
+  }
+  static Image GaussianBlur(const Image &image, double sigma);
+
+  template <int Size>
+    requires UnrolledKernelSize<Size>
+  static Image Convolve(const Image &image,
+                        const std::array<double, Size> &weights);
+  static Image Convolve(const Image &image, const std::vector<double> &weights);
+
+  // Maximum (dilation) or minimum (erosion) over a Size x Size window.
+  // Only pixels where the whole window fits are written; the border of
+  // output keeps whatever the caller put there.
+  template <int Size>
+    requires UnrolledKernelSize<Size>
+  static void Dilate(const Image &image, Image &output);
+  template <int Size>
+    requires UnrolledKernelSize<Size>
+  static void Erode(const Image &image, Image &output);
+  static void Dilate(const Image &image, Image &output, int size);
+  static void Erode(const Image &image, Image &output, int size);
+
+  // Median of a Size x Size window, interior only like Dilate
+  template <int Size>
+    requires UnrolledKernelSize<Size>
+  static void Median(const Image &image, Image &output);
+  static void Median(const Image &image, Image &output, int size);
+
+  // Mean of the pixels in a Size x Size window within range of the centre
+  // value (exclusive), or the centre when none is: an edge-preserving
+  // smoothing, interior only
+  template <int Size>
+    requires UnrolledKernelSize<Size>
+  static void RangeMean(const Image &image, Image &output, int range);
+  static void RangeMean(const Image &image, Image &output, int size,
+                        int range);
+
+  // Per-pixel steps of the unrolled kernels, generic over the row type: a
+  // pointer, or any view with operator[] such as a row computed on the fly.
+  // rows[i] is image row y - Size / 2 + i; x is the output column and the
+  // window must fit around it.
+  template <int Size, typename Row>
+  static double RowTaps(const Row &row, int x,
+                        const std::array<double, Size> &weights) {
+    double value = 0.0;
+    Unroll<Size>(
+        [&](auto k) { value += row[x + k - Size / 2] * weights[k]; });
+    return value;
+  }
+  template <int Size, typename Row>
+  static double ColumnTaps(const std::array<Row, Size> &rows, int x,
+                           const std::array<double, Size> &weights) {
+    double value = 0.0;
+    Unroll<Size>([&](auto k) { value += rows[k][x] * weights[k]; });
+    return value;
+  }
+  // A blurred value as stored: rounded to the nearest integer
+  static int RoundPixel(double value) {
+    return static_cast<int>(std::round(value));
+  }
+
+  template <int Size, bool Maximum, typename Row>
+  static int WindowExtremum(const std::array<Row, Size> &rows, int x) {
+    int value = Maximum ? 0 : 255;
+    Unroll<Size>([&](auto dy) {
+      Unroll<Size>([&](auto dx) {
+        const int pixel = rows[dy][x + dx - Size / 2];
+        value = Maximum ? std::max(value, pixel) : std::min(value, pixel);
+      });
+    });
+    return value;
+  }
+
+  template <int Size, typename Row>
+  static int WindowMedian(const std::array<Row, Size> &rows, int x) {
+    if constexpr (Size == 3) {
+      return MedianOfNine(rows[0][x - 1], rows[0][x], rows[0][x + 1],
+                          rows[1][x - 1], rows[1][x], rows[1][x + 1],
+                          rows[2][x - 1], rows[2][x], rows[2][x + 1]);
+    } else {
+      std::array<int, Size * Size> values;
+      Unroll<Size>([&](auto dy) {
+        Unroll<Size>([&](auto dx) {
+          values[dy * Size + dx] = rows[dy][x + dx - Size / 2];
+        });
+      });
+      std::nth_element(values.begin(), values.begin() + Size * Size / 2,
+                       values.end());
+      return values[Size * Size / 2];
+    }
+  }
+
+  template <int Size, typename Row>
+  static int WindowRangeMean(const std::array<Row, Size> &rows, int x,
+                             int range) {
+    const int center = rows[Size / 2][x];
+    int sum = 0;
+    int count = 0;
+    Unroll<Size>([&](auto dy) {
+      Unroll<Size>([&](auto dx) {
+        const int pixel = rows[dy][x + dx - Size / 2];
+        const bool similar = std::abs(pixel - center) < range;
+        sum += similar ? pixel : 0;
+        count += similar;
+      });
+    });
+    // Truncating division through double, exact for these magnitudes,
+    // keeps the loop free of branches and integer division
+    return count > 0 ? static_cast<int>(static_cast<double>(sum) / count)
+                     : center;
+  }
+
+  // Calls body(std::integral_constant<int, I>()) for every I in
+  // [0, Count), unrolled at compile time
+  template <int Count, typename Body> static void Unroll(Body &&body) {
+    [&]<int... I>(std::integer_sequence<int, I...>) {
+      (body(std::integral_constant<int, I>()), ...);
+    }(std::make_integer_sequence<int, Count>());
+  }
+
+private:
+  // Median of nine by the 19 exchange network of Paeth and Devillard
+  static int MedianOfNine(int p0, int p1, int p2, int p3, int p4, int p5,
+                          int p6, int p7, int p8) {
+    auto sort = [](int &a, int &b) {
+      const int low = std::min(a, b);
+      b = std::max(a, b);
+      a = low;
+    };
+    sort(p1, p2);
+    sort(p4, p5);
+    sort(p7, p8);
+    sort(p0, p1);
+    sort(p3, p4);
+    sort(p6, p7);
+    sort(p1, p2);
+    sort(p4, p5);
+    sort(p7, p8);
+    sort(p0, p3);
+    sort(p5, p8);
+    sort(p4, p7);
+    sort(p3, p6);
+    sort(p1, p4);
+    sort(p2, p5);
+    sort(p4, p7);
+    sort(p4, p2);
+    sort(p6, p4);
+    sort(p4, p2);
+    return p4;
+  }
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// High-dynamic-range histogram of integer latencies in the HdrHistogram
+// layout: every power-of-two bucket is split into the same number of linear
+// sub-buckets, so any value between the lowest and highest trackable one is
+// kept to the configured number of significant decimal digits at a fixed
+// memory cost. Recording is a few shifts and one increment, cheap enough for
+// every frame and stage of a long run.
+class LatencyHistogram {
+public:
+  // Defaults cover 1 ns to one minute at 3 significant digits (~220 KB)
+  explicit LatencyHistogram(int64_t lowestTrackable = 1,
+                            int64_t highestTrackable = 60'000'000'000,
+                            int significantDigits = 3);
+
+  // Values outside the trackable range are clamped into it
+  void Record(int64_t value, int64_t count = 1);
+  void Merge(const LatencyHistogram &other);
+  void Reset();
+
+  int64_t Count() const { return totalCount_; }
+  int64_t Min() const; // exact, 0 when empty
+  int64_t Max() const; // exact, 0 when empty
+  double Mean() const;
+  double StdDeviation() const;
+  // Highest value equivalent to the recorded one at the given percentile
+  // (0-100); 0 when empty
+  int64_t ValueAtPercentile(double percentile) const;
+
+  // HdrHistogram percentile distribution (.hgrm), as written by
+  // outputPercentileDistribution and read by its plotting tools. Values
+  // are divided by valueScale, e.g. 1e6 to report nanoseconds as ms.
+  void WritePercentileDistribution(std::ostream &out,
+                                   double valueScale = 1.0,
+                                   int ticksPerHalfDistance = 5) const;
+  bool WritePercentileDistribution(const std::string &path,
+                                   double valueScale = 1.0) const;
+
+private:
+  int BucketIndex(int64_t value) const;
+  int SubBucketIndex(int64_t value, int bucketIndex) const;
+  size_t CountsIndex(int64_t value) const;
+  int64_t ValueFromIndex(size_t index) const;
+  int64_t LowestEquivalentValue(int64_t value) const;
+  int64_t HighestEquivalentValue(int64_t value) const;
+
+  int64_t lowestTrackable_;
+  int64_t highestTrackable_;
+  int significantDigits_;
+  int unitMagnitude_;
+  int subBucketHalfCountMagnitude_;
+  int64_t subBucketCount_;
+  int64_t subBucketHalfCount_;
+  int64_t subBucketMask_;
+  int bucketCount_;
+  std::vector<int64_t> counts_;
+  int64_t totalCount_ = 0;
+  int64_t min_ = 0;
+  int64_t max_ = 0;
+};
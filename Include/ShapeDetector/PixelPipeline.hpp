@@ -0,0 +1,523 @@
+#pragma once
+
+#include "Kernels.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Expression templates for preprocessing chains. A chain is written as
+// nested calls, innermost step first:
+//
+//   using P = PixelPipeline;
+//   Image binary = P::Evaluate(
+//       P::Threshold(P::GaussianBlur<0.8>(P::Input(image)), 127));
+//
+// and its shape is resolved at compile time. Point-wise steps never get a
+// pass of their own: above a stencil they are applied to each value the
+// stencil stores, below one to each value it loads. Only a stencil feeding
+// another stencil is materialized, so no image is written for point-wise
+// steps wherever they sit in the chain.
+//
+// Evaluate runs the whole chain one horizontal band at a time, bands in
+// parallel. Each band computes its stencil inputs over its own rows plus
+// the halo rows the stencils above them reach, into band-sized buffers that
+// stay in L2. Every stage reads what the previous one just wrote from
+// cache, so a frame costs about one read of the input and one write of the
+// output.
+class PixelPipeline {
+public:
+  // Working set a band aims to keep in a core's L2
+  static constexpr size_t BAND_BYTES = 256 * 1024;
+  // Bands are never thinner than this, nor than four halos, so the halo
+  // rows computed by both neighbouring bands stay a small overhead
+  static constexpr int MIN_BAND_ROWS = 16;
+
+  // Storage lent by the calling thread for one scope. Leases nest in stack
+  // order and each buffer keeps its capacity for the next band, so once a
+  // thread has evaluated a frame of some size, evaluating another of that
+  // size allocates nothing.
+  class Scratch {
+  public:
+    explicit Scratch(size_t size) : pool_(LocalPool()) {
+      // A deque: growing it leaves the buffers already lent in place
+      if (pool_.used == pool_.buffers.size())
+        pool_.buffers.emplace_back();
+      buffer_ = &pool_.buffers[pool_.used++];
+      buffer_->resize(size);
+    }
+    ~Scratch() { --pool_.used; }
+    Scratch(const Scratch &) = delete;
+    Scratch &operator=(const Scratch &) = delete;
+
+    int *Data() { return buffer_->data(); }
+    const int *Data() const { return buffer_->data(); }
+
+  private:
+    struct Pool {
+      std::deque<std::vector<int>> buffers;
+      size_t used = 0;
+    };
+    static Pool &LocalPool() {
+      thread_local Pool pool;
+      return pool;
+    }
+
+    Pool &pool_;
+    std::vector<int> *buffer_;
+  };
+
+  // Rows first .. last - 1 of a full-width image
+  struct Band {
+    int width;
+    int first;
+    Scratch pixels;
+
+    Band(int width, int first, int last)
+        : width(width), first(first),
+          pixels(static_cast<size_t>(width) * (last - first)) {}
+    int *Row(int y) { return pixels.Data() + Offset(y); }
+    const int *Row(int y) const { return pixels.Data() + Offset(y); }
+
+  private:
+    size_t Offset(int y) const {
+      return static_cast<size_t>(y - first) * width;
+    }
+  };
+
+  // Every expression has the dimensions of the image it computes, a HALO
+  // (the rows each side of an output row its stencils read) and the number
+  // of band BUFFERS it keeps. Point-wise expressions give rows on demand
+  // through Row(y); stencils write rows first .. last - 1 through
+  // Run(out, store, first, last), passing each value through store.
+
+  // Leaf: the pixels of an image, which must outlive the expression
+  struct InputExpression {
+    static constexpr bool POINTWISE = true;
+    static constexpr int HALO = 0;
+    static constexpr int BUFFERS = 0;
+    const Image &image;
+
+    int Width() const { return image.width; }
+    int Height() const { return image.height; }
+    const int *Row(int y) const { return image.pixels[y].data(); }
+  };
+
+  // A row of a point-wise expression, computed on access
+  template <typename Row, typename Op> struct MappedRow {
+    Row row;
+    Op op;
+    int operator[](int x) const { return op(row[x]); }
+  };
+
+  // op applied to every value of source
+  template <typename Expression, typename Op> struct MapExpression {
+    static constexpr bool POINTWISE = Expression::POINTWISE;
+    static constexpr int HALO = Expression::HALO;
+    static constexpr int BUFFERS = Expression::BUFFERS;
+    Expression source;
+    Op op;
+
+    int Width() const { return source.Width(); }
+    int Height() const { return source.Height(); }
+    auto Row(int y) const
+      requires POINTWISE
+    {
+      return MappedRow<decltype(source.Row(y)), Op>{source.Row(y), op};
+    }
+    // Over a stencil: fold op into what the stencil stores
+    template <typename Out, typename Store>
+    void Run(Out &out, Store store, int first, int last) const
+      requires(!POINTWISE)
+    {
+      // By value: the vectorizer loses track of captured references
+      source.Run(
+          out, [store, op = op](int value) { return store(op(value)); },
+          first, last);
+    }
+  };
+
+  // Separable Gaussian blur, as Kernels::GaussianBlur
+  template <double Sigma, typename Expression> struct BlurExpression {
+    static constexpr bool POINTWISE = false;
+    static constexpr int REACH = Kernels::GaussianSize(Sigma) / 2;
+    static constexpr int HALO = REACH + Expression::HALO;
+    // The row pass, and the source when it is materialized
+    static constexpr int BUFFERS =
+        1 + (Expression::POINTWISE ? 0 : 1 + Expression::BUFFERS);
+    Expression source;
+
+    int Width() const { return source.Width(); }
+    int Height() const { return source.Height(); }
+    template <typename Out, typename Store>
+    void Run(Out &out, Store store, int first, int last) const {
+      TRACE_SPAN("ApplyGaussianBlur", "kernel");
+      WithPointwise(source, REACH, first, last, [&](const auto &input) {
+        if constexpr (Sigma <= 0.1) {
+          // Too narrow to change anything
+          Copy(input, out, store, first, last);
+        } else {
+          Blur<Sigma>(input, out, store, first, last);
+        }
+      });
+    }
+  };
+
+  // Window of Size x Size around each pixel reduced by Window. Pixels where
+  // the window does not fit pass their value through, or 0 for windows
+  // with a ZERO_BORDER.
+  template <int Size, typename Window, typename Expression>
+  struct WindowExpression {
+    static constexpr bool POINTWISE = false;
+    static constexpr int HALO = Size / 2 + Expression::HALO;
+    static constexpr int BUFFERS =
+        Expression::POINTWISE ? 0 : 1 + Expression::BUFFERS;
+    Expression source;
+    Window window;
+
+    int Width() const { return source.Width(); }
+    int Height() const { return source.Height(); }
+    template <typename Out, typename Store>
+    void Run(Out &out, Store store, int first, int last) const {
+      WithPointwise(source, Size / 2, first, last, [&](const auto &input) {
+        RunWindow<Size>(input, out, store, window, first, last);
+      });
+    }
+  };
+
+  template <int Size, bool Maximum> struct ExtremumWindow {
+    static constexpr bool ZERO_BORDER = false;
+    template <typename Row>
+    int operator()(const std::array<Row, Size> &rows, int x) const {
+      return Kernels::WindowExtremum<Size, Maximum>(rows, x);
+    }
+  };
+
+  template <int Size> struct MedianWindow {
+    static constexpr bool ZERO_BORDER = false;
+    template <typename Row>
+    int operator()(const std::array<Row, Size> &rows, int x) const {
+      return Kernels::WindowMedian<Size>(rows, x);
+    }
+  };
+
+  template <int Size> struct RangeMeanWindow {
+    static constexpr bool ZERO_BORDER = false;
+    int range;
+    template <typename Row>
+    int operator()(const std::array<Row, Size> &rows, int x) const {
+      return Kernels::WindowRangeMean<Size>(rows, x, range);
+    }
+  };
+
+  // Sobel gradient magnitude, saturated at 255
+  struct SobelWindow {
+    static constexpr bool ZERO_BORDER = true;
+    template <typename Row>
+    int operator()(const std::array<Row, 3> &r, int x) const {
+      const int gx = -r[0][x - 1] + r[0][x + 1] - 2 * r[1][x - 1] +
+                     2 * r[1][x + 1] - r[2][x - 1] + r[2][x + 1];
+      const int gy = -r[0][x - 1] - 2 * r[0][x] - r[0][x + 1] +
+                     r[2][x - 1] + 2 * r[2][x] + r[2][x + 1];
+      return std::min(255, static_cast<int>(std::sqrt(gx * gx + gy * gy)));
+    }
+  };
+
+  static InputExpression Input(const Image &image) { return {image}; }
+
+  template <typename Expression, typename Op>
+  static MapExpression<Expression, Op> Map(Expression source, Op op) {
+    return {source, op};
+  }
+  // 255 above threshold, 0 otherwise
+  template <typename Expression>
+  static auto Threshold(Expression source, int threshold) {
+    return Map(source, [threshold](int value) {
+      return value > threshold ? 255 : 0;
+    });
+  }
+
+  template <double Sigma, typename Expression>
+  static BlurExpression<Sigma, Expression> GaussianBlur(Expression source) {
+    return {source};
+  }
+  template <int Size, typename Expression>
+    requires UnrolledKernelSize<Size>
+  static auto Dilate(Expression source) {
+    return WindowExpression<Size, ExtremumWindow<Size, true>, Expression>{
+        source, {}};
+  }
+  template <int Size, typename Expression>
+    requires UnrolledKernelSize<Size>
+  static auto Erode(Expression source) {
+    return WindowExpression<Size, ExtremumWindow<Size, false>, Expression>{
+        source, {}};
+  }
+  template <int Size, typename Expression>
+    requires UnrolledKernelSize<Size>
+  static auto Median(Expression source) {
+    return WindowExpression<Size, MedianWindow<Size>, Expression>{source, {}};
+  }
+  template <int Size, typename Expression>
+    requires UnrolledKernelSize<Size>
+  static auto RangeMean(Expression source, int range) {
+    return WindowExpression<Size, RangeMeanWindow<Size>, Expression>{
+        source, {range}};
+  }
+  template <typename Expression> static auto Sobel(Expression source) {
+    return WindowExpression<3, SobelWindow, Expression>{source, {}};
+  }
+
+  // Rows per band of expression over a frame width pixels wide: as many as
+  // keep the band's buffers, its input and its output within BAND_BYTES
+  template <typename Expression> static int BandRows(int width) {
+    const size_t rowBytes =
+        sizeof(int) * std::max(width, 1) * (Expression::BUFFERS + 2);
+    return std::max({MIN_BAND_ROWS, 4 * Expression::HALO,
+                     static_cast<int>(BAND_BYTES / rowBytes)});
+  }
+
+  // Writes every pixel of output, which must be sized like the expression
+  // and must not be one of its inputs, in bands of bandRows rows
+  template <typename Expression>
+  static void Evaluate(const Expression &expression, Image &output,
+                       int bandRows) {
+    const int height = expression.Height();
+    const int bands = (height + bandRows - 1) / bandRows;
+    ImageRows target{output};
+
+#pragma omp parallel for schedule(dynamic)
+    for (int band = 0; band < bands; ++band) {
+      const int first = band * bandRows;
+      const int last = std::min(height, first + bandRows);
+      if constexpr (Expression::POINTWISE)
+        Copy(expression, target, Identity(), first, last);
+      else
+        expression.Run(target, Identity(), first, last);
+    }
+  }
+  template <typename Expression>
+  static void Evaluate(const Expression &expression, Image &output) {
+    Evaluate(expression, output, BandRows<Expression>(expression.Width()));
+  }
+  template <typename Expression>
+  static Image Evaluate(const Expression &expression) {
+    Image output(expression.Width(), expression.Height());
+    Evaluate(expression, output);
+    return output;
+  }
+
+private:
+  struct Identity {
+    int operator()(int value) const { return value; }
+  };
+
+  // Rows of an image being written
+  struct ImageRows {
+    Image &image;
+    int *Row(int y) { return image.pixels[y].data(); }
+  };
+
+  // Point-wise view of a band of a materialized stencil, with the
+  // dimensions of the whole image
+  struct BandExpression {
+    static constexpr bool POINTWISE = true;
+    static constexpr int HALO = 0;
+    static constexpr int BUFFERS = 0;
+    const Band &band;
+    int width;
+    int height;
+
+    int Width() const { return width; }
+    int Height() const { return height; }
+    const int *Row(int y) const { return band.Row(y); }
+  };
+
+  // Calls kernel with a point-wise view of source over rows first - reach
+  // .. last + reach - 1, computing those rows of source into a band first
+  // when it ends in a stencil
+  template <typename Expression, typename Kernel>
+  static void WithPointwise(const Expression &source, int reach, int first,
+                            int last, Kernel &&kernel) {
+    if constexpr (Expression::POINTWISE) {
+      kernel(source);
+    } else {
+      const int low = std::max(0, first - reach);
+      const int high = std::min(source.Height(), last + reach);
+      Band band(source.Width(), low, high);
+      source.Run(band, Identity(), low, high);
+      kernel(BandExpression{band, source.Width(), source.Height()});
+    }
+  }
+
+  // Window of Size rows of a point-wise expression for a pass walking down
+  // the image. Stored rows are used in place; computed rows are evaluated
+  // once each into a ring of Size lines, so a point-wise step below a
+  // stencil costs one pass per row however tall the window is.
+  template <int Size, typename Pointwise> class LineBuffer {
+  public:
+    static constexpr bool IN_PLACE =
+        std::is_pointer_v<decltype(std::declval<Pointwise>().Row(0))>;
+
+    explicit LineBuffer(const Pointwise &input)
+        : input_(input),
+          lines_(IN_PLACE ? 0 : static_cast<size_t>(Size) * input.Width()) {}
+
+    // Rows first .. first + Size - 1
+    std::array<const int *, Size> Window(int first) {
+      std::array<const int *, Size> rows;
+      if constexpr (IN_PLACE) {
+        for (int k = 0; k < Size; ++k)
+          rows[k] = input_.Row(first + k);
+      } else {
+        // Lines filled for the previous window are reused when they overlap
+        int next = first;
+        if (filled_ > first && filled_ <= first + Size)
+          next = filled_;
+        for (; next < first + Size; ++next)
+          Fill(next);
+        filled_ = first + Size;
+        for (int k = 0; k < Size; ++k)
+          rows[k] = Line(first + k);
+      }
+      return rows;
+    }
+
+  private:
+    int *Line(int y) {
+      return lines_.Data() + static_cast<size_t>(y % Size) * input_.Width();
+    }
+    void Fill(int y) {
+      const auto row = input_.Row(y);
+      int *line = Line(y);
+      const int width = input_.Width();
+#pragma omp simd
+      for (int x = 0; x < width; ++x)
+        line[x] = row[x];
+    }
+
+    const Pointwise &input_;
+    Scratch lines_;
+    int filled_ = -1;
+  };
+
+  template <typename Pointwise, typename Out, typename Store>
+  static void Copy(const Pointwise &input, Out &out, Store store, int first,
+                   int last) {
+    const int width = input.Width();
+    for (int y = first; y < last; ++y) {
+      const auto row = input.Row(y);
+      int *target = out.Row(y);
+#pragma omp simd
+      for (int x = 0; x < width; ++x)
+        target[x] = store(row[x]);
+    }
+  }
+
+  template <int Size, typename Pointwise, typename Out, typename Store,
+            typename Window>
+  static void RunWindow(const Pointwise &input, Out &out, Store store,
+                        const Window &window, int first, int last) {
+    constexpr int half = Size / 2;
+    const int width = input.Width();
+    const int height = input.Height();
+    auto border = [&](int value) {
+      return store(Window::ZERO_BORDER ? 0 : value);
+    };
+    LineBuffer<Size, Pointwise> lines(input);
+
+    for (int y = first; y < last; ++y) {
+      int *target = out.Row(y);
+      if (y < half || y >= height - half) {
+        const auto row = input.Row(y);
+        for (int x = 0; x < width; ++x)
+          target[x] = border(row[x]);
+        continue;
+      }
+
+      const auto rows = lines.Window(y - half);
+      const int *row = rows[half];
+      for (int x = 0; x < std::min(half, width); ++x)
+        target[x] = border(row[x]);
+#pragma omp simd
+      for (int x = half; x < width - half; ++x)
+        target[x] = store(window(rows, x));
+      for (int x = std::max(half, width - half); x < width; ++x)
+        target[x] = border(row[x]);
+    }
+  }
+
+  template <double Sigma, typename Pointwise, typename Out, typename Store>
+  static void Blur(const Pointwise &input, Out &out, Store store, int first,
+                   int last) {
+    constexpr int size = Kernels::GaussianSize(Sigma);
+    if constexpr (UnrolledKernelSize<size>) {
+      // Unrolled taps over compile-time weights
+      static constexpr std::array<double, size> weights =
+          Kernels::GaussianWeights<size>(Sigma);
+      BlurPasses<size>(input, out, store, first, last, [](auto &&tap) {
+        double value = 0.0;
+        Kernels::Unroll<size>([&](auto k) { value += tap(k) * weights[k]; });
+        return Kernels::RoundPixel(value);
+      });
+    } else {
+      // Built once, at the first band, like the runtime kernel's weights
+      static const std::vector<double> weights =
+          Kernels::GaussianWeights(Sigma);
+      BlurPasses<size>(input, out, store, first, last, [](auto &&tap) {
+        double value = 0.0;
+        for (int k = 0; k < size; ++k)
+          value += tap(k) * weights[k];
+        return Kernels::RoundPixel(value);
+      });
+    }
+  }
+
+  // Row then column pass of a separable blur; taps(tap) sums tap(k) over
+  // the Size weights and rounds
+  template <int Size, typename Pointwise, typename Out, typename Store,
+            typename Taps>
+  static void BlurPasses(const Pointwise &input, Out &out, Store store,
+                         int first, int last, Taps taps) {
+    constexpr int half = Size / 2;
+    const int width = input.Width();
+    const int height = input.Height();
+    auto clamp = [](int index, int extent) {
+      return std::max(0, std::min(index, extent - 1));
+    };
+
+    // Row pass over the rows the column pass reaches
+    const int low = std::max(0, first - half);
+    const int high = std::min(height, last + half);
+    Band rowPass(width, low, high);
+    LineBuffer<1, Pointwise> lines(input);
+    for (int y = low; y < high; ++y) {
+      const int *row = lines.Window(y)[0];
+      int *target = rowPass.Row(y);
+      auto clamped = [&](int x) {
+        return taps([&](int k) { return row[clamp(x + k - half, width)]; });
+      };
+      for (int x = 0; x < std::min(half, width); ++x)
+        target[x] = clamped(x);
+#pragma omp simd
+      for (int x = half; x < width - half; ++x)
+        target[x] = taps([&](int k) { return row[x + k - half]; });
+      for (int x = std::max(half, width - half); x < width; ++x)
+        target[x] = clamped(x);
+    }
+
+    for (int y = first; y < last; ++y) {
+      std::array<const int *, Size> rows;
+      for (int k = 0; k < Size; ++k)
+        rows[k] = rowPass.Row(clamp(y + k - half, height));
+      int *target = out.Row(y);
+#pragma omp simd
+      for (int x = 0; x < width; ++x)
+        target[x] = store(taps([&](int k) { return rows[k][x]; }));
+    }
+  }
+};
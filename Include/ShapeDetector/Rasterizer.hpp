@@ -0,0 +1,52 @@
+#pragma once
+
+#include "RectangleDetector.hpp"
+#include <utility>
+#include <vector>
+
+// Horizontal run of covered pixels on row y, inclusive of both ends
+struct Span {
+  int y, x1, x2;
+};
+
+// Scanline rasterizer turning filled shapes into per-row spans. Pixels are
+// sampled at integer coordinates and every span is clipped to
+// [0, width) x [0, height), so callers can fill each one with a single row
+// write.
+class Rasterizer {
+public:
+  // Convex polygon with vertices in order (either winding)
+  static void ConvexPolygon(const std::pair<double, double> *vertices,
+                            int count, int width, int height,
+                            std::vector<Span> &spans);
+  // Line of the given thickness as a single quad with square end caps
+  static void ThickLine(const Point &p1, const Point &p2, int thickness,
+                        int width, int height, std::vector<Span> &spans);
+  // Pixels with x^2 + y^2 <= radius^2 around the centre
+  static void FilledCircle(int centerX, int centerY, int radius, int width,
+                           int height, std::vector<Span> &spans);
+  // Pixels with innerRadius < distance <= outerRadius; up to two spans per row
+  static void Annulus(int centerX, int centerY, double innerRadius,
+                      double outerRadius, int width, int height,
+                      std::vector<Span> &spans);
+  // Ellipse rotated by angle radians, solved analytically per row
+  static void FilledEllipse(int centerX, int centerY, double radiusX,
+                            double radiusY, double angle, int width,
+                            int height, std::vector<Span> &spans);
+  // Band of the given thickness centred on the rotated ellipse boundary
+  static void EllipseRing(int centerX, int centerY, double radiusX,
+                          double radiusY, double angle, double thickness,
+                          int width, int height, std::vector<Span> &spans);
+
+  // Writes value to every pixel the spans cover, one row fill per span
+  static void FillSpans(Image &image, const std::vector<Span> &spans,
+                        int value);
+  // Same for any frame layout with a FillSpan(y, x1, x2, value) member
+  template <typename Canvas, typename Value>
+  static void FillSpans(Canvas &canvas, const std::vector<Span> &spans,
+                        const Value &value) {
+    for (const Span &span : spans) {
+      canvas.FillSpan(span.y, span.x1, span.x2, value);
+    }
+  }
+};
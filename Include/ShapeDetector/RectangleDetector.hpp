@@ -1,7 +1,9 @@
 #pragma once
 
+#include "DetectionStats.hpp"
 #include <array>
 #include <bitset>
+#include <memory>
 #include <stack>
 #include <vector>
 
@@ -35,6 +37,18 @@ struct Image {
   Image(int w, int h) : width(w), height(h) {
     pixels.resize(h, std::vector<int>(w, 0));
   }
+
+  // Reshapes to w x h; the pixels are left as they are when the size does
+  // not change, so an image reused for frames of one size never reallocates
+  void Resize(int w, int h) {
+    if (w != width || h != height)
+      *this = Image(w, h);
+  }
+};
+
+// Axis-aligned window of an image, in full-frame pixel coordinates
+struct RegionOfInterest {
+  int x, y, width, height;
 };
 
 // Optimized data structure for scanline flood fill
@@ -45,91 +59,173 @@ struct ScanlineSegment {
       : y(y), x1(x1), x2(x2), parentY(parentY) {}
 };
 
+class ContourSet;
+struct ContourView;
+struct ContourFeatures;
+
+// Preprocessing strategies of RectangleDetector, in their default order
+enum class RectangleStrategy {
+  Standard,
+  Enhanced,
+  Morphological,
+  MultiThreshold,
+  Aggressive,
+  Count
+};
+
 class RectangleDetector {
 public:
   RectangleDetector();
   ~RectangleDetector();
 
   std::vector<Rectangle> DetectRectangles(const Image &image);
+  // Same, into rectangles, whose capacity is reused from call to call
+  void DetectRectangles(const Image &image, std::vector<Rectangle> &rectangles);
+  // Same, adding timings and counters of this call to stats
+  std::vector<Rectangle> DetectRectangles(const Image &image,
+                                          DetectionStats &stats);
+  // Detect only inside the given regions; results are in full-frame
+  // coordinates
+  std::vector<Rectangle>
+  DetectRectangles(const Image &image,
+                   const std::vector<RegionOfInterest> &regions);
+  std::vector<Rectangle>
+  DetectRectangles(const Image &image,
+                   const std::vector<RegionOfInterest> &regions,
+                   DetectionStats &stats);
   void SetMinArea(double minArea);
   void SetMaxArea(double maxArea);
   void SetApproxEpsilon(double epsilon);
+  // Strategies to run, in order; all five by default
+  void SetStrategies(const std::vector<RectangleStrategy> &strategies);
+  const std::vector<RectangleStrategy> &Strategies() const {
+    return strategies_;
+  }
+  // Skips or restores one step of the corner approximation chain. The final
+  // Douglas-Peucker fallback cannot be disabled.
+  void SetApproximationBranch(ApproximationBranch branch, bool enabled);
+  bool ApproximationBranchEnabled(ApproximationBranch branch) const;
+  // Order in which the chain tries its optional steps; each stops the chain
+  // when its corners are usable. Steps left out follow in the default
+  // order (moments, Hough, curvature, Douglas-Peucker, convex hull).
+  void SetApproximationOrder(const std::vector<ApproximationBranch> &order);
+  const std::vector<ApproximationBranch> &ApproximationOrder() const {
+    return approximationOrder_;
+  }
+  static const char *StrategyName(RectangleStrategy strategy);
 
 private:
+  // Benchmarks time individual pipeline stages through this
+  friend struct DetectorProbe;
+
   double minArea_;
   double maxArea_;
   double approxEpsilon_;
+  std::vector<RectangleStrategy> strategies_;
+  std::bitset<static_cast<size_t>(ApproximationBranch::Count)> branches_;
+  std::vector<ApproximationBranch> approximationOrder_;
+  mutable DetectionStats *stats_ = nullptr; // set for the duration of a call
+  // Per-frame buffers kept between calls; see RectangleDetector.cpp
+  struct FrameBuffers;
+  std::unique_ptr<FrameBuffers> frame_;
 
   // Cache for expensive calculations
   mutable std::vector<double> distanceCache_;
   mutable std::vector<double> angleCache_;
 
-  std::vector<std::vector<Point>> FindContours(const Image &image) const;
-  bool IsRectangle(const std::vector<Point> &contour) const;
-  Rectangle CreateRectangle(const std::vector<Point> &contour) const;
-  Image PreprocessImage(const Image &image) const;
-  std::vector<Point> ApproximateContour(const std::vector<Point> &contour,
-                                        double epsilon) const;
+  void FindContours(const Image &image, ContourSet &contours) const;
+  // features, when measured on exactly these points, route the contour
+  // through the cascade and spare it recomputing them
+  bool IsRectangle(const ContourView &contour,
+                   const ContourFeatures *features = nullptr) const;
+  Rectangle CreateRectangle(const ContourView &contour,
+                            const ContourFeatures *features = nullptr) const;
+  // The preprocessing steps write every pixel of output, which must be
+  // sized like image
+  void PreprocessImage(const Image &image, Image &output) const;
+  void ApproximateContour(const ContourView &contour, double epsilon,
+                          std::vector<Point> &approx,
+                          ApproximationBranch *branch = nullptr,
+                          const ContourFeatures *features = nullptr) const;
   void ScanlineFillContour(const Image &image, int startX, int startY,
                            std::vector<Point> &contour,
                            std::vector<std::vector<bool>> &visited) const;
+  // Corner polygons come as points, traced contours as coordinate views
   double CalculatePerimeter(const std::vector<Point> &contour) const;
+  double CalculatePerimeter(const ContourView &contour) const;
   double CalculateArea(const std::vector<Point> &contour) const;
-  void DouglasPeuckerRecursive(const std::vector<Point> &contour, int start,
-                               int end, double epsilon,
-                               std::vector<bool> &keep) const;
-  double PointToLineDistanceSquared(const Point &point, const Point &lineStart,
-                                    const Point &lineEnd) const;
-  std::vector<Point> ConvexHull(std::vector<Point> points) const;
+  double CalculateArea(const ContourView &contour) const;
+  void DouglasPeucker(const ContourView &contour, int start, int end,
+                      double epsilon, std::vector<bool> &keep) const;
+  void ConvexHull(const std::vector<Point> &points,
+                  std::vector<Point> &hull) const;
+  void ConvexHull(const ContourView &points, std::vector<Point> &hull) const;
+  // Sorts points, then leaves their convex hull in hull
+  void SortedConvexHull(std::vector<Point> &points,
+                        std::vector<Point> &hull) const;
   double Cross(const Point &O, const Point &A, const Point &B) const;
   bool IsValidQuadrilateral(const std::vector<Point> &quad) const;
-  std::vector<Point> ExtractBoundary(const std::vector<Point> &region,
-                                     const Image &image) const;
-  std::vector<Point> SortBoundaryPointsRadix(std::vector<Point> boundary) const;
-  std::vector<Point> CleanupCorners(const std::vector<Point> &corners) const;
+  // Pushes the boundary pixels of region onto the open contour, in order
+  // around it
+  void ExtractBoundary(const std::vector<Point> &region, const Image &image,
+                       ContourSet &contours) const;
+  void SortBoundaryPointsRadix(std::vector<Point> &boundary) const;
+  void CleanupCorners(const std::vector<Point> &corners,
+                      std::vector<Point> &cleaned) const;
   std::array<Point, 4>
   SelectBestCorners(const std::vector<Point> &corners) const;
   double CalculateCornerAngle(const Point &prev, const Point &current,
                               const Point &next) const;
   double CalculateCornerAngleFast(const Point &prev, const Point &current,
                                   const Point &next) const;
-  Point CalculateContourCentroid(const std::vector<Point> &contour) const;
-  bool IsCircularShape(const std::vector<Point> &contour,
-                       const std::vector<Point> &approx) const;
-  std::vector<Point>
-  FindCornersRotationInvariant(const std::vector<Point> &contour) const;
-  double CalculateCurvature(const std::vector<Point> &contour, size_t index,
+  Point CalculateContourCentroid(const ContourView &contour) const;
+  bool IsCircularShape(const ContourView &contour,
+                       const std::vector<Point> &approx,
+                       const ContourFeatures *features = nullptr) const;
+  void FindCornersRotationInvariant(const ContourView &contour,
+                                    std::vector<Point> &corners) const;
+  double CalculateCurvature(const ContourView &contour, size_t index,
                             int windowSize = 3) const;
-  std::vector<Point>
-  SmoothContourForRotation(const std::vector<Point> &contour) const;
-  std::vector<Point>
-  FindRectangleUsingHoughLines(const std::vector<Point> &contour) const;
-  std::vector<std::pair<Point, Point>>
-  DetectLines(const std::vector<Point> &contour) const;
+  // Replaces the contours of smoothed with the smoothed contour
+  void SmoothContourForRotation(const ContourView &contour,
+                                ContourSet &smoothed) const;
+  void FindRectangleUsingHoughLines(const ContourView &contour,
+                                    std::vector<Point> &corners) const;
+  void DetectLines(const ContourView &contour,
+                   std::vector<std::pair<Point, Point>> &lines) const;
   bool AreLinesPerpendicular(const std::pair<Point, Point> &line1,
                              const std::pair<Point, Point> &line2,
                              double tolerance = 0.2) const;
-  bool IsLikelyCircularContour(const std::vector<Point> &contour) const;
-  bool IsRectangleUsingMoments(const std::vector<Point> &contour) const;
-  std::vector<Point>
-  FindRectangleCornersMomentBased(const std::vector<Point> &contour) const;
-  double CalculateHuMoment(const std::vector<Point> &contour, int p,
-                           int q) const;
-  Point CalculateCentroid(const std::vector<Point> &contour) const;
-  double CalculateOrientation(const std::vector<Point> &contour) const;
-  std::vector<Point> RotateContourToCanonical(const std::vector<Point> &contour,
-                                              double angle) const;
-  Image ApplyGaussianBlur(const Image &image, double sigma) const;
-  void ProcessContoursAtScale(const std::vector<std::vector<Point>> &contours,
+  bool IsLikelyCircularContour(const ContourView &contour) const;
+  bool IsRectangleUsingMoments(const ContourView &contour) const;
+  void FindRectangleCornersMomentBased(const ContourView &contour,
+                                       std::vector<Point> &corners) const;
+  double CalculateHuMoment(const ContourView &contour, int p, int q) const;
+  Point CalculateCentroid(const ContourView &contour) const;
+  double CalculateOrientation(const ContourView &contour) const;
+  void RotateContourToCanonical(const ContourView &contour, double angle,
+                                std::vector<Point> &rotated) const;
+  void Detect(const Image &image, DetectionStats *stats,
+              std::vector<Rectangle> &rectangles);
+  std::vector<Rectangle>
+  DetectInRegions(const Image &image,
+                  const std::vector<RegionOfInterest> &regions,
+                  DetectionStats *stats);
+  void Preprocess(RectangleStrategy strategy, const Image &image,
+                  Image &output) const;
+  void RunStrategy(RectangleStrategy strategy, const Image &image,
+                   std::vector<Rectangle> &rectangles);
+  bool Reject(RejectReason reason) const;
+  ContourView LoadContour(const ContourSet &contours, size_t index,
+                          ContourFeatures &features) const;
+  void ProcessContoursAtScale(const ContourSet &contours,
                               std::vector<Rectangle> &rectangles, double scale,
                               const Image &scaledImage);
   void RemoveDuplicateRectangles(std::vector<Rectangle> &rectangles) const;
-  Image PreprocessImageEnhanced(const Image &image) const;
-  Image PreprocessImageMorphological(const Image &image) const;
-  Image PreprocessImageMultiThreshold(const Image &image) const;
-  Image PreprocessImageAggressive(const Image &image) const;
+  void PreprocessImageEnhanced(const Image &image, Image &output) const;
+  void PreprocessImageMorphological(const Image &image, Image &output) const;
+  void PreprocessImageMultiThreshold(const Image &image, Image &output) const;
+  void PreprocessImageAggressive(const Image &image, Image &output) const;
   std::vector<Rectangle>
   DetectRectanglesUsingHoughLines(const Image &image) const;
-  Image ApplyMorphologyClose(const Image &image, int kernelSize) const;
-  Image ApplyMorphologyOpen(const Image &image, int kernelSize) const;
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "RectangleDetector.hpp"
+#include <memory>
 #include <vector>
 #include <cmath>
 
@@ -16,42 +17,67 @@ public:
   ~ObloidDetector();
 
   std::vector<Obloid> DetectObloids(const Image &image);
+  // Same, into obloids, whose capacity is reused from call to call
+  void DetectObloids(const Image &image, std::vector<Obloid> &obloids);
+  // Same, adding timings and counters of this call to stats
+  std::vector<Obloid> DetectObloids(const Image &image, DetectionStats &stats);
+  std::vector<Obloid>
+  DetectObloids(const Image &image,
+                const std::vector<RegionOfInterest> &regions);
+  std::vector<Obloid>
+  DetectObloids(const Image &image,
+                const std::vector<RegionOfInterest> &regions,
+                DetectionStats &stats);
   void SetMinRadius(int minRadius);
   void SetMaxRadius(int maxRadius);
   void SetCircularityThreshold(double threshold);
   void SetConfidenceThreshold(double threshold);
 
 private:
+  friend struct DetectorProbe;
+
   int minRadius_;
   int maxRadius_;
   double circularityThreshold_;
   double confidenceThreshold_;
+  mutable DetectionStats *stats_ = nullptr; // set for the duration of a call
+  // Per-frame buffers kept between calls; see SphereDetector.cpp
+  struct FrameBuffers;
+  std::unique_ptr<FrameBuffers> frame_;
 
   // Cache for expensive calculations
   mutable std::vector<double> distanceCache_;
   mutable std::vector<double> radiusCache_;
 
-  std::vector<std::vector<Point>> FindContours(const Image &image) const;
-  bool IsObloid(const std::vector<Point> &contour, Obloid &obloid) const;
-  Obloid CreateObloid(const std::vector<Point> &contour) const;
-  Image PreprocessImage(const Image &image) const;
-  double CalculateCircularity(const std::vector<Point> &contour) const;
-  double CalculatePerimeter(const std::vector<Point> &contour) const;
-  double CalculateArea(const std::vector<Point> &contour) const;
-  Point CalculateCentroid(const std::vector<Point> &contour) const;
-  int EstimateRadius(const std::vector<Point> &contour, const Point &center) const;
-  double CalculateRadialVariance(const std::vector<Point> &contour, const Point &center, int radius) const;
-  bool IsCircularContour(const std::vector<Point> &contour) const;
+  void Detect(const Image &image, DetectionStats *stats,
+              std::vector<Obloid> &obloids);
+  std::vector<Obloid>
+  DetectInRegions(const Image &image,
+                  const std::vector<RegionOfInterest> &regions,
+                  DetectionStats *stats);
+  void FindContours(const Image &image, ContourSet &contours) const;
+  bool Reject(RejectReason reason) const;
+  bool IsObloid(const ContourView &contour, Obloid &obloid) const;
+  Obloid CreateObloid(const ContourView &contour) const;
+  // Writes every pixel of output, which must be sized like image
+  void PreprocessImage(const Image &image, Image &output) const;
+  double CalculateCircularity(const ContourView &contour) const;
+  double CalculatePerimeter(const ContourView &contour) const;
+  double CalculateArea(const ContourView &contour) const;
+  Point CalculateCentroid(const ContourView &contour) const;
+  int EstimateRadius(const ContourView &contour, const Point &center) const;
+  double CalculateRadialVariance(const ContourView &contour, const Point &center, int radius) const;
+  bool IsCircularContour(const ContourView &contour) const;
   void ScanlineFillContour(const Image &image, int startX, int startY,
                            std::vector<Point> &contour,
                            std::vector<std::vector<bool>> &visited) const;
-  std::vector<Point> ExtractBoundary(const std::vector<Point> &region,
-                                     const Image &image) const;
+  // Pushes the boundary pixels of region onto the open contour
+  void ExtractBoundary(const std::vector<Point> &region, const Image &image,
+                       ContourSet &contours) const;
   void RemoveDuplicateObloids(std::vector<Obloid> &obloids) const;
-  Image ApplyGaussianBlur(const Image &image, double sigma) const;
-  bool ValidateCircleGeometry(const std::vector<Point> &contour, const Point &center, int radius) const;
-  double CalculateCircleFitError(const std::vector<Point> &contour, const Point &center, int radius) const;
-  Obloid FitCircleToContour(const std::vector<Point> &contour) const;
+  bool ValidateCircleGeometry(const ContourView &contour, const Point &center, int radius) const;
+  double CalculateCircleFitError(const ContourView &contour, const Point &center, int radius) const;
+  Obloid FitCircleToContour(const ContourView &contour) const;
 };
 
 class SphereDetector {
@@ -60,21 +86,44 @@ public:
   ~SphereDetector();
 
   std::vector<Sphere> DetectSpheres(const Image &image);
+  // Same, into spheres, whose capacity is reused from call to call
+  void DetectSpheres(const Image &image, std::vector<Sphere> &spheres);
+  // Same, adding timings and counters of this call to stats
+  std::vector<Sphere> DetectSpheres(const Image &image, DetectionStats &stats);
+  // Detect only inside the given regions; results are in full-frame
+  // coordinates
+  std::vector<Sphere>
+  DetectSpheres(const Image &image,
+                const std::vector<RegionOfInterest> &regions);
+  std::vector<Sphere>
+  DetectSpheres(const Image &image,
+                const std::vector<RegionOfInterest> &regions,
+                DetectionStats &stats);
   void SetMinRadius(int minRadius);
   void SetMaxRadius(int maxRadius);
   void SetCircularityThreshold(double threshold);
   void SetConfidenceThreshold(double threshold);
 
 private:
+  friend struct DetectorProbe;
+
   int minRadius_;
   int maxRadius_;
   double circularityThreshold_;
   double confidenceThreshold_;
 
+  // Runs the detection; kept with its buffers across calls
+  ObloidDetector obloidDetector_;
+  std::vector<Obloid> obloids_;
+
   // Cache for expensive calculations
   mutable std::vector<double> distanceCache_;
   mutable std::vector<double> radiusCache_;
 
+  ObloidDetector &ConfiguredObloidDetector();
+  static void ToSpheres(const std::vector<Obloid> &obloids,
+                        std::vector<Sphere> &spheres);
+  static std::vector<Sphere> ToSpheres(const std::vector<Obloid> &obloids);
   std::vector<std::vector<Point>> FindContours(const Image &image) const;
   bool IsSphere(const std::vector<Point> &contour, Sphere &sphere) const;
   Sphere CreateSphere(const std::vector<Point> &contour) const;
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Build with -DSHAPE_DETECTOR_TRACE=0 to remove every span from the
+// detectors; Trace itself stays available and simply records nothing
+#ifndef SHAPE_DETECTOR_TRACE
+#define SHAPE_DETECTOR_TRACE 1
+#endif
+
+struct TraceEvent {
+  const char *name;     // must outlive the trace, normally a literal
+  const char *category; // detect, strategy, kernel, contours, classify, nms
+  int64_t startNs;      // relative to Trace::Start()
+  int64_t durationNs;
+  int thread; // small index in order of each thread's first span
+};
+
+// Process-wide recorder of timed spans. Every thread appends to its own
+// buffer, so recording takes no lock and never contends with other
+// threads; only a thread's first span registers its buffer. Read events
+// after Stop() once the traced calls have returned.
+class Trace {
+public:
+  // Discards earlier events and starts recording
+  static void Start();
+  static void Stop();
+  static bool Enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  static int64_t Now();
+  static void Record(const char *name, const char *category, int64_t start,
+                     int64_t end);
+
+  // Events of all threads ordered by start time
+  static std::vector<TraceEvent> Events();
+  // Chrome trace-event JSON, loadable in chrome://tracing and Perfetto
+  static void WriteChromeJson(std::ostream &out);
+  static bool WriteChromeJson(const std::string &path);
+
+private:
+  static std::atomic<bool> enabled_;
+};
+
+// Records the enclosing scope as one complete event while tracing is on;
+// otherwise costs a single relaxed load
+class TraceSpan {
+public:
+  TraceSpan(const char *name, const char *category)
+      : name_(name), category_(category),
+        start_(Trace::Enabled() ? Trace::Now() : -1) {}
+  ~TraceSpan() {
+    if (start_ >= 0)
+      Trace::Record(name_, category_, start_, Trace::Now());
+  }
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+  const char *name_;
+  const char *category_;
+  int64_t start_;
+};
+
+#if SHAPE_DETECTOR_TRACE
+#define TRACE_SPAN_CONCAT_(a, b) a##b
+#define TRACE_SPAN_CONCAT(a, b) TRACE_SPAN_CONCAT_(a, b)
+#define TRACE_SPAN(name, category)                                             \
+  TraceSpan TRACE_SPAN_CONCAT(traceSpan, __LINE__)(name, category)
+#else
+#define TRACE_SPAN(name, category)                                             \
+  do {                                                                         \
+  } while (0)
+#endif
@@ -0,0 +1,179 @@
+#include "ShapeDetector/AllocationTracker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Threads past this count share the last slot
+constexpr int MAX_TRACKED_THREADS = 256;
+
+namespace {
+
+struct alignas(64) ThreadSlot {
+  std::atomic<uint64_t> allocations{0};
+  std::atomic<uint64_t> frees{0};
+  std::atomic<uint64_t> bytes{0};
+};
+
+// Plain arrays and trivially initialized thread_locals only: anything that
+// allocates here would recurse into operator new
+ThreadSlot slots[MAX_TRACKED_THREADS];
+std::atomic<int> nextSlot{0};
+// Bit 0 is set by Enable; every live AllocationScope adds SCOPE. Counting
+// is on while any of them is, so scopes on concurrent detectors nest
+// instead of switching each other off.
+constexpr int SCOPE = 2;
+std::atomic<int> counting{0};
+thread_local int slotIndex = -1;
+
+ThreadSlot &LocalSlot() {
+  if (slotIndex < 0) {
+    slotIndex = nextSlot.fetch_add(1, std::memory_order_relaxed);
+    if (slotIndex >= MAX_TRACKED_THREADS)
+      slotIndex = MAX_TRACKED_THREADS - 1;
+  }
+  return slots[slotIndex];
+}
+
+AllocationCounts Read(const ThreadSlot &slot) {
+  return {slot.allocations.load(std::memory_order_relaxed),
+          slot.frees.load(std::memory_order_relaxed),
+          slot.bytes.load(std::memory_order_relaxed)};
+}
+
+} // namespace
+
+bool AllocationTracker::Available() { return SHAPE_DETECTOR_ALLOC_HOOKS != 0; }
+
+void AllocationTracker::Enable() {
+  counting.fetch_or(1, std::memory_order_relaxed);
+}
+
+void AllocationTracker::Disable() {
+  counting.fetch_and(~1, std::memory_order_relaxed);
+}
+
+bool AllocationTracker::Enabled() {
+  return counting.load(std::memory_order_relaxed) != 0;
+}
+
+AllocationCounts AllocationTracker::Total() {
+  AllocationCounts total;
+  const int used = std::min(nextSlot.load(std::memory_order_relaxed),
+                            MAX_TRACKED_THREADS);
+  for (int i = 0; i < used; ++i) {
+    const AllocationCounts counts = Read(slots[i]);
+    total.allocations += counts.allocations;
+    total.frees += counts.frees;
+    total.bytes += counts.bytes;
+  }
+  return total;
+}
+
+AllocationCounts AllocationTracker::ThisThread() { return Read(LocalSlot()); }
+
+AllocationScope::AllocationScope() : start_(AllocationTracker::Total()) {
+  counting.fetch_add(SCOPE, std::memory_order_relaxed);
+}
+
+AllocationScope::~AllocationScope() {
+  counting.fetch_sub(SCOPE, std::memory_order_relaxed);
+}
+
+AllocationCounts AllocationScope::Counts() const {
+  return AllocationTracker::Total() - start_;
+}
+
+#if SHAPE_DETECTOR_ALLOC_HOOKS
+
+namespace {
+
+// Relaxed add on a line no other thread writes, except the overflow slot
+void Add(std::atomic<uint64_t> &counter, uint64_t value) {
+  counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+void *Allocate(std::size_t size) {
+  if (counting.load(std::memory_order_relaxed)) {
+    ThreadSlot &slot = LocalSlot();
+    Add(slot.allocations, 1);
+    Add(slot.bytes, size);
+  }
+  return std::malloc(size ? size : 1);
+}
+
+void *AllocateAligned(std::size_t size, std::align_val_t alignment) {
+  if (counting.load(std::memory_order_relaxed)) {
+    ThreadSlot &slot = LocalSlot();
+    Add(slot.allocations, 1);
+    Add(slot.bytes, size);
+  }
+  const std::size_t align = static_cast<std::size_t>(alignment);
+  // aligned_alloc wants a size that is a multiple of the alignment
+  const std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) /
+                              align * align;
+  return std::aligned_alloc(align, rounded);
+}
+
+void Release(void *pointer) {
+  if (!pointer)
+    return;
+  if (counting.load(std::memory_order_relaxed))
+    Add(LocalSlot().frees, 1);
+  std::free(pointer);
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+  if (void *pointer = Allocate(size))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+  if (void *pointer = Allocate(size))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return Allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return Allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  if (void *pointer = AllocateAligned(size, alignment))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  if (void *pointer = AllocateAligned(size, alignment))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { Release(pointer); }
+void operator delete[](void *pointer) noexcept { Release(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { Release(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept {
+  Release(pointer);
+}
+void operator delete(void *pointer, std::align_val_t) noexcept {
+  Release(pointer);
+}
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+  Release(pointer);
+}
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept {
+  Release(pointer);
+}
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept {
+  Release(pointer);
+}
+
+#endif
@@ -0,0 +1,356 @@
+#include "ShapeDetector/ContourGeometry.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+double ContourFeatures::Circularity() const {
+  if (area <= 0.0)
+    return 0.0;
+  return perimeter * perimeter / (4.0 * std::numbers::pi * area);
+}
+
+namespace {
+
+// Type Exact sums accumulate in: integers accumulate unsigned, so overflow
+// wraps instead of being undefined
+template <typename Exact> struct Accumulator {
+  using Type = Exact;
+};
+template <> struct Accumulator<int32_t> {
+  using Type = uint32_t;
+};
+
+// Orders residuals by distance from the chord: the square, or for fixed
+// point the magnitude, which orders the same and cannot overflow
+template <GeometryPrecision Precision, typename Exact>
+Exact ResidualKey(Exact residual) {
+  if constexpr (Precision == GeometryPrecision::Fixed)
+    return residual < 0 ? -residual : residual;
+  else
+    return residual * residual;
+}
+
+// Folds per-lane maxima into the running one, keeping the first index on
+// ties as a sequential sweep would
+template <typename Key, typename Best, typename Index, int Lanes>
+void MergeLanes(const Key (&keys)[Lanes], const Index (&indices)[Lanes],
+                Best &best, size_t &bestIndex) {
+  for (int lane = 0; lane < Lanes; ++lane) {
+    const Best key = static_cast<Best>(keys[lane]);
+    const size_t index = static_cast<size_t>(indices[lane]);
+    if (key > best || (key == best && key > 0 && index < bestIndex)) {
+      best = key;
+      bestIndex = index;
+    }
+  }
+}
+
+#if defined(__AVX2__)
+// Whether a coordinate is inside the range where fixed-point residuals
+// fit in 32 bits
+bool WithinFixedLimit(ContourSet::Coordinate value) {
+  return value >= -FIXED_COORDINATE_LIMIT && value <= FIXED_COORDINATE_LIMIT;
+}
+
+// Vector part of FarthestFromChord: four double or eight 32-bit lanes per
+// step, each keeping its first maximum. Advances i past the points covered.
+// Returns false without touching best when a fixed-point sweep met a point
+// outside FIXED_COORDINATE_LIMIT, whose residual may have wrapped.
+template <GeometryPrecision Precision, typename Exact>
+bool FarthestFromChordAvx2(const ContourSet::Coordinate *xs,
+                           const ContourSet::Coordinate *ys, size_t &i,
+                           size_t last, Exact a, Exact b, Exact c,
+                           Exact &best, size_t &bestIndex) {
+  auto load = [](const ContourSet::Coordinate *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  };
+  auto load8 = [](const ContourSet::Coordinate *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  };
+
+  if constexpr (Precision == GeometryPrecision::Double) {
+    const __m256d va = _mm256_set1_pd(a);
+    const __m256d vb = _mm256_set1_pd(b);
+    const __m256d vc = _mm256_set1_pd(c);
+    const __m256d step = _mm256_set1_pd(4.0);
+    __m256d lanes = _mm256_setzero_pd();
+    __m256d lanesIndex = _mm256_set1_pd(static_cast<double>(bestIndex));
+    __m256d index = _mm256_setr_pd(i, i + 1.0, i + 2.0, i + 3.0);
+
+    for (; i + 4 <= last; i += 4) {
+      const __m256d x = _mm256_cvtepi32_pd(load(xs + i));
+      const __m256d y = _mm256_cvtepi32_pd(load(ys + i));
+      const __m256d residual = _mm256_add_pd(
+          _mm256_add_pd(_mm256_mul_pd(va, x), _mm256_mul_pd(vb, y)), vc);
+      const __m256d key = _mm256_mul_pd(residual, residual);
+      const __m256d greater = _mm256_cmp_pd(key, lanes, _CMP_GT_OQ);
+      lanes = _mm256_blendv_pd(lanes, key, greater);
+      lanesIndex = _mm256_blendv_pd(lanesIndex, index, greater);
+      index = _mm256_add_pd(index, step);
+    }
+
+    alignas(32) double keys[4];
+    alignas(32) double indices[4];
+    _mm256_store_pd(keys, lanes);
+    _mm256_store_pd(indices, lanesIndex);
+    MergeLanes(keys, indices, best, bestIndex);
+  } else {
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i lanesIndex = _mm256_set1_epi32(static_cast<int32_t>(bestIndex));
+    __m256i index =
+        _mm256_add_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                         _mm256_set1_epi32(static_cast<int32_t>(i)));
+    alignas(32) int32_t indices[8];
+
+    if constexpr (Precision == GeometryPrecision::Float) {
+      const __m256 va = _mm256_set1_ps(a);
+      const __m256 vb = _mm256_set1_ps(b);
+      const __m256 vc = _mm256_set1_ps(c);
+      __m256 lanes = _mm256_setzero_ps();
+
+      for (; i + 8 <= last; i += 8) {
+        const __m256 x = _mm256_cvtepi32_ps(load8(xs + i));
+        const __m256 y = _mm256_cvtepi32_ps(load8(ys + i));
+        const __m256 residual = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(va, x), _mm256_mul_ps(vb, y)), vc);
+        const __m256 key = _mm256_mul_ps(residual, residual);
+        const __m256 greater = _mm256_cmp_ps(key, lanes, _CMP_GT_OQ);
+        lanes = _mm256_blendv_ps(lanes, key, greater);
+        lanesIndex = _mm256_blendv_epi8(lanesIndex, index,
+                                        _mm256_castps_si256(greater));
+        index = _mm256_add_epi32(index, step);
+      }
+
+      alignas(32) float keys[8];
+      _mm256_store_ps(keys, lanes);
+      _mm256_store_si256(reinterpret_cast<__m256i *>(indices), lanesIndex);
+      MergeLanes(keys, indices, best, bestIndex);
+    } else {
+      // Exact 32-bit residuals within FIXED_COORDINATE_LIMIT; the caller
+      // checked the chord ends, the sweep checks the points between them
+      const __m256i va = _mm256_set1_epi32(static_cast<int32_t>(a));
+      const __m256i vb = _mm256_set1_epi32(static_cast<int32_t>(b));
+      const __m256i vc = _mm256_set1_epi32(static_cast<int32_t>(c));
+      const __m256i limit = _mm256_set1_epi32(FIXED_COORDINATE_LIMIT);
+      __m256i lanes = _mm256_setzero_si256();
+      __m256i outside = _mm256_setzero_si256();
+
+      for (; i + 8 <= last; i += 8) {
+        const __m256i x = load8(xs + i);
+        const __m256i y = load8(ys + i);
+        outside = _mm256_or_si256(
+            outside,
+            _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_abs_epi32(x), limit),
+                            _mm256_cmpgt_epi32(_mm256_abs_epi32(y), limit)));
+        const __m256i residual = _mm256_add_epi32(
+            _mm256_add_epi32(_mm256_mullo_epi32(va, x),
+                             _mm256_mullo_epi32(vb, y)),
+            vc);
+        const __m256i key = _mm256_abs_epi32(residual);
+        const __m256i greater = _mm256_cmpgt_epi32(key, lanes);
+        lanes = _mm256_blendv_epi8(lanes, key, greater);
+        lanesIndex = _mm256_blendv_epi8(lanesIndex, index, greater);
+        index = _mm256_add_epi32(index, step);
+      }
+
+      if (!_mm256_testz_si256(outside, outside))
+        return false;
+
+      alignas(32) int32_t keys[8];
+      _mm256_store_si256(reinterpret_cast<__m256i *>(keys), lanes);
+      _mm256_store_si256(reinterpret_cast<__m256i *>(indices), lanesIndex);
+      MergeLanes(keys, indices, best, bestIndex);
+    }
+  }
+  return true;
+}
+#endif
+
+} // namespace
+
+template <GeometryPrecision Precision>
+void ContourGeometry::Measure(const ContourSet &contours,
+                              std::vector<ContourFeatures> &features) {
+  features.resize(contours.Size());
+  for (size_t i = 0; i < contours.Size(); ++i) {
+    features[i] = Measure<Precision>(contours, i);
+  }
+}
+
+template <GeometryPrecision Precision>
+ContourFeatures ContourGeometry::Measure(const ContourSet &contours,
+                                         size_t contour) {
+  return Measure<Precision>(contours.View(contour));
+}
+
+template <GeometryPrecision Precision>
+ContourFeatures ContourGeometry::Measure(const ContourView &contour) {
+  using Exact = typename GeometryTypes<Precision>::Exact;
+  using Real = typename GeometryTypes<Precision>::Real;
+  using Sum = typename Accumulator<Exact>::Type;
+  ContourFeatures features;
+  const size_t n = contour.count;
+  if (n == 0)
+    return features;
+
+  const ContourSet::Coordinate *xs = contour.xs;
+  const ContourSet::Coordinate *ys = contour.ys;
+
+  // Point n is the padding copy of point 0, closing the loop
+  Sum twiceArea = 0, sumX = 0, sumY = 0;
+  Real perimeter = 0;
+  ContourSet::Coordinate reach = 0; // largest |coordinate|, fixed point only
+#pragma omp simd reduction(+ : twiceArea, perimeter, sumX, sumY)             \
+    reduction(max : reach)
+  for (size_t i = 0; i < n; ++i) {
+    const Sum x0 = static_cast<Sum>(xs[i]), y0 = static_cast<Sum>(ys[i]);
+    const Sum x1 = static_cast<Sum>(xs[i + 1]);
+    const Sum y1 = static_cast<Sum>(ys[i + 1]);
+    twiceArea += x0 * y1 - x1 * y0;
+    const Real dx = static_cast<Real>(xs[i + 1] - xs[i]);
+    const Real dy = static_cast<Real>(ys[i + 1] - ys[i]);
+    perimeter += std::sqrt(dx * dx + dy * dy);
+    sumX += x0;
+    sumY += y0;
+    if constexpr (Precision == GeometryPrecision::Fixed)
+      reach = std::max(reach, std::max(std::abs(xs[i]), std::abs(ys[i])));
+  }
+
+  if constexpr (Precision == GeometryPrecision::Fixed) {
+    // The wrapped sums are the true ones when those fit in 32 bits. Each
+    // coordinate sum is at most n reach, and as p_i x p_i+1 equals
+    // p_i x (p_i+1 - p_i), twice the area is at most sqrt(2) reach times
+    // the perimeter. Contours beyond that take the double kernel.
+    const double bound =
+        reach * std::max(static_cast<double>(n),
+                         std::numbers::sqrt2 * static_cast<double>(perimeter));
+    if (bound >= FIXED_SUM_LIMIT)
+      return Measure<GeometryPrecision::Double>(contour);
+  }
+  auto value = [](Sum sum) {
+    return static_cast<double>(static_cast<Exact>(sum));
+  };
+
+  features.area = n >= 3 ? std::abs(value(twiceArea)) * 0.5 : 0.0;
+  features.perimeter = perimeter;
+  features.centroidX = value(sumX) / n;
+  features.centroidY = value(sumY) / n;
+
+  // Mean and variance of the centroid distances in one sweep
+  const Real cx = static_cast<Real>(features.centroidX);
+  const Real cy = static_cast<Real>(features.centroidY);
+  Real sumDistance = 0, sumSquared = 0;
+#pragma omp simd reduction(+ : sumDistance, sumSquared)
+  for (size_t i = 0; i < n; ++i) {
+    const Real dx = static_cast<Real>(xs[i]) - cx;
+    const Real dy = static_cast<Real>(ys[i]) - cy;
+    const Real squared = dx * dx + dy * dy;
+    sumDistance += std::sqrt(squared);
+    sumSquared += squared;
+  }
+
+  const double meanDistance = static_cast<double>(sumDistance) / n;
+  if (meanDistance > 0.0) {
+    const double variance = std::max(
+        0.0, static_cast<double>(sumSquared) / n - meanDistance * meanDistance);
+    features.radialSpread = std::sqrt(variance) / meanDistance;
+  }
+  return features;
+}
+
+template <GeometryPrecision Precision>
+size_t ContourGeometry::FarthestFromChord(const ContourSet::Coordinate *xs,
+                                          const ContourSet::Coordinate *ys,
+                                          size_t first, size_t last,
+                                          double &distanceSquared) {
+  // The scalar sweep of fixed point also covers chords beyond
+  // FIXED_COORDINATE_LIMIT, so its residuals stay 64-bit
+  using Exact =
+      std::conditional_t<Precision == GeometryPrecision::Fixed, int64_t,
+                         typename GeometryTypes<Precision>::Exact>;
+  distanceSquared = 0.0;
+
+  // Line a x + b y + c = 0 through both ends, exact in 64 bits and hoisted
+  // out of the sweep
+  const int64_t a64 = static_cast<int64_t>(ys[last]) - ys[first];
+  const int64_t b64 = static_cast<int64_t>(xs[first]) - xs[last];
+  const int64_t c64 = static_cast<int64_t>(xs[last]) * ys[first] -
+                      static_cast<int64_t>(xs[first]) * ys[last];
+  const double chordSquared = static_cast<double>(a64 * a64 + b64 * b64);
+  if (chordSquared == 0.0 || last <= first + 1)
+    return first;
+
+  const Exact a = static_cast<Exact>(a64);
+  const Exact b = static_cast<Exact>(b64);
+  const Exact c = static_cast<Exact>(c64);
+
+  // Compare residual keys; one division at the end
+  Exact best = 0;
+  size_t bestIndex = first;
+  size_t i = first + 1;
+
+#if defined(__AVX2__)
+  // Fixed point falls back to the 64-bit scalar sweep when the chord or
+  // any point between its ends is too far out for 32-bit lanes
+  const bool vectorSafe =
+      Precision != GeometryPrecision::Fixed ||
+      (WithinFixedLimit(xs[first]) && WithinFixedLimit(ys[first]) &&
+       WithinFixedLimit(xs[last]) && WithinFixedLimit(ys[last]));
+  if (last - i >= 16 && vectorSafe &&
+      !FarthestFromChordAvx2<Precision>(xs, ys, i, last, a, b, c, best,
+                                        bestIndex)) {
+    i = first + 1;
+  }
+#endif
+
+  for (; i < last; ++i) {
+    const Exact key = ResidualKey<Precision>(a * xs[i] + b * ys[i] + c);
+    if (key > best) {
+      best = key;
+      bestIndex = i;
+    }
+  }
+
+  const double bestSquared =
+      Precision == GeometryPrecision::Fixed
+          ? static_cast<double>(best) * static_cast<double>(best)
+          : static_cast<double>(best);
+  distanceSquared = bestSquared / chordSquared;
+  return bestIndex;
+}
+
+template void ContourGeometry::Measure<GeometryPrecision::Double>(
+    const ContourSet &, std::vector<ContourFeatures> &);
+template void ContourGeometry::Measure<GeometryPrecision::Float>(
+    const ContourSet &, std::vector<ContourFeatures> &);
+template void ContourGeometry::Measure<GeometryPrecision::Fixed>(
+    const ContourSet &, std::vector<ContourFeatures> &);
+template ContourFeatures
+ContourGeometry::Measure<GeometryPrecision::Double>(const ContourSet &,
+                                                    size_t);
+template ContourFeatures
+ContourGeometry::Measure<GeometryPrecision::Float>(const ContourSet &,
+                                                   size_t);
+template ContourFeatures
+ContourGeometry::Measure<GeometryPrecision::Fixed>(const ContourSet &,
+                                                   size_t);
+template ContourFeatures
+ContourGeometry::Measure<GeometryPrecision::Double>(const ContourView &);
+template ContourFeatures
+ContourGeometry::Measure<GeometryPrecision::Float>(const ContourView &);
+template ContourFeatures
+ContourGeometry::Measure<GeometryPrecision::Fixed>(const ContourView &);
+template size_t ContourGeometry::FarthestFromChord<GeometryPrecision::Double>(
+    const ContourSet::Coordinate *, const ContourSet::Coordinate *, size_t,
+    size_t, double &);
+template size_t ContourGeometry::FarthestFromChord<GeometryPrecision::Float>(
+    const ContourSet::Coordinate *, const ContourSet::Coordinate *, size_t,
+    size_t, double &);
+template size_t ContourGeometry::FarthestFromChord<GeometryPrecision::Fixed>(
+    const ContourSet::Coordinate *, const ContourSet::Coordinate *, size_t,
+    size_t, double &);
@@ -0,0 +1,71 @@
+#include "ShapeDetector/ContourSet.hpp"
+#include <algorithm>
+
+void ContourSet::Append(const std::vector<Point> &contour) {
+  for (const Point &p : contour)
+    Push(p.x, p.y);
+  Close();
+}
+
+void ContourSet::Append(const ContourSet &from, size_t contour,
+                        size_t stride) {
+  const Coordinate *xs = from.X(contour);
+  const Coordinate *ys = from.Y(contour);
+  const size_t count = from.PointCount(contour);
+  stride = std::max<size_t>(stride, 1);
+  for (size_t i = 0; i < count; i += stride)
+    Push(xs[i], ys[i]);
+  Close();
+}
+
+void ContourSet::Close() {
+  const size_t first = offsets_.back();
+  const bool empty = xs_.size() == first;
+  for (size_t pad = 0; pad < WRAP_PADDING; ++pad) {
+    xs_.push_back(empty ? 0 : xs_[first]);
+    ys_.push_back(empty ? 0 : ys_[first]);
+  }
+  offsets_.push_back(static_cast<uint32_t>(xs_.size()));
+}
+
+void ContourSet::Discard() {
+  xs_.resize(offsets_.back());
+  ys_.resize(offsets_.back());
+}
+
+void ContourSet::CopyTo(size_t contour, std::vector<Point> &out,
+                        size_t stride) const {
+  const Coordinate *xs = X(contour);
+  const Coordinate *ys = Y(contour);
+  const size_t count = PointCount(contour);
+  stride = std::max<size_t>(stride, 1);
+
+  out.clear();
+  out.reserve((count + stride - 1) / stride);
+  for (size_t i = 0; i < count; i += stride) {
+    out.emplace_back(xs[i], ys[i]);
+  }
+}
+
+std::vector<Point> ContourSet::Points(size_t contour) const {
+  std::vector<Point> points;
+  CopyTo(contour, points);
+  return points;
+}
+
+void ContourSet::Reserve(size_t contours, size_t points) {
+  offsets_.reserve(contours + 1);
+  xs_.reserve(points + contours * WRAP_PADDING);
+  ys_.reserve(points + contours * WRAP_PADDING);
+}
+
+void ContourSet::Clear() {
+  xs_.clear();
+  ys_.clear();
+  offsets_.resize(1);
+}
+
+size_t ContourSet::CapacityBytes() const {
+  return (xs_.capacity() + ys_.capacity()) * sizeof(Coordinate) +
+         offsets_.capacity() * sizeof(uint32_t);
+}
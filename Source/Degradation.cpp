@@ -0,0 +1,285 @@
+#include "ShapeDetector/Degradation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <omp.h>
+#include <vector>
+
+constexpr uint64_t STAGE_OCCLUSION = 1;
+constexpr uint64_t STAGE_ILLUMINATION = 2;
+constexpr uint64_t STAGE_NOISE = 3;
+constexpr uint64_t STAGE_SALT_PEPPER = 4;
+constexpr double BLUR_RADIUS_SIGMAS = 3.0;
+
+namespace {
+
+// SplitMix64 finalizer; cheap enough to evaluate once per pixel
+inline uint64_t Mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+inline uint64_t RowKey(uint64_t seed, uint64_t stage, int y) {
+  return Mix(Mix(seed ^ (stage << 56)) + static_cast<uint64_t>(y));
+}
+
+inline uint64_t PixelHash(uint64_t rowKey, int x) {
+  return Mix(rowKey + static_cast<uint64_t>(x) * 0xd1b54a32d192ed03ULL);
+}
+
+inline double Uniform(uint64_t hash) { return (hash >> 11) * 0x1.0p-53; }
+
+inline int Clamp(int value) { return std::clamp(value, 0, 255); }
+
+} // namespace
+
+DegradationConfig DegradationConfig::Production() {
+  DegradationConfig config;
+  config.occluderCount = 2;
+  config.occluderSize = 0.15;
+  config.gradientStrength = 0.4;
+  config.blurSigma = 1.0;
+  config.noiseSigma = 12.0;
+  config.blockSize = 8;
+  config.blockQuantization = 24;
+  config.saltPepperRate = 0.002;
+  return config;
+}
+
+void Degradation::Apply(Image &image, const DegradationConfig &config,
+                        uint64_t seed) {
+  if (config.occluderCount > 0)
+    AddOcclusions(image, config.occluderCount, config.occluderSize, seed);
+  if (config.gradientStrength > 0)
+    ApplyIlluminationGradient(image, config.gradientStrength, seed);
+  if (config.blurSigma > 0)
+    ApplyBlur(image, config.blurSigma);
+  if (config.noiseSigma > 0)
+    AddGaussianNoise(image, config.noiseSigma, seed);
+  if (config.blockSize > 1)
+    ApplyBlockArtifacts(image, config.blockSize, config.blockQuantization);
+  if (config.saltPepperRate > 0)
+    AddSaltAndPepper(image, config.saltPepperRate, seed);
+}
+
+void Degradation::AddOcclusions(Image &image, int count, double maxSize,
+                                uint64_t seed) {
+  const double maxSide = maxSize * std::min(image.width, image.height);
+  if (maxSide < 1.0)
+    return;
+
+  for (int i = 0; i < count; ++i) {
+    const uint64_t key = RowKey(seed, STAGE_OCCLUSION, i);
+    auto draw = [key](int index) { return Uniform(PixelHash(key, index)); };
+
+    const int boxWidth =
+        std::max(1, static_cast<int>(maxSide * (0.25 + 0.75 * draw(0))));
+    const int boxHeight =
+        std::max(1, static_cast<int>(maxSide * (0.25 + 0.75 * draw(1))));
+    const int left = static_cast<int>(draw(2) * image.width) - boxWidth / 2;
+    const int top = static_cast<int>(draw(3) * image.height) - boxHeight / 2;
+    const int value = static_cast<int>(draw(4) * 256.0);
+
+    const int x1 = std::max(0, left);
+    const int x2 = std::min(image.width, left + boxWidth);
+    const int y1 = std::max(0, top);
+    const int y2 = std::min(image.height, top + boxHeight);
+    for (int y = y1; y < y2; ++y) {
+      std::fill(image.pixels[y].begin() + x1, image.pixels[y].begin() + x2,
+                value);
+    }
+  }
+}
+
+void Degradation::ApplyIlluminationGradient(Image &image, double strength,
+                                            uint64_t seed) {
+  if (image.width <= 0 || image.height <= 0)
+    return;
+
+  // Light falls off linearly along a random direction: gain 1 on the lit
+  // side down to 1 - strength on the far side. Past 1 the gain would turn
+  // negative, below 0 it would push pixels over 255.
+  strength = std::clamp(strength, 0.0, 1.0);
+  const double angle =
+      2.0 * std::numbers::pi * Uniform(RowKey(seed, STAGE_ILLUMINATION, 0));
+  const double dx = std::cos(angle);
+  const double dy = std::sin(angle);
+
+  const double corners[4] = {0.0, dx * (image.width - 1),
+                             dy * (image.height - 1),
+                             dx * (image.width - 1) + dy * (image.height - 1)};
+  const double low = *std::min_element(corners, corners + 4);
+  const double high = *std::max_element(corners, corners + 4);
+  const double scale = (high - low) > 0.0 ? strength / (high - low) : 0.0;
+
+#pragma omp parallel for
+  for (int y = 0; y < image.height; ++y) {
+    int *row = image.pixels[y].data();
+    const float base = static_cast<float>(1.0 - (dy * y - low) * scale);
+    const float step = static_cast<float>(-dx * scale);
+
+#pragma omp simd
+    for (int x = 0; x < image.width; ++x) {
+      const float gain = base + step * x;
+      row[x] = static_cast<int>(row[x] * gain + 0.5f);
+    }
+  }
+}
+
+void Degradation::ApplyBlur(Image &image, double sigma) {
+  const int width = image.width;
+  const int height = image.height;
+  const int radius = static_cast<int>(std::ceil(BLUR_RADIUS_SIGMAS * sigma));
+  if (radius < 1 || width <= 0 || height <= 0)
+    return;
+
+  std::vector<float> weights(2 * radius + 1);
+  float total = 0.0f;
+  for (int k = -radius; k <= radius; ++k) {
+    weights[k + radius] =
+        static_cast<float>(std::exp(-(k * k) / (2.0 * sigma * sigma)));
+    total += weights[k + radius];
+  }
+  for (float &w : weights) {
+    w /= total;
+  }
+
+  // Separable passes on float rows; borders are clamped so the frame edge
+  // does not darken
+  std::vector<float> horizontal(static_cast<size_t>(width) * height);
+
+#pragma omp parallel
+  {
+    std::vector<float> padded(width + 2 * radius);
+
+#pragma omp for
+    for (int y = 0; y < height; ++y) {
+      const int *row = image.pixels[y].data();
+      for (int x = 0; x < width + 2 * radius; ++x) {
+        padded[x] =
+            static_cast<float>(row[std::clamp(x - radius, 0, width - 1)]);
+      }
+
+      float *out = horizontal.data() + static_cast<size_t>(y) * width;
+      std::fill(out, out + width, 0.0f);
+      for (int k = 0; k <= 2 * radius; ++k) {
+        const float w = weights[k];
+        const float *src = padded.data() + k;
+#pragma omp simd
+        for (int x = 0; x < width; ++x) {
+          out[x] += w * src[x];
+        }
+      }
+    }
+
+    std::vector<float> accumulator(width);
+
+#pragma omp for
+    for (int y = 0; y < height; ++y) {
+      std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+      for (int k = -radius; k <= radius; ++k) {
+        const float w = weights[k + radius];
+        const float *src =
+            horizontal.data() +
+            static_cast<size_t>(std::clamp(y + k, 0, height - 1)) * width;
+        float *acc = accumulator.data();
+#pragma omp simd
+        for (int x = 0; x < width; ++x) {
+          acc[x] += w * src[x];
+        }
+      }
+
+      int *row = image.pixels[y].data();
+      const float *acc = accumulator.data();
+#pragma omp simd
+      for (int x = 0; x < width; ++x) {
+        row[x] = static_cast<int>(acc[x] + 0.5f);
+      }
+    }
+  }
+}
+
+void Degradation::AddGaussianNoise(Image &image, double sigma,
+                                   uint64_t seed) {
+  // Sum of four 16-bit uniforms (Irwin-Hall) has variance 1/3 in [0, 4), so
+  // one hash per pixel gives a branch-free, vectorizable normal deviate
+  const float scale = static_cast<float>(sigma * std::sqrt(3.0) / 65535.0);
+  const float offset = static_cast<float>(2.0 * 65535.0);
+
+#pragma omp parallel for
+  for (int y = 0; y < image.height; ++y) {
+    const uint64_t key = RowKey(seed, STAGE_NOISE, y);
+    int *row = image.pixels[y].data();
+
+#pragma omp simd
+    for (int x = 0; x < image.width; ++x) {
+      const uint64_t h = PixelHash(key, x);
+      const int sum = static_cast<int>((h & 0xffff) + ((h >> 16) & 0xffff) +
+                                       ((h >> 32) & 0xffff) + (h >> 48));
+      const float noise = (static_cast<float>(sum) - offset) * scale;
+      row[x] = Clamp(static_cast<int>(std::lround(row[x] + noise)));
+    }
+  }
+}
+
+void Degradation::ApplyBlockArtifacts(Image &image, int blockSize,
+                                      int quantization) {
+  if (blockSize < 2 || quantization < 1)
+    return;
+
+  // Each block keeps its DC level exactly and loses detail to a coarse
+  // quantizer, which leaves visible steps at block borders like low quality
+  // JPEG
+  const int blockRows = (image.height + blockSize - 1) / blockSize;
+  const float step = static_cast<float>(quantization);
+  const float inverseStep = 1.0f / step;
+
+#pragma omp parallel for
+  for (int by = 0; by < blockRows; ++by) {
+    const int y1 = by * blockSize;
+    const int y2 = std::min(image.height, y1 + blockSize);
+
+    for (int x1 = 0; x1 < image.width; x1 += blockSize) {
+      const int x2 = std::min(image.width, x1 + blockSize);
+
+      int sum = 0;
+      for (int y = y1; y < y2; ++y) {
+        const int *row = image.pixels[y].data();
+        for (int x = x1; x < x2; ++x) {
+          sum += row[x];
+        }
+      }
+      const float mean = static_cast<float>(sum) / ((y2 - y1) * (x2 - x1));
+
+      for (int y = y1; y < y2; ++y) {
+        int *row = image.pixels[y].data();
+#pragma omp simd
+        for (int x = x1; x < x2; ++x) {
+          const float residual = std::nearbyint((row[x] - mean) * inverseStep);
+          row[x] = Clamp(static_cast<int>(std::lround(mean + residual * step)));
+        }
+      }
+    }
+  }
+}
+
+void Degradation::AddSaltAndPepper(Image &image, double rate, uint64_t seed) {
+  const uint64_t threshold =
+      static_cast<uint64_t>(std::clamp(rate, 0.0, 1.0) * 4294967296.0);
+
+#pragma omp parallel for
+  for (int y = 0; y < image.height; ++y) {
+    const uint64_t key = RowKey(seed, STAGE_SALT_PEPPER, y);
+    int *row = image.pixels[y].data();
+
+#pragma omp simd
+    for (int x = 0; x < image.width; ++x) {
+      const uint64_t h = PixelHash(key, x);
+      if ((h >> 32) < threshold) {
+        row[x] = (h & 1) ? 255 : 0;
+      }
+    }
+  }
+}
@@ -0,0 +1,51 @@
+#include "ShapeDetector/DetectionStats.hpp"
+
+const char *DetectionStats::Name(RejectReason reason) {
+  switch (reason) {
+  case RejectReason::TooFewPoints:
+    return "too_few_points";
+  case RejectReason::VertexCount:
+    return "vertex_count";
+  case RejectReason::Area:
+    return "area";
+  case RejectReason::NotQuadrilateral:
+    return "not_quadrilateral";
+  case RejectReason::Circular:
+    return "circular";
+  case RejectReason::Moments:
+    return "moments";
+  case RejectReason::Rectangularity:
+    return "rectangularity";
+  case RejectReason::Degenerate:
+    return "degenerate";
+  case RejectReason::NotCircular:
+    return "not_circular";
+  case RejectReason::CircleGeometry:
+    return "circle_geometry";
+  case RejectReason::RadiusRange:
+    return "radius_range";
+  case RejectReason::LowConfidence:
+    return "low_confidence";
+  default:
+    return "unknown";
+  }
+}
+
+const char *DetectionStats::Name(ApproximationBranch branch) {
+  switch (branch) {
+  case ApproximationBranch::Moments:
+    return "moments";
+  case ApproximationBranch::Hough:
+    return "hough";
+  case ApproximationBranch::Curvature:
+    return "curvature";
+  case ApproximationBranch::DouglasPeucker:
+    return "douglas_peucker";
+  case ApproximationBranch::ConvexHull:
+    return "convex_hull";
+  case ApproximationBranch::FinalDouglasPeucker:
+    return "final_douglas_peucker";
+  default:
+    return "unknown";
+  }
+}
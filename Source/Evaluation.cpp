@@ -0,0 +1,139 @@
+#include "ShapeDetector/Evaluation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+constexpr double CENTER_TOLERANCE = 0.25; // fraction of the smaller extent
+constexpr double MIN_CENTER_TOLERANCE = 4.0;
+constexpr double SIZE_TOLERANCE = 0.25; // relative size error
+constexpr double MIN_SIZE_TOLERANCE = 2.0;
+
+namespace {
+
+double Distance(const Point &a, const Point &b) {
+  return std::hypot(static_cast<double>(a.x - b.x),
+                    static_cast<double>(a.y - b.y));
+}
+
+bool SizeAgrees(double detected, double low, double high) {
+  return detected >= low * (1.0 - SIZE_TOLERANCE) - MIN_SIZE_TOLERANCE &&
+         detected <= high * (1.0 + SIZE_TOLERANCE) + MIN_SIZE_TOLERANCE;
+}
+
+// Greedy one-to-one matching; agrees(t, d) decides whether detection d may
+// stand for truth t, ties go to the detection nearest the truth center
+template <typename Detection, typename Agrees>
+MatchCounts Match(const std::vector<Detection> &detected,
+                  const std::vector<Point> &truthCenters, Agrees agrees) {
+  MatchCounts counts;
+  std::vector<bool> claimed(detected.size(), false);
+
+  for (size_t t = 0; t < truthCenters.size(); ++t) {
+    int best = -1;
+    double bestDistance = std::numeric_limits<double>::max();
+    for (size_t d = 0; d < detected.size(); ++d) {
+      if (claimed[d] || !agrees(t, detected[d]))
+        continue;
+      const double distance = Distance(truthCenters[t], detected[d].center);
+      if (distance < bestDistance) {
+        bestDistance = distance;
+        best = static_cast<int>(d);
+      }
+    }
+    if (best >= 0) {
+      claimed[best] = true;
+      counts.truePositives++;
+    } else {
+      counts.falseNegatives++;
+    }
+  }
+
+  counts.falsePositives =
+      static_cast<int>(std::count(claimed.begin(), claimed.end(), false));
+  return counts;
+}
+
+} // namespace
+
+double MatchCounts::Precision() const {
+  const int reported = truePositives + falsePositives;
+  return reported > 0 ? static_cast<double>(truePositives) / reported : 1.0;
+}
+
+double MatchCounts::Recall() const {
+  const int expected = truePositives + falseNegatives;
+  return expected > 0 ? static_cast<double>(truePositives) / expected : 1.0;
+}
+
+double MatchCounts::F1() const {
+  const double precision = Precision();
+  const double recall = Recall();
+  return precision + recall > 0.0
+             ? 2.0 * precision * recall / (precision + recall)
+             : 0.0;
+}
+
+MatchCounts &MatchCounts::operator+=(const MatchCounts &other) {
+  truePositives += other.truePositives;
+  falsePositives += other.falsePositives;
+  falseNegatives += other.falseNegatives;
+  return *this;
+}
+
+MatchCounts Evaluation::MatchRectangles(const std::vector<Rectangle> &detected,
+                                        const std::vector<Rectangle> &truth) {
+  std::vector<Point> centers;
+  centers.reserve(truth.size());
+  for (const auto &rect : truth)
+    centers.push_back(rect.center);
+
+  // Width and height swap with a quarter turn, so compare sorted extents
+  return Match(detected, centers, [&](size_t t, const Rectangle &rect) {
+    const double shortSide = std::min(truth[t].width, truth[t].height);
+    const double longSide = std::max(truth[t].width, truth[t].height);
+    const double tolerance =
+        std::max(MIN_CENTER_TOLERANCE, CENTER_TOLERANCE * shortSide);
+    return Distance(truth[t].center, rect.center) <= tolerance &&
+           SizeAgrees(std::min(rect.width, rect.height), shortSide,
+                      shortSide) &&
+           SizeAgrees(std::max(rect.width, rect.height), longSide, longSide);
+  });
+}
+
+MatchCounts Evaluation::MatchSpheres(const std::vector<Sphere> &detected,
+                                     const std::vector<Sphere> &circles,
+                                     const std::vector<Ellipse> &ellipses) {
+  // An ellipse may be reported with any radius between its two semi-axes
+  struct Extent {
+    double low, high;
+  };
+  std::vector<Point> centers;
+  std::vector<Extent> extents;
+  for (const auto &circle : circles) {
+    centers.push_back(circle.center);
+    extents.push_back({static_cast<double>(circle.radius),
+                       static_cast<double>(circle.radius)});
+  }
+  for (const auto &ellipse : ellipses) {
+    centers.push_back(ellipse.center);
+    extents.push_back(
+        {static_cast<double>(std::min(ellipse.radiusX, ellipse.radiusY)),
+         static_cast<double>(std::max(ellipse.radiusX, ellipse.radiusY))});
+  }
+
+  return Match(detected, centers, [&](size_t t, const Sphere &sphere) {
+    const double tolerance =
+        std::max(MIN_CENTER_TOLERANCE, CENTER_TOLERANCE * extents[t].low);
+    return Distance(centers[t], sphere.center) <= tolerance &&
+           SizeAgrees(sphere.radius, extents[t].low, extents[t].high);
+  });
+}
+
+SceneEvaluation Evaluation::Evaluate(const Scene &scene,
+                                     const std::vector<Rectangle> &rectangles,
+                                     const std::vector<Sphere> &spheres) {
+  SceneEvaluation evaluation;
+  evaluation.rectangles = MatchRectangles(rectangles, scene.rectangles);
+  evaluation.spheres = MatchSpheres(spheres, scene.circles, scene.ellipses);
+  return evaluation;
+}
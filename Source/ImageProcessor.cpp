@@ -1,20 +1,239 @@
 #include "ShapeDetector/ImageProcessor.hpp"
+#include "ShapeDetector/Rasterizer.hpp"
 #include "ShapeDetector/RectangleDetector.hpp"  // This includes Sphere definition
 #include "ShapeDetector/SphereDetector.hpp"
 #include "Utils.hpp"
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <omp.h>
 #include <random>
 #include <sstream>
 
+#if defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+namespace {
+
+// ColorImage rows are reinterpreted as packed RGB bytes by ExpandGrayRow
+static_assert(sizeof(ColorPixel) == 3, "ColorPixel must be packed RGB");
+
+const ColorPixel RECTANGLE_COLOR(255, 0, 0);
+const ColorPixel SPHERE_COLOR(0, 0, 255);
+const ColorPixel OBLOID_COLOR(0, 255, 0);
+constexpr int OUTLINE_THICKNESS = 4;
+
+// Corners of a rotated rectangle in drawing order, without heap use
+std::array<Point, 4> RectangleCorners(const Rectangle &rect) {
+  // rect.angle is already in radians
+  const double cosAngle = std::cos(rect.angle);
+  const double sinAngle = std::sin(rect.angle);
+
+  // Half dimensions
+  const double halfW = rect.width / 2.0;
+  const double halfH = rect.height / 2.0;
+
+  // Top-left, top-right, bottom-right, bottom-left relative to center
+  const double relativeCorners[4][2] = {
+      {-halfW, -halfH}, {halfW, -halfH}, {halfW, halfH}, {-halfW, halfH}};
+
+  // Rotate and translate to world coordinates
+  std::array<Point, 4> corners;
+  for (int i = 0; i < 4; ++i) {
+    const double x = relativeCorners[i][0];
+    const double y = relativeCorners[i][1];
+    corners[i] = Point(static_cast<int>(x * cosAngle - y * sinAngle +
+                                        rect.center.x),
+                       static_cast<int>(x * sinAngle + y * cosAngle +
+                                        rect.center.y));
+  }
+  return corners;
+}
+
+// Expand one row of grey values into interleaved RGB triplets
+void ExpandGrayRow(const int *gray, unsigned char *rgb, int width) {
+  int x = 0;
+#if defined(__SSSE3__)
+  // Each shuffle mask places 16 grey bytes into one third of 48 RGB bytes
+  const __m128i mask0 =
+      _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5);
+  const __m128i mask1 =
+      _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+  const __m128i mask2 =
+      _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15,
+                    15, 15);
+
+  for (; x + 16 <= width; x += 16) {
+    // Narrow 16 ints to 16 bytes with saturation
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(gray + x));
+    __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(gray + x + 4));
+    __m128i c =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(gray + x + 8));
+    __m128i d =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(gray + x + 12));
+    __m128i bytes =
+        _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+
+    unsigned char *out = rgb + x * 3;
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                     _mm_shuffle_epi8(bytes, mask0));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16),
+                     _mm_shuffle_epi8(bytes, mask1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 32),
+                     _mm_shuffle_epi8(bytes, mask2));
+  }
+#endif
+  for (; x < width; ++x) {
+    unsigned char value = static_cast<unsigned char>(Clamp(gray[x], 0, 255));
+    rgb[x * 3] = rgb[x * 3 + 1] = rgb[x * 3 + 2] = value;
+  }
+}
+
+// Pixel writers so the drawing code works on any frame layout. FillSpan
+// takes an already clipped span and writes the whole run at once.
+struct ColorImageCanvas {
+  ColorImage &image;
+
+  int Width() const { return image.width; }
+  int Height() const { return image.height; }
+
+  void Plot(int x, int y, const ColorPixel &color) {
+    if (x >= 0 && x < image.width && y >= 0 && y < image.height) {
+      image.pixels[y][x] = color;
+    }
+  }
+
+  void FillSpan(int y, int x1, int x2, const ColorPixel &color) {
+    std::fill_n(image.pixels[y].begin() + x1, x2 - x1 + 1, color);
+  }
+};
+
+struct RgbViewCanvas {
+  const RgbView &view;
+
+  int Width() const { return view.width; }
+  int Height() const { return view.height; }
+
+  void Plot(int x, int y, const ColorPixel &color) {
+    if (x >= 0 && x < view.width && y >= 0 && y < view.height) {
+      FillSpan(y, x, x, color);
+    }
+  }
+
+  void FillSpan(int y, int x1, int x2, const ColorPixel &color) {
+    unsigned char *p = view.data + static_cast<size_t>(y) * view.stride +
+                       static_cast<size_t>(x1) * 3;
+    if (color.r == color.g && color.g == color.b) {
+      std::memset(p, color.r, static_cast<size_t>(x2 - x1 + 1) * 3);
+      return;
+    }
+    for (int x = x1; x <= x2; ++x, p += 3) {
+      p[0] = color.r;
+      p[1] = color.g;
+      p[2] = color.b;
+    }
+  }
+};
+
+struct OverlayCanvas {
+  Overlay &overlay;
+
+  int Width() const { return overlay.width; }
+  int Height() const { return overlay.height; }
+
+  void Plot(int x, int y, const ColorPixel &color) {
+    if (x >= 0 && x < overlay.width && y >= 0 && y < overlay.height) {
+      FillSpan(y, x, x, color);
+    }
+  }
+
+  void FillSpan(int y, int x1, int x2, const ColorPixel &color) {
+    // Extend the row's most recent span when the new run continues it
+    auto &row = overlay.rows[y];
+    if (!row.empty()) {
+      OverlaySpan &last = row.back();
+      if (last.color.r == color.r && last.color.g == color.g &&
+          last.color.b == color.b && x1 <= last.x2 + 1 && x2 >= last.x1 - 1) {
+        last.x1 = std::min(last.x1, x1);
+        last.x2 = std::max(last.x2, x2);
+        return;
+      }
+    }
+    row.push_back({x1, x2, color});
+  }
+};
+
+// Reusable span buffer so drawing does not allocate per primitive
+std::vector<Span> &SpanScratch() {
+  thread_local std::vector<Span> spans;
+  spans.clear();
+  return spans;
+}
+
+template <typename Canvas>
+void PlotLine(Canvas &canvas, const Point &p1, const Point &p2,
+              const ColorPixel &color) {
+  // Bresenham's line algorithm
+  int dx = std::abs(p2.x - p1.x);
+  int dy = std::abs(p2.y - p1.y);
+  int sx = (p1.x < p2.x) ? 1 : -1;
+  int sy = (p1.y < p2.y) ? 1 : -1;
+  int err = dx - dy;
+
+  int x = p1.x, y = p1.y;
+
+  while (true) {
+    canvas.Plot(x, y, color);
+
+    if (x == p2.x && y == p2.y)
+      break;
+
+    int e2 = 2 * err;
+    if (e2 > -dy) {
+      err -= dy;
+      x += sx;
+    }
+    if (e2 < dx) {
+      err += dx;
+      y += sy;
+    }
+  }
+}
+
+template <typename Canvas>
+void PlotThickLine(Canvas &canvas, const Point &p1, const Point &p2,
+                   const ColorPixel &color, int thickness) {
+  // One quad per line, filled span by span without gaps or overdraw
+  std::vector<Span> &spans = SpanScratch();
+  Rasterizer::ThickLine(p1, p2, thickness, canvas.Width(), canvas.Height(),
+                        spans);
+  Rasterizer::FillSpans(canvas, spans, color);
+}
+
+template <typename Canvas>
+void PlotThickCircle(Canvas &canvas, int centerX, int centerY, int radius,
+                     const ColorPixel &color, int thickness) {
+  // One annulus covering the concentric radii radius +/- thickness / 2
+  const int halfThickness = thickness / 2;
+  std::vector<Span> &spans = SpanScratch();
+  Rasterizer::Annulus(centerX, centerY, radius - halfThickness - 0.5,
+                      radius + halfThickness + 0.5, canvas.Width(),
+                      canvas.Height(), spans);
+  Rasterizer::FillSpans(canvas, spans, color);
+}
+
+} // namespace
+
 Image ImageProcessor::LoadPGMImage(const std::string &filepath) {
   std::ifstream file(filepath, std::ios::binary);
   if (!file.is_open()) {
@@ -112,80 +331,249 @@ void ImageProcessor::SavePNGImage(const ColorImage &image,
   }
 }
 
-ColorImage
-ImageProcessor::CreateColorImage(const Image &grayImage,
-                                 const std::vector<Rectangle> &rectangles) {
-  ColorImage colorImage(grayImage.width, grayImage.height);
+void ImageProcessor::SavePPMImage(const RgbImage &image,
+                                  const std::string &filepath) {
+  std::ofstream file(filepath, std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Cannot create file: " << filepath << std::endl;
+    return;
+  }
+
+  file << "P6\n";
+  file << image.width << " " << image.height << "\n";
+  file << "255\n"; // Maximum color value
+
+  // Contiguous buffer can be written in one call
+  file.write(reinterpret_cast<const char *>(image.data.data()),
+             static_cast<std::streamsize>(image.data.size()));
+}
+
+void ImageProcessor::SavePNGImage(const RgbImage &image,
+                                  const std::string &filepath) {
+  // First save as PPM, then convert to PNG using system command
+  std::string tempPPM = filepath + ".temp.ppm";
+  SavePPMImage(image, tempPPM);
+
+  std::string command = "convert " + tempPPM + " " + filepath + " 2>/dev/null";
+  int result = system(command.c_str());
+
+  std::string cleanup = "rm -f " + tempPPM;
+  system(cleanup.c_str());
+
+  if (result != 0) {
+    std::cerr
+        << "Warning: PNG conversion failed, you may need to install ImageMagick"
+        << std::endl;
+  }
+}
+
+void ImageProcessor::SavePPMImage(const Image &grayImage,
+                                  const Overlay &overlay,
+                                  const std::string &filepath) {
+  FILE *file = std::fopen(filepath.c_str(), "wb");
+  if (!file) {
+    std::cerr << "Cannot create file: " << filepath << std::endl;
+    return;
+  }
+
+  WriteCompositedPPM(file, grayImage, overlay);
+  std::fclose(file);
+}
+
+void ImageProcessor::SavePNGImage(const Image &grayImage,
+                                  const Overlay &overlay,
+                                  const std::string &filepath) {
+  // Stream the composited PPM straight into ImageMagick, no temporary file
+  std::string command = "convert ppm:- png:\"" + filepath + "\" 2>/dev/null";
+  FILE *pipe = popen(command.c_str(), "w");
+  bool written = pipe && WriteCompositedPPM(pipe, grayImage, overlay);
+  int result = pipe ? pclose(pipe) : -1;
+
+  if (!written || result != 0) {
+    std::cerr
+        << "Warning: PNG conversion failed, you may need to install ImageMagick"
+        << std::endl;
+  }
+}
+
+bool ImageProcessor::WriteCompositedPPM(FILE *file, const Image &grayImage,
+                                        const Overlay &overlay) {
+  std::fprintf(file, "P6\n%d %d\n255\n", grayImage.width, grayImage.height);
+
+  // Only one row of RGB is ever held in memory
+  std::vector<unsigned char> row(static_cast<size_t>(grayImage.width) * 3);
+  const int overlayRows = std::min(grayImage.height, overlay.height);
 
-  // Convert grayscale to color (preserve all original pixel values)
-#pragma omp parallel for
   for (int y = 0; y < grayImage.height; ++y) {
-    for (int x = 0; x < grayImage.width; ++x) {
-      unsigned char grayValue =
-          static_cast<unsigned char>(grayImage.pixels[y][x]);
-      // Show the original image as-is in grayscale
-      colorImage.pixels[y][x] = ColorPixel(grayValue, grayValue, grayValue);
+    ExpandGrayRow(grayImage.pixels[y].data(), row.data(), grayImage.width);
+
+    if (y < overlayRows) {
+      for (const OverlaySpan &span : overlay.rows[y]) {
+        const int x2 = std::min(span.x2, grayImage.width - 1);
+        for (int x = span.x1; x <= x2; ++x) {
+          row[x * 3] = span.color.r;
+          row[x * 3 + 1] = span.color.g;
+          row[x * 3 + 2] = span.color.b;
+        }
+      }
     }
+
+    if (std::fwrite(row.data(), 1, row.size(), file) != row.size())
+      return false;
   }
 
-  // Draw red rectangle boundaries
+  return true;
+}
+
+template <typename Canvas>
+void ImageProcessor::DrawShapes(Canvas &canvas,
+                                const std::vector<Rectangle> &rectangles,
+                                const std::vector<Sphere> &spheres,
+                                const std::vector<Obloid> &obloids) {
+  // Draw thick red rectangle boundaries between consecutive corners
   for (const auto &rect : rectangles) {
-    std::vector<Point> corners = GenerateRectangleCorners(rect);
+    const std::array<Point, 4> corners = RectangleCorners(rect);
 
-    // Draw thick lines between consecutive corners in red (4x thickness)
     for (size_t i = 0; i < 4; ++i) {
-      Point p1 = corners[i];
-      Point p2 = corners[(i + 1) % 4];
-
-      DrawThickColorLine(colorImage, p1, p2, ColorPixel(255, 0, 0),
-                         4); // Red color, 4x thickness
+      PlotThickLine(canvas, corners[i], corners[(i + 1) % 4], RECTANGLE_COLOR,
+                    OUTLINE_THICKNESS);
     }
   }
 
-  return colorImage;
+  // Draw sphere boundaries in blue and obloid boundaries in green
+  for (const auto &sphere : spheres) {
+    PlotThickCircle(canvas, sphere.center.x, sphere.center.y, sphere.radius,
+                    SPHERE_COLOR, OUTLINE_THICKNESS);
+  }
+  for (const auto &obloid : obloids) {
+    PlotThickCircle(canvas, obloid.center.x, obloid.center.y, obloid.radius,
+                    OBLOID_COLOR, OUTLINE_THICKNESS);
+  }
+}
+
+ColorImage
+ImageProcessor::CreateColorImage(const Image &grayImage,
+                                 const std::vector<Rectangle> &rectangles) {
+  return CreateColorImageWithObloids(grayImage, rectangles, {});
 }
 
 ColorImage
 ImageProcessor::CreateColorImageWithSpheres(const Image &grayImage,
                                             const std::vector<Rectangle> &rectangles,
                                             const std::vector<Sphere> &spheres) {
+  ColorImage colorImage = CreateColorImage(grayImage, rectangles);
+
+  // Draw sphere boundaries
+  DrawSpheres(colorImage, spheres);
+
+  return colorImage;
+}
+
+ColorImage
+ImageProcessor::CreateColorImageWithObloids(const Image &grayImage,
+                                            const std::vector<Rectangle> &rectangles,
+                                            const std::vector<Obloid> &obloids) {
   ColorImage colorImage(grayImage.width, grayImage.height);
 
   // Convert grayscale to color (preserve all original pixel values)
 #pragma omp parallel for
   for (int y = 0; y < grayImage.height; ++y) {
-    for (int x = 0; x < grayImage.width; ++x) {
-      unsigned char grayValue =
-          static_cast<unsigned char>(grayImage.pixels[y][x]);
-      colorImage.pixels[y][x] = ColorPixel(grayValue, grayValue, grayValue);
-    }
+    ExpandGrayRow(grayImage.pixels[y].data(),
+                  reinterpret_cast<unsigned char *>(colorImage.pixels[y].data()),
+                  grayImage.width);
   }
 
-  // Draw red rectangle boundaries
-  for (const auto &rect : rectangles) {
-    std::vector<Point> corners = GenerateRectangleCorners(rect);
+  ColorImageCanvas canvas{colorImage};
+  DrawShapes(canvas, rectangles, {}, obloids);
 
-    for (size_t i = 0; i < 4; ++i) {
-      Point p1 = corners[i];
-      Point p2 = corners[(i + 1) % 4];
+  return colorImage;
+}
 
-      DrawThickColorLine(colorImage, p1, p2, ColorPixel(255, 0, 0), 4);
-    }
-  }
+RgbImage ImageProcessor::CreateRgbImage(const Image &grayImage,
+                                        const std::vector<Rectangle> &rectangles,
+                                        const std::vector<Sphere> &spheres,
+                                        const std::vector<Obloid> &obloids) {
+  RgbImage rgbImage(grayImage.width, grayImage.height);
+  RgbView view = rgbImage.View();
 
-  // Draw sphere boundaries
-  DrawSpheres(colorImage, spheres);
+  ExpandGrayToRgb(grayImage, view);
+  DrawOverlay(view, rectangles, spheres, obloids);
 
-  return colorImage;
+  return rgbImage;
+}
+
+void ImageProcessor::ExpandGrayToRgb(const Image &grayImage,
+                                     const RgbView &target) {
+  const int width = std::min(grayImage.width, target.width);
+  const int height = std::min(grayImage.height, target.height);
+
+#pragma omp parallel for
+  for (int y = 0; y < height; ++y) {
+    ExpandGrayRow(grayImage.pixels[y].data(),
+                  target.data + static_cast<size_t>(y) * target.stride, width);
+  }
+}
+
+void ImageProcessor::DrawOverlay(const RgbView &target,
+                                 const std::vector<Rectangle> &rectangles,
+                                 const std::vector<Sphere> &spheres,
+                                 const std::vector<Obloid> &obloids) {
+  RgbViewCanvas canvas{target};
+  DrawShapes(canvas, rectangles, spheres, obloids);
 }
 
 void ImageProcessor::DrawSpheres(ColorImage &image,
                                  const std::vector<Sphere> &spheres) {
-  for (const auto &sphere : spheres) {
-    // Draw sphere boundary in blue with thick lines
-    DrawThickColorCircle(image, sphere.center.x, sphere.center.y, sphere.radius,
-                         ColorPixel(0, 0, 255), 4);
+  ColorImageCanvas canvas{image};
+  DrawShapes(canvas, {}, spheres, {});
+}
+
+void ImageProcessor::DrawObloids(ColorImage &image,
+                                 const std::vector<Obloid> &obloids) {
+  ColorImageCanvas canvas{image};
+  DrawShapes(canvas, {}, {}, obloids);
+}
+
+void ImageProcessor::DrawRectangles(Overlay &overlay,
+                                    const std::vector<Rectangle> &rectangles) {
+  OverlayCanvas canvas{overlay};
+  DrawShapes(canvas, rectangles, {}, {});
+}
+
+void ImageProcessor::DrawSpheres(Overlay &overlay,
+                                 const std::vector<Sphere> &spheres) {
+  OverlayCanvas canvas{overlay};
+  DrawShapes(canvas, {}, spheres, {});
+}
+
+void ImageProcessor::DrawObloids(Overlay &overlay,
+                                 const std::vector<Obloid> &obloids) {
+  OverlayCanvas canvas{overlay};
+  DrawShapes(canvas, {}, {}, obloids);
+}
+
+RegionOfInterest ImageProcessor::ClipRegion(const RegionOfInterest &region,
+                                            int width, int height) {
+  int x1 = Clamp(region.x, 0, width);
+  int y1 = Clamp(region.y, 0, height);
+  int x2 = Clamp(region.x + std::max(0, region.width), 0, width);
+  int y2 = Clamp(region.y + std::max(0, region.height), 0, height);
+  return {x1, y1, x2 - x1, y2 - y1};
+}
+
+Image ImageProcessor::ExtractRegion(const Image &image,
+                                    const RegionOfInterest &region) {
+  RegionOfInterest clipped = ClipRegion(region, image.width, image.height);
+  Image result(clipped.width, clipped.height);
+
+  // Copy only the rows and columns covered by the region
+  for (int y = 0; y < clipped.height; ++y) {
+    const auto &src = image.pixels[clipped.y + y];
+    std::copy(src.begin() + clipped.x, src.begin() + clipped.x + clipped.width,
+              result.pixels[y].begin());
   }
+
+  return result;
 }
 
 Image ImageProcessor::ApplyThreshold(const Image &image, int threshold) {
@@ -247,35 +635,8 @@ void ImageProcessor::DrawRectangles(Image &image,
 
 std::vector<Point>
 ImageProcessor::GenerateRectangleCorners(const Rectangle &rect) {
-  std::vector<Point> corners;
-
-  // rect.angle is already in radians
-  double cosAngle = std::cos(rect.angle);
-  double sinAngle = std::sin(rect.angle);
-
-  // Half dimensions
-  double halfW = rect.width / 2.0;
-  double halfH = rect.height / 2.0;
-
-  // Generate 4 corners relative to center
-  std::vector<std::pair<double, double>> relativeCorners = {
-      {-halfW, -halfH}, // Top-left
-      {halfW, -halfH},  // Top-right
-      {halfW, halfH},   // Bottom-right
-      {-halfW, halfH}   // Bottom-left
-  };
-
-  // Rotate and translate to world coordinates
-  for (const auto &corner : relativeCorners) {
-    double rotatedX =
-        corner.first * cosAngle - corner.second * sinAngle + rect.center.x;
-    double rotatedY =
-        corner.first * sinAngle + corner.second * cosAngle + rect.center.y;
-    corners.push_back(
-        Point(static_cast<int>(rotatedX), static_cast<int>(rotatedY)));
-  }
-
-  return corners;
+  const std::array<Point, 4> corners = RectangleCorners(rect);
+  return {corners.begin(), corners.end()};
 }
 
 std::vector<Point>
@@ -341,119 +702,24 @@ void ImageProcessor::DrawLine(Image &image, const Point &p1, const Point &p2) {
 
 void ImageProcessor::DrawColorLine(ColorImage &image, const Point &p1,
                                    const Point &p2, const ColorPixel &color) {
-  // Bresenham's line algorithm for color images
-  int dx = std::abs(p2.x - p1.x);
-  int dy = std::abs(p2.y - p1.y);
-  int sx = (p1.x < p2.x) ? 1 : -1;
-  int sy = (p1.y < p2.y) ? 1 : -1;
-  int err = dx - dy;
-
-  int x = p1.x, y = p1.y;
-
-  while (true) {
-    if (x >= 0 && x < image.width && y >= 0 && y < image.height) {
-      image.pixels[y][x] = color;
-    }
-
-    if (x == p2.x && y == p2.y)
-      break;
-
-    int e2 = 2 * err;
-    if (e2 > -dy) {
-      err -= dy;
-      x += sx;
-    }
-    if (e2 < dx) {
-      err += dx;
-      y += sy;
-    }
-  }
+  ColorImageCanvas canvas{image};
+  PlotLine(canvas, p1, p2, color);
 }
 
 void ImageProcessor::DrawThickColorLine(ColorImage &image, const Point &p1,
                                         const Point &p2,
                                         const ColorPixel &color,
                                         int thickness) {
-  // Draw multiple parallel lines to create thickness
-  int halfThickness = thickness / 2;
-
-  // Calculate line direction vector
-  int dx = p2.x - p1.x;
-  int dy = p2.y - p1.y;
-  double length = std::sqrt(dx * dx + dy * dy);
-
-  if (length == 0) {
-    // Single point, draw a thick point
-    for (int offsetY = -halfThickness; offsetY <= halfThickness; ++offsetY) {
-      for (int offsetX = -halfThickness; offsetX <= halfThickness; ++offsetX) {
-        int x = p1.x + offsetX;
-        int y = p1.y + offsetY;
-        if (x >= 0 && x < image.width && y >= 0 && y < image.height) {
-          image.pixels[y][x] = color;
-        }
-      }
-    }
-    return;
-  }
-
-  // Normalized perpendicular vector
-  double perpX = -dy / length;
-  double perpY = dx / length;
-
-  // Draw parallel lines
-  for (int offset = -halfThickness; offset <= halfThickness; ++offset) {
-    Point newP1, newP2;
-    newP1.x = static_cast<int>(p1.x + offset * perpX);
-    newP1.y = static_cast<int>(p1.y + offset * perpY);
-    newP2.x = static_cast<int>(p2.x + offset * perpX);
-    newP2.y = static_cast<int>(p2.y + offset * perpY);
-
-    DrawColorLine(image, newP1, newP2, color);
-  }
+  ColorImageCanvas canvas{image};
+  PlotThickLine(canvas, p1, p2, color, thickness);
 }
 
-void ImageProcessor::DrawThickColorCircle(ColorImage &image, int centerX, int centerY,
-                                          int radius, const ColorPixel &color,
+void ImageProcessor::DrawThickColorCircle(ColorImage &image, int centerX,
+                                          int centerY, int radius,
+                                          const ColorPixel &color,
                                           int thickness) {
-  int halfThickness = thickness / 2;
-  
-  // Draw multiple concentric circles to create thickness
-  for (int t = -halfThickness; t <= halfThickness; ++t) {
-    int r = radius + t;
-    if (r <= 0) continue;
-    
-    // Bresenham's circle algorithm for each thickness layer
-    int x = r;
-    int y = 0;
-    int err = 0;
-
-    while (x >= y) {
-      // Draw 8 octants
-      auto setPixel = [&](int px, int py) {
-        if (px >= 0 && px < image.width && py >= 0 && py < image.height) {
-          image.pixels[py][px] = color;
-        }
-      };
-
-      setPixel(centerX + x, centerY + y);
-      setPixel(centerX + y, centerY + x);
-      setPixel(centerX - y, centerY + x);
-      setPixel(centerX - x, centerY + y);
-      setPixel(centerX - x, centerY - y);
-      setPixel(centerX - y, centerY - x);
-      setPixel(centerX + y, centerY - x);
-      setPixel(centerX + x, centerY - y);
-
-      if (err <= 0) {
-        y += 1;
-        err += 2 * y + 1;
-      }
-      if (err > 0) {
-        x -= 1;
-        err -= 2 * x + 1;
-      }
-    }
-  }
+  ColorImageCanvas canvas{image};
+  PlotThickCircle(canvas, centerX, centerY, radius, color, thickness);
 }
 
 Image ImageProcessor::CreateTestImage(int width, int height) {
@@ -582,49 +848,17 @@ void ImageProcessor::FillRotatedRectangle(
   if (corners.size() != 4)
     return;
 
-  // Find bounding box
-  int minX = corners[0].first, maxX = corners[0].first;
-  int minY = corners[0].second, maxY = corners[0].second;
-
-  for (const auto &corner : corners) {
-    minX = std::min(minX, corner.first);
-    maxX = std::max(maxX, corner.first);
-    minY = std::min(minY, corner.second);
-    maxY = std::max(maxY, corner.second);
-  }
-
-  // Ensure bounds are within image
-  minX = std::max(0, minX);
-  minY = std::max(0, minY);
-  maxX = std::min(image.width - 1, maxX);
-  maxY = std::min(image.height - 1, maxY);
-
-  // For each point in bounding box, check if it's inside the rectangle
-#pragma omp parallel for
-  for (int y = minY; y <= maxY; ++y) {
-    for (int x = minX; x <= maxX; ++x) {
-      if (IsPointInPolygon(x, y, corners)) {
-        image.pixels[y][x] = 255;
-      }
-    }
-  }
-}
+  const std::pair<double, double> quad[4] = {
+      {corners[0].first, corners[0].second},
+      {corners[1].first, corners[1].second},
+      {corners[2].first, corners[2].second},
+      {corners[3].first, corners[3].second}};
 
-bool ImageProcessor::IsPointInPolygon(
-    int x, int y, const std::vector<std::pair<int, int>> &polygon) {
-  int n = polygon.size();
-  bool inside = false;
+  // Scanline fill: one contiguous run per row instead of a per-pixel test
+  std::vector<Span> &spans = SpanScratch();
+  Rasterizer::ConvexPolygon(quad, 4, image.width, image.height, spans);
 
-  for (int i = 0, j = n - 1; i < n; j = i++) {
-    int xi = polygon[i].first, yi = polygon[i].second;
-    int xj = polygon[j].first, yj = polygon[j].second;
-
-    if (((yi > y) != (yj > y)) && (x < (xj - xi) * (y - yi) / (yj - yi) + xi)) {
-      inside = !inside;
-    }
-  }
-
-  return inside;
+  Rasterizer::FillSpans(image, spans, 255);
 }
 
 std::vector<std::vector<double>>
@@ -699,18 +933,11 @@ void ImageProcessor::DrawCircle(Image &image, int centerX, int centerY,
 
 void ImageProcessor::DrawFilledCircle(Image &image, int centerX, int centerY,
                                       int radius, int color) {
-#pragma omp parallel for
-  for (int y = -radius; y <= radius; y++) {
-    for (int x = -radius; x <= radius; x++) {
-      if (x * x + y * y <= radius * radius) {
-        int px = centerX + x;
-        int py = centerY + y;
-        if (px >= 0 && px < image.width && py >= 0 && py < image.height) {
-          image.pixels[py][px] = color;
-        }
-      }
-    }
-  }
+  std::vector<Span> &spans = SpanScratch();
+  Rasterizer::FilledCircle(centerX, centerY, radius, image.width, image.height,
+                           spans);
+
+  Rasterizer::FillSpans(image, spans, color);
 }
 
 void ImageProcessor::DrawTriangle(Image &image, const Point &p1,
@@ -723,97 +950,35 @@ void ImageProcessor::DrawTriangle(Image &image, const Point &p1,
 void ImageProcessor::DrawFilledTriangle(Image &image, const Point &p1,
                                         const Point &p2, const Point &p3,
                                         int color) {
-  // Get bounding box
-  int minX = std::min(std::min(p1.x, p2.x), p3.x);
-  int maxX = std::max(std::max(p1.x, p2.x), p3.x);
-  int minY = std::min(std::min(p1.y, p2.y), p3.y);
-  int maxY = std::max(std::max(p1.y, p2.y), p3.y);
-
-  // Clamp to image bounds
-  minX = Clamp(minX, 0, image.width - 1);
-  maxX = Clamp(maxX, 0, image.width - 1);
-  minY = Clamp(minY, 0, image.height - 1);
-  maxY = Clamp(maxY, 0, image.height - 1);
-
-  // Barycentric coordinates
-#pragma omp parallel for
-  for (int y = minY; y <= maxY; y++) {
-    for (int x = minX; x <= maxX; x++) {
-      // Calculate barycentric coordinates
-      double denominator =
-          ((p2.y - p3.y) * (p1.x - p3.x) + (p3.x - p2.x) * (p1.y - p3.y));
-      if (std::abs(denominator) < 1e-10)
-        continue;
-
-      double a = ((p2.y - p3.y) * (x - p3.x) + (p3.x - p2.x) * (y - p3.y)) /
-                 denominator;
-      double b = ((p3.y - p1.y) * (x - p3.x) + (p1.x - p3.x) * (y - p3.y)) /
-                 denominator;
-      double c = 1 - a - b;
-
-      // Check if point is inside triangle
-      if (a >= 0 && b >= 0 && c >= 0) {
-        image.pixels[y][x] = color;
-      }
-    }
-  }
+  const std::pair<double, double> triangle[3] = {
+      {p1.x, p1.y}, {p2.x, p2.y}, {p3.x, p3.y}};
+
+  std::vector<Span> &spans = SpanScratch();
+  Rasterizer::ConvexPolygon(triangle, 3, image.width, image.height, spans);
+
+  Rasterizer::FillSpans(image, spans, color);
 }
 
 void ImageProcessor::DrawEllipse(Image &image, int centerX, int centerY,
                                  int radiusX, int radiusY, double angle,
                                  int color) {
-  // angle is in radians
-  double cosA = std::cos(angle);
-  double sinA = std::sin(angle);
-
-  // Draw ellipse using parametric form
-  for (double t = 0; t < 2 * M_PI; t += 0.01) {
-    double x = radiusX * std::cos(t);
-    double y = radiusY * std::sin(t);
-
-    // Rotate
-    double rotX = x * cosA - y * sinA;
-    double rotY = x * sinA + y * cosA;
+  // One pixel wide band around the boundary, solved per row rather than
+  // sampled parametrically
+  std::vector<Span> &spans = SpanScratch();
+  Rasterizer::EllipseRing(centerX, centerY, radiusX, radiusY, angle, 1.0,
+                          image.width, image.height, spans);
 
-    // Translate
-    int px = static_cast<int>(centerX + rotX);
-    int py = static_cast<int>(centerY + rotY);
-
-    if (px >= 0 && px < image.width && py >= 0 && py < image.height) {
-      image.pixels[py][px] = color;
-    }
-  }
+  Rasterizer::FillSpans(image, spans, color);
 }
 
 void ImageProcessor::DrawFilledEllipse(Image &image, int centerX, int centerY,
                                        int radiusX, int radiusY, double angle,
                                        int color) {
-  // angle is in radians
-  double cosA = std::cos(angle);
-  double sinA = std::sin(angle);
+  std::vector<Span> &spans = SpanScratch();
+  Rasterizer::FilledEllipse(centerX, centerY, radiusX, radiusY, angle,
+                            image.width, image.height, spans);
 
-  // Get bounding box
-  int maxRadius = std::max(radiusX, radiusY);
-
-#pragma omp parallel for
-  for (int y = -maxRadius; y <= maxRadius; y++) {
-    for (int x = -maxRadius; x <= maxRadius; x++) {
-      // Reverse rotate the point
-      double rotX = x * cosA + y * sinA;
-      double rotY = -x * sinA + y * cosA;
-
-      // Check if point is inside ellipse
-      if ((rotX * rotX) / (radiusX * radiusX) +
-              (rotY * rotY) / (radiusY * radiusY) <=
-          1.0) {
-        int px = centerX + x;
-        int py = centerY + y;
-        if (px >= 0 && px < image.width && py >= 0 && py < image.height) {
-          image.pixels[py][px] = color;
-        }
-      }
-    }
-  }
+  Rasterizer::FillSpans(image, spans, color);
 }
 
 Image ImageProcessor::CreateTestImageWithMixedShapes(int width, int height) {
@@ -0,0 +1,318 @@
+#include "ShapeDetector/Kernels.hpp"
+
+namespace {
+
+int ClampIndex(int index, int size) {
+  return std::max(0, std::min(index, size - 1));
+}
+
+template <int Size>
+void ConvolveRows(const Image &image, Image &output,
+                  const std::array<double, Size> &weights) {
+  constexpr int half = Size / 2;
+  const int width = image.width;
+#pragma omp parallel for
+  for (int y = 0; y < image.height; ++y) {
+    const int *row = image.pixels[y].data();
+    int *out = output.pixels[y].data();
+
+    auto clamped = [&](int x) {
+      double value = 0.0;
+      Kernels::Unroll<Size>([&](auto k) {
+        value += row[ClampIndex(x + k - half, width)] * weights[k];
+      });
+      out[x] = Kernels::RoundPixel(value);
+    };
+
+    const int interiorEnd = std::max(half, width - half);
+    for (int x = 0; x < std::min(half, width); ++x)
+      clamped(x);
+#pragma omp simd
+    for (int x = half; x < width - half; ++x)
+      out[x] = Kernels::RoundPixel(Kernels::RowTaps<Size>(row, x, weights));
+    for (int x = interiorEnd; x < width; ++x)
+      clamped(x);
+  }
+}
+
+template <int Size>
+void ConvolveColumns(const Image &image, Image &output,
+                     const std::array<double, Size> &weights) {
+  constexpr int half = Size / 2;
+#pragma omp parallel for
+  for (int y = 0; y < image.height; ++y) {
+    std::array<const int *, Size> rows;
+    Kernels::Unroll<Size>([&](auto k) {
+      rows[k] = image.pixels[ClampIndex(y + k - half, image.height)].data();
+    });
+    int *out = output.pixels[y].data();
+#pragma omp simd
+    for (int x = 0; x < image.width; ++x)
+      out[x] = Kernels::RoundPixel(Kernels::ColumnTaps<Size>(rows, x, weights));
+  }
+}
+
+template <int Size, bool Maximum>
+void Extremum(const Image &image, Image &output) {
+  constexpr int half = Size / 2;
+#pragma omp parallel for
+  for (int y = half; y < image.height - half; ++y) {
+    std::array<const int *, Size> rows;
+    Kernels::Unroll<Size>(
+        [&](auto dy) { rows[dy] = image.pixels[y + dy - half].data(); });
+    int *out = output.pixels[y].data();
+#pragma omp simd
+    for (int x = half; x < image.width - half; ++x)
+      out[x] = Kernels::WindowExtremum<Size, Maximum>(rows, x);
+  }
+}
+
+void Extremum(const Image &image, Image &output, int size, bool maximum) {
+  const int half = size / 2;
+#pragma omp parallel for
+  for (int y = half; y < image.height - half; ++y) {
+    for (int x = half; x < image.width - half; ++x) {
+      int value = maximum ? 0 : 255;
+      for (int dy = -half; dy <= half; ++dy) {
+        for (int dx = -half; dx <= half; ++dx) {
+          const int pixel = image.pixels[y + dy][x + dx];
+          value = maximum ? std::max(value, pixel) : std::min(value, pixel);
+        }
+      }
+      output.pixels[y][x] = value;
+    }
+  }
+}
+
+} // namespace
+
+std::vector<double> Kernels::GaussianWeights(double sigma) {
+  const int size = GaussianSize(sigma);
+  std::vector<double> weights(size);
+  double sum = 0.0;
+  for (int i = 0; i < size; ++i) {
+    const int x = i - size / 2;
+    weights[i] = Exp(-(x * x) / (2.0 * sigma * sigma));
+    sum += weights[i];
+  }
+  for (double &weight : weights)
+    weight /= sum;
+  return weights;
+}
+
+Image Kernels::GaussianBlur(const Image &image, double sigma) {
+  switch (GaussianSize(sigma)) {
+  case 3:
+    return Convolve<3>(image, GaussianWeights<3>(sigma));
+  case 5:
+    return Convolve<5>(image, GaussianWeights<5>(sigma));
+  case 7:
+    return Convolve<7>(image, GaussianWeights<7>(sigma));
+  default:
+    return Convolve(image, GaussianWeights(sigma));
+  }
+}
+
+template <int Size>
+  requires UnrolledKernelSize<Size>
+Image Kernels::Convolve(const Image &image,
+                        const std::array<double, Size> &weights) {
+  Image temp(image.width, image.height);
+  Image result(image.width, image.height);
+  ConvolveRows<Size>(image, temp, weights);
+  ConvolveColumns<Size>(temp, result, weights);
+  return result;
+}
+
+Image Kernels::Convolve(const Image &image,
+                        const std::vector<double> &weights) {
+  const int size = static_cast<int>(weights.size());
+  const int half = size / 2;
+  Image temp(image.width, image.height);
+  Image result(image.width, image.height);
+
+#pragma omp parallel for
+  for (int y = 0; y < image.height; ++y) {
+    for (int x = 0; x < image.width; ++x) {
+      double value = 0.0;
+      for (int k = 0; k < size; ++k) {
+        value +=
+            image.pixels[y][ClampIndex(x + k - half, image.width)] * weights[k];
+      }
+      temp.pixels[y][x] = RoundPixel(value);
+    }
+  }
+
+#pragma omp parallel for
+  for (int y = 0; y < image.height; ++y) {
+    for (int x = 0; x < image.width; ++x) {
+      double value = 0.0;
+      for (int k = 0; k < size; ++k) {
+        value +=
+            temp.pixels[ClampIndex(y + k - half, image.height)][x] * weights[k];
+      }
+      result.pixels[y][x] = RoundPixel(value);
+    }
+  }
+
+  return result;
+}
+
+template <int Size>
+  requires UnrolledKernelSize<Size>
+void Kernels::Dilate(const Image &image, Image &output) {
+  Extremum<Size, true>(image, output);
+}
+
+template <int Size>
+  requires UnrolledKernelSize<Size>
+void Kernels::Erode(const Image &image, Image &output) {
+  Extremum<Size, false>(image, output);
+}
+
+void Kernels::Dilate(const Image &image, Image &output, int size) {
+  switch (size) {
+  case 3:
+    return Dilate<3>(image, output);
+  case 5:
+    return Dilate<5>(image, output);
+  case 7:
+    return Dilate<7>(image, output);
+  default:
+    return Extremum(image, output, size, true);
+  }
+}
+
+void Kernels::Erode(const Image &image, Image &output, int size) {
+  switch (size) {
+  case 3:
+    return Erode<3>(image, output);
+  case 5:
+    return Erode<5>(image, output);
+  case 7:
+    return Erode<7>(image, output);
+  default:
+    return Extremum(image, output, size, false);
+  }
+}
+
+template <int Size>
+  requires UnrolledKernelSize<Size>
+void Kernels::Median(const Image &image, Image &output) {
+  constexpr int half = Size / 2;
+#pragma omp parallel for
+  for (int y = half; y < image.height - half; ++y) {
+    std::array<const int *, Size> rows;
+    Unroll<Size>(
+        [&](auto dy) { rows[dy] = image.pixels[y + dy - half].data(); });
+    int *out = output.pixels[y].data();
+    if constexpr (Size == 3) {
+      // The exchange network vectorizes; nth_element does not
+#pragma omp simd
+      for (int x = 1; x < image.width - 1; ++x)
+        out[x] = WindowMedian<Size>(rows, x);
+    } else {
+      for (int x = half; x < image.width - half; ++x)
+        out[x] = WindowMedian<Size>(rows, x);
+    }
+  }
+}
+
+void Kernels::Median(const Image &image, Image &output, int size) {
+  switch (size) {
+  case 3:
+    return Median<3>(image, output);
+  case 5:
+    return Median<5>(image, output);
+  case 7:
+    return Median<7>(image, output);
+  default:
+    break;
+  }
+
+  const int half = size / 2;
+#pragma omp parallel for
+  for (int y = half; y < image.height - half; ++y) {
+    std::vector<int> values(size * size);
+    for (int x = half; x < image.width - half; ++x) {
+      int count = 0;
+      for (int dy = -half; dy <= half; ++dy) {
+        for (int dx = -half; dx <= half; ++dx) {
+          values[count++] = image.pixels[y + dy][x + dx];
+        }
+      }
+      std::nth_element(values.begin(), values.begin() + count / 2,
+                       values.end());
+      output.pixels[y][x] = values[count / 2];
+    }
+  }
+}
+
+template <int Size>
+  requires UnrolledKernelSize<Size>
+void Kernels::RangeMean(const Image &image, Image &output, int range) {
+  constexpr int half = Size / 2;
+#pragma omp parallel for
+  for (int y = half; y < image.height - half; ++y) {
+    std::array<const int *, Size> rows;
+    Unroll<Size>(
+        [&](auto dy) { rows[dy] = image.pixels[y + dy - half].data(); });
+    int *out = output.pixels[y].data();
+#pragma omp simd
+    for (int x = half; x < image.width - half; ++x)
+      out[x] = WindowRangeMean<Size>(rows, x, range);
+  }
+}
+
+void Kernels::RangeMean(const Image &image, Image &output, int size,
+                        int range) {
+  switch (size) {
+  case 3:
+    return RangeMean<3>(image, output, range);
+  case 5:
+    return RangeMean<5>(image, output, range);
+  case 7:
+    return RangeMean<7>(image, output, range);
+  default:
+    break;
+  }
+
+  const int half = size / 2;
+#pragma omp parallel for
+  for (int y = half; y < image.height - half; ++y) {
+    for (int x = half; x < image.width - half; ++x) {
+      const int center = image.pixels[y][x];
+      int sum = 0;
+      int count = 0;
+      for (int dy = -half; dy <= half; ++dy) {
+        for (int dx = -half; dx <= half; ++dx) {
+          const int pixel = image.pixels[y + dy][x + dx];
+          if (std::abs(pixel - center) < range) {
+            sum += pixel;
+            count++;
+          }
+        }
+      }
+      output.pixels[y][x] = count > 0 ? sum / count : center;
+    }
+  }
+}
+
+template Image Kernels::Convolve<3>(const Image &,
+                                    const std::array<double, 3> &);
+template Image Kernels::Convolve<5>(const Image &,
+                                    const std::array<double, 5> &);
+template Image Kernels::Convolve<7>(const Image &,
+                                    const std::array<double, 7> &);
+template void Kernels::Dilate<3>(const Image &, Image &);
+template void Kernels::Erode<3>(const Image &, Image &);
+template void Kernels::Median<3>(const Image &, Image &);
+template void Kernels::RangeMean<3>(const Image &, Image &, int);
+template void Kernels::Dilate<5>(const Image &, Image &);
+template void Kernels::Erode<5>(const Image &, Image &);
+template void Kernels::Median<5>(const Image &, Image &);
+template void Kernels::RangeMean<5>(const Image &, Image &, int);
+template void Kernels::Dilate<7>(const Image &, Image &);
+template void Kernels::Erode<7>(const Image &, Image &);
+template void Kernels::Median<7>(const Image &, Image &);
+template void Kernels::RangeMean<7>(const Image &, Image &, int);
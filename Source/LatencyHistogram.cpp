@@ -0,0 +1,246 @@
+#include "ShapeDetector/LatencyHistogram.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+LatencyHistogram::LatencyHistogram(int64_t lowestTrackable,
+                                   int64_t highestTrackable,
+                                   int significantDigits)
+    : lowestTrackable_(std::max<int64_t>(1, lowestTrackable)),
+      highestTrackable_(std::max(highestTrackable, 2 * lowestTrackable_)),
+      significantDigits_(std::clamp(significantDigits, 1, 5)) {
+  // Enough linear sub-buckets that adjacent values differ by at most one
+  // unit in the last significant digit
+  const int64_t largestSingleUnitValue =
+      2 * static_cast<int64_t>(std::pow(10, significantDigits_));
+  const int subBucketCountMagnitude = static_cast<int>(
+      std::ceil(std::log2(static_cast<double>(largestSingleUnitValue))));
+
+  unitMagnitude_ = std::bit_width(static_cast<uint64_t>(lowestTrackable_)) - 1;
+  subBucketHalfCountMagnitude_ = std::max(subBucketCountMagnitude, 1) - 1;
+  subBucketCount_ = int64_t(1) << (subBucketHalfCountMagnitude_ + 1);
+  subBucketHalfCount_ = subBucketCount_ / 2;
+  subBucketMask_ = (subBucketCount_ - 1) << unitMagnitude_;
+
+  // Each further bucket doubles the covered range
+  int64_t smallestUntrackable = subBucketCount_ << unitMagnitude_;
+  bucketCount_ = 1;
+  while (smallestUntrackable <= highestTrackable_) {
+    if (smallestUntrackable > std::numeric_limits<int64_t>::max() / 2) {
+      ++bucketCount_;
+      break;
+    }
+    smallestUntrackable <<= 1;
+    ++bucketCount_;
+  }
+  counts_.assign((bucketCount_ + 1) * subBucketHalfCount_, 0);
+}
+
+int LatencyHistogram::BucketIndex(int64_t value) const {
+  // Bucket 0 holds the full sub-bucket range, later ones the upper half
+  const int leadingZeroBase = 64 - unitMagnitude_ -
+                              (subBucketHalfCountMagnitude_ + 1);
+  return leadingZeroBase -
+         std::countl_zero(static_cast<uint64_t>(value | subBucketMask_));
+}
+
+int LatencyHistogram::SubBucketIndex(int64_t value, int bucketIndex) const {
+  return static_cast<int>(value >> (bucketIndex + unitMagnitude_));
+}
+
+size_t LatencyHistogram::CountsIndex(int64_t value) const {
+  const int bucket = BucketIndex(value);
+  const int subBucket = SubBucketIndex(value, bucket);
+  return (static_cast<size_t>(bucket + 1) << subBucketHalfCountMagnitude_) +
+         (subBucket - subBucketHalfCount_);
+}
+
+int64_t LatencyHistogram::ValueFromIndex(size_t index) const {
+  int bucket = static_cast<int>(index >> subBucketHalfCountMagnitude_) - 1;
+  int64_t subBucket =
+      static_cast<int64_t>(index & (subBucketHalfCount_ - 1)) +
+      subBucketHalfCount_;
+  if (bucket < 0) {
+    subBucket -= subBucketHalfCount_;
+    bucket = 0;
+  }
+  return subBucket << (bucket + unitMagnitude_);
+}
+
+int64_t LatencyHistogram::LowestEquivalentValue(int64_t value) const {
+  const int bucket = BucketIndex(value);
+  return static_cast<int64_t>(SubBucketIndex(value, bucket))
+         << (bucket + unitMagnitude_);
+}
+
+int64_t LatencyHistogram::HighestEquivalentValue(int64_t value) const {
+  const int bucket = BucketIndex(value);
+  const int subBucket = SubBucketIndex(value, bucket);
+  const int adjustedBucket = subBucket >= subBucketCount_ ? bucket + 1 : bucket;
+  const int64_t range = int64_t(1) << (unitMagnitude_ + adjustedBucket);
+  return LowestEquivalentValue(value) + range - 1;
+}
+
+void LatencyHistogram::Record(int64_t value, int64_t count) {
+  if (count <= 0)
+    return;
+  value = std::clamp(value, int64_t(0), highestTrackable_);
+  counts_[CountsIndex(value)] += count;
+  min_ = totalCount_ == 0 ? value : std::min(min_, value);
+  max_ = totalCount_ == 0 ? value : std::max(max_, value);
+  totalCount_ += count;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram &other) {
+  if (other.totalCount_ == 0)
+    return;
+  if (other.counts_.size() == counts_.size() &&
+      other.unitMagnitude_ == unitMagnitude_ &&
+      other.subBucketHalfCountMagnitude_ == subBucketHalfCountMagnitude_) {
+    for (size_t i = 0; i < counts_.size(); ++i)
+      counts_[i] += other.counts_[i];
+    min_ = totalCount_ == 0 ? other.min_ : std::min(min_, other.min_);
+    max_ = totalCount_ == 0 ? other.max_ : std::max(max_, other.max_);
+    totalCount_ += other.totalCount_;
+    return;
+  }
+
+  // Different layouts: re-record every populated bucket by its value
+  for (size_t i = 0; i < other.counts_.size(); ++i) {
+    if (other.counts_[i] != 0)
+      Record(other.ValueFromIndex(i), other.counts_[i]);
+  }
+}
+
+void LatencyHistogram::Reset() {
+  std::fill(counts_.begin(), counts_.end(), 0);
+  totalCount_ = min_ = max_ = 0;
+}
+
+int64_t LatencyHistogram::Min() const { return min_; }
+
+int64_t LatencyHistogram::Max() const { return max_; }
+
+double LatencyHistogram::Mean() const {
+  if (totalCount_ == 0)
+    return 0.0;
+  double sum = 0.0;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    if (counts_[i] == 0)
+      continue;
+    const int64_t value = ValueFromIndex(i);
+    const double median =
+        0.5 * (LowestEquivalentValue(value) + HighestEquivalentValue(value));
+    sum += median * counts_[i];
+  }
+  return sum / totalCount_;
+}
+
+double LatencyHistogram::StdDeviation() const {
+  if (totalCount_ == 0)
+    return 0.0;
+  const double mean = Mean();
+  double squares = 0.0;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    if (counts_[i] == 0)
+      continue;
+    const int64_t value = ValueFromIndex(i);
+    const double deviation =
+        0.5 * (LowestEquivalentValue(value) + HighestEquivalentValue(value)) -
+        mean;
+    squares += deviation * deviation * counts_[i];
+  }
+  return std::sqrt(squares / totalCount_);
+}
+
+int64_t LatencyHistogram::ValueAtPercentile(double percentile) const {
+  if (totalCount_ == 0)
+    return 0;
+  const double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+  const int64_t target = std::max<int64_t>(
+      1, static_cast<int64_t>(std::ceil(fraction * totalCount_)));
+
+  int64_t cumulative = 0;
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    cumulative += counts_[i];
+    if (cumulative >= target) {
+      const int64_t value = ValueFromIndex(i);
+      return percentile == 0.0
+                 ? LowestEquivalentValue(value)
+                 : std::min(HighestEquivalentValue(value), max_);
+    }
+  }
+  return max_;
+}
+
+void LatencyHistogram::WritePercentileDistribution(
+    std::ostream &out, double valueScale, int ticksPerHalfDistance) const {
+  const int digits = significantDigits_;
+  char line[160];
+  std::snprintf(line, sizeof(line), "%12s %14s %10s %14s\n\n", "Value",
+                "Percentile", "TotalCount", "1/(1-Percentile)");
+  out << line;
+
+  // Reporting levels get denser towards 100%: ticksPerHalfDistance steps
+  // to 50%, as many again to 75%, to 87.5% and so on
+  double level = 0.0;
+  int64_t cumulative = 0;
+  int64_t lastValue = 0;
+  for (size_t i = 0; i < counts_.size() && cumulative < totalCount_; ++i) {
+    if (counts_[i] == 0)
+      continue;
+    cumulative += counts_[i];
+    lastValue = HighestEquivalentValue(ValueFromIndex(i));
+
+    while (100.0 * cumulative / totalCount_ >= level) {
+      std::snprintf(line, sizeof(line), "%12.*f %2.12f %10lld %14.2f\n",
+                    digits, lastValue / valueScale, level / 100.0,
+                    static_cast<long long>(cumulative),
+                    1.0 / (1.0 - level / 100.0));
+      out << line;
+
+      const int halvings =
+          static_cast<int>(std::log2(100.0 / (100.0 - level)));
+      const double ticks =
+          ticksPerHalfDistance * std::ldexp(1.0, halvings + 1);
+      level += 100.0 / ticks;
+      if (cumulative == totalCount_)
+        break;
+    }
+  }
+
+  if (totalCount_ > 0) {
+    std::snprintf(line, sizeof(line), "%12.*f %2.12f %10lld\n", digits,
+                  lastValue / valueScale, 1.0,
+                  static_cast<long long>(totalCount_));
+    out << line;
+  }
+
+  std::snprintf(line, sizeof(line),
+                "#[Mean    = %12.*f, StdDeviation   = %12.*f]\n", digits,
+                Mean() / valueScale, digits, StdDeviation() / valueScale);
+  out << line;
+  std::snprintf(line, sizeof(line),
+                "#[Max     = %12.*f, Total count    = %12lld]\n", digits,
+                max_ / valueScale, static_cast<long long>(totalCount_));
+  out << line;
+  std::snprintf(line, sizeof(line),
+                "#[Buckets = %12d, SubBuckets     = %12lld]\n", bucketCount_,
+                static_cast<long long>(subBucketCount_));
+  out << line;
+}
+
+bool LatencyHistogram::WritePercentileDistribution(const std::string &path,
+                                                   double valueScale) const {
+  std::ofstream file(path);
+  if (!file) {
+    std::cerr << "Error: Cannot write " << path << std::endl;
+    return false;
+  }
+  WritePercentileDistribution(file, valueScale);
+  return true;
+}
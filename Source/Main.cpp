@@ -53,12 +53,13 @@ void processImage(RectangleDetector &detector, SphereDetector &sphereDetector,
     std::cout << "\n";
   }
 
-  std::cout << "Creating color output image with detected shapes...\n";
-  ColorImage outputImage =
-      ImageProcessor::CreateColorImageWithSpheres(testImage, rectangles, spheres);
+  std::cout << "Drawing detected shapes...\n";
+  Overlay overlay(testImage.width, testImage.height);
+  ImageProcessor::DrawRectangles(overlay, rectangles);
+  ImageProcessor::DrawSpheres(overlay, spheres);
 
   std::cout << "Saving output image...\n";
-  ImageProcessor::SavePNGImage(outputImage, "Output/Images/output.png");
+  ImageProcessor::SavePNGImage(testImage, overlay, "Output/Images/output.png");
 
   std::cout
       << "Processing complete! Output saved as: Output/Images/output.png\n";
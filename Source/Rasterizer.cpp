@@ -0,0 +1,276 @@
+#include "ShapeDetector/Rasterizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+constexpr double EDGE_EPSILON = 1e-9;
+constexpr int MAX_POLYGON_EDGES = 16;
+
+namespace {
+
+// Non-horizontal polygon edge prepared for incremental scanline evaluation
+struct Edge {
+  double yLow, yHigh;
+  double xAtLow;
+  double inverseSlope; // dx/dy, so no division happens per row
+};
+
+void EmitSpan(double left, double right, int y, int width,
+              std::vector<Span> &spans) {
+  int x1 = static_cast<int>(std::ceil(left - EDGE_EPSILON));
+  int x2 = static_cast<int>(std::floor(right + EDGE_EPSILON));
+  x1 = std::max(x1, 0);
+  x2 = std::min(x2, width - 1);
+  if (x1 <= x2) {
+    spans.push_back({y, x1, x2});
+  }
+}
+
+// Rotated ellipse written as A x^2 + B y x + C y^2 <= 1 so that each row
+// reduces to a quadratic in x with one square root
+struct EllipseRows {
+  double a, b, c;
+  double halfHeight;
+  bool valid;
+
+  EllipseRows(double radiusX, double radiusY, double cosAngle,
+              double sinAngle) {
+    valid = radiusX > 0.0 && radiusY > 0.0;
+    if (!valid) {
+      a = b = c = halfHeight = 0.0;
+      return;
+    }
+    const double invX = 1.0 / (radiusX * radiusX);
+    const double invY = 1.0 / (radiusY * radiusY);
+    a = cosAngle * cosAngle * invX + sinAngle * sinAngle * invY;
+    b = 2.0 * cosAngle * sinAngle * (invX - invY);
+    c = sinAngle * sinAngle * invX + cosAngle * cosAngle * invY;
+    halfHeight = std::sqrt(radiusX * radiusX * sinAngle * sinAngle +
+                           radiusY * radiusY * cosAngle * cosAngle);
+  }
+
+  // Real x interval covered on row y (relative to the centre)
+  bool Interval(double y, double &x1, double &x2) const {
+    if (!valid)
+      return false;
+    const double by = b * y;
+    const double discriminant = by * by - 4.0 * a * (c * y * y - 1.0);
+    if (discriminant < 0.0)
+      return false;
+    const double root = std::sqrt(discriminant);
+    const double inv2a = 0.5 / a;
+    x1 = (-by - root) * inv2a;
+    x2 = (-by + root) * inv2a;
+    return true;
+  }
+};
+
+// Fill rows covered by the outer ellipse, minus the strict interior of the
+// inner one
+void RasterizeRing(int centerX, int centerY, const EllipseRows &outer,
+                   const EllipseRows &inner, int width, int height,
+                   std::vector<Span> &spans) {
+  if (!outer.valid || width <= 0 || height <= 0)
+    return;
+
+  const int yStart = std::max(
+      0, static_cast<int>(std::ceil(centerY - outer.halfHeight - EDGE_EPSILON)));
+  const int yEnd = std::min(
+      height - 1,
+      static_cast<int>(std::floor(centerY + outer.halfHeight + EDGE_EPSILON)));
+
+  for (int y = yStart; y <= yEnd; ++y) {
+    const double dy = y - centerY;
+    double outerLeft, outerRight;
+    if (!outer.Interval(dy, outerLeft, outerRight))
+      continue;
+
+    double innerLeft, innerRight;
+    if (!inner.Interval(dy, innerLeft, innerRight)) {
+      EmitSpan(centerX + outerLeft, centerX + outerRight, y, width, spans);
+      continue;
+    }
+
+    // Keep x <= innerLeft and x >= innerRight; merge if no pixel lies between
+    const int holeStart =
+        static_cast<int>(std::floor(centerX + innerLeft + EDGE_EPSILON)) + 1;
+    const int holeEnd =
+        static_cast<int>(std::ceil(centerX + innerRight - EDGE_EPSILON)) - 1;
+    if (holeStart > holeEnd) {
+      EmitSpan(centerX + outerLeft, centerX + outerRight, y, width, spans);
+      continue;
+    }
+    EmitSpan(centerX + outerLeft, holeStart - 1, y, width, spans);
+    EmitSpan(holeEnd + 1, centerX + outerRight, y, width, spans);
+  }
+}
+
+} // namespace
+
+void Rasterizer::ConvexPolygon(const std::pair<double, double> *vertices,
+                               int count, int width, int height,
+                               std::vector<Span> &spans) {
+  if (count < 1 || count > MAX_POLYGON_EDGES || width <= 0 || height <= 0)
+    return;
+
+  double minY = vertices[0].second, maxY = vertices[0].second;
+  double minX = vertices[0].first, maxX = vertices[0].first;
+  for (int i = 1; i < count; ++i) {
+    minY = std::min(minY, vertices[i].second);
+    maxY = std::max(maxY, vertices[i].second);
+    minX = std::min(minX, vertices[i].first);
+    maxX = std::max(maxX, vertices[i].first);
+  }
+
+  const int yStart =
+      std::max(0, static_cast<int>(std::ceil(minY - EDGE_EPSILON)));
+  const int yEnd =
+      std::min(height - 1, static_cast<int>(std::floor(maxY + EDGE_EPSILON)));
+  if (yStart > yEnd)
+    return;
+
+  // Degenerate polygon lying on a single row
+  if (maxY - minY < EDGE_EPSILON) {
+    EmitSpan(minX, maxX, yStart, width, spans);
+    return;
+  }
+
+  // Build the edge table once; horizontal edges are covered by their
+  // neighbours
+  Edge edges[MAX_POLYGON_EDGES];
+  int edgeCount = 0;
+  for (int i = 0, j = count - 1; i < count; j = i++) {
+    const auto &a = vertices[j];
+    const auto &b = vertices[i];
+    if (std::abs(a.second - b.second) < EDGE_EPSILON)
+      continue;
+
+    const auto &low = (a.second < b.second) ? a : b;
+    const auto &high = (a.second < b.second) ? b : a;
+    edges[edgeCount++] = {low.second, high.second, low.first,
+                          (high.first - low.first) / (high.second - low.second)};
+  }
+
+  // A convex polygon crosses each row in one span between its active edges
+  for (int y = yStart; y <= yEnd; ++y) {
+    double left = std::numeric_limits<double>::max();
+    double right = std::numeric_limits<double>::lowest();
+
+    for (int e = 0; e < edgeCount; ++e) {
+      const Edge &edge = edges[e];
+      if (y < edge.yLow - EDGE_EPSILON || y > edge.yHigh + EDGE_EPSILON)
+        continue;
+
+      const double x = edge.xAtLow + (y - edge.yLow) * edge.inverseSlope;
+      left = std::min(left, x);
+      right = std::max(right, x);
+    }
+
+    if (left <= right) {
+      EmitSpan(left, right, y, width, spans);
+    }
+  }
+}
+
+void Rasterizer::ThickLine(const Point &p1, const Point &p2, int thickness,
+                           int width, int height, std::vector<Span> &spans) {
+  // Half width chosen so a thickness of 2k covers 2k + 1 pixel centres
+  const double halfWidth = thickness / 2 + 0.5;
+
+  const double dx = p2.x - p1.x;
+  const double dy = p2.y - p1.y;
+  const double length = std::sqrt(dx * dx + dy * dy);
+
+  if (length < EDGE_EPSILON) {
+    // Single point, draw a thick square
+    const std::pair<double, double> square[4] = {
+        {p1.x - halfWidth, p1.y - halfWidth},
+        {p1.x + halfWidth, p1.y - halfWidth},
+        {p1.x + halfWidth, p1.y + halfWidth},
+        {p1.x - halfWidth, p1.y + halfWidth}};
+    ConvexPolygon(square, 4, width, height, spans);
+    return;
+  }
+
+  // Unit direction and normal, scaled by the half width
+  const double ux = dx / length * halfWidth;
+  const double uy = dy / length * halfWidth;
+  const double nx = -uy;
+  const double ny = ux;
+
+  // Square caps extend past both endpoints so polyline corners close
+  const std::pair<double, double> quad[4] = {
+      {p1.x - ux + nx, p1.y - uy + ny},
+      {p2.x + ux + nx, p2.y + uy + ny},
+      {p2.x + ux - nx, p2.y + uy - ny},
+      {p1.x - ux - nx, p1.y - uy - ny}};
+  ConvexPolygon(quad, 4, width, height, spans);
+}
+
+void Rasterizer::FilledCircle(int centerX, int centerY, int radius, int width,
+                              int height, std::vector<Span> &spans) {
+  if (radius < 0 || width <= 0 || height <= 0)
+    return;
+
+  const long long radiusSquared = static_cast<long long>(radius) * radius;
+  auto inside = [radiusSquared](long long x, long long y) {
+    return x * x + y * y <= radiusSquared;
+  };
+
+  // Midpoint walk in exact integer arithmetic: the half width grows over the
+  // upper half and shrinks over the lower half, so each row costs O(1)
+  // amortized and spans come out in row order
+  int halfWidth = 0;
+  for (int dy = -radius; dy <= radius; ++dy) {
+    if (dy <= 0) {
+      while (inside(halfWidth + 1, dy))
+        halfWidth++;
+    } else {
+      while (halfWidth > 0 && !inside(halfWidth, dy))
+        halfWidth--;
+    }
+
+    const int y = centerY + dy;
+    if (y >= 0 && y < height) {
+      EmitSpan(centerX - halfWidth, centerX + halfWidth, y, width, spans);
+    }
+  }
+}
+
+void Rasterizer::Annulus(int centerX, int centerY, double innerRadius,
+                         double outerRadius, int width, int height,
+                         std::vector<Span> &spans) {
+  RasterizeRing(centerX, centerY, EllipseRows(outerRadius, outerRadius, 1, 0),
+                EllipseRows(innerRadius, innerRadius, 1, 0), width, height,
+                spans);
+}
+
+void Rasterizer::FilledEllipse(int centerX, int centerY, double radiusX,
+                               double radiusY, double angle, int width,
+                               int height, std::vector<Span> &spans) {
+  const double cosAngle = std::cos(angle);
+  const double sinAngle = std::sin(angle);
+  RasterizeRing(centerX, centerY,
+                EllipseRows(radiusX, radiusY, cosAngle, sinAngle),
+                EllipseRows(0, 0, cosAngle, sinAngle), width, height, spans);
+}
+
+void Rasterizer::EllipseRing(int centerX, int centerY, double radiusX,
+                             double radiusY, double angle, double thickness,
+                             int width, int height, std::vector<Span> &spans) {
+  const double cosAngle = std::cos(angle);
+  const double sinAngle = std::sin(angle);
+  const double half = thickness * 0.5;
+  RasterizeRing(centerX, centerY,
+                EllipseRows(radiusX + half, radiusY + half, cosAngle, sinAngle),
+                EllipseRows(radiusX - half, radiusY - half, cosAngle, sinAngle),
+                width, height, spans);
+}
+
+void Rasterizer::FillSpans(Image &image, const std::vector<Span> &spans,
+                           int value) {
+  for (const Span &span : spans) {
+    std::fill_n(image.pixels[span.y].begin() + span.x1,
+                span.x2 - span.x1 + 1, value);
+  }
+}
@@ -1,9 +1,18 @@
 #include "ShapeDetector/RectangleDetector.hpp"
+#include "ShapeDetector/AllocationTracker.hpp"
+#include "ShapeDetector/ContourGeometry.hpp"
+#include "ShapeDetector/ContourSet.hpp"
+#include "ShapeDetector/FastMath.hpp"
+#include "ShapeDetector/ImageProcessor.hpp"
+#include "ShapeDetector/PixelPipeline.hpp"
+#include "ShapeDetector/Trace.hpp"
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <numbers>
 #include <omp.h>
+#include <optional>
 #include <queue>
 #include <unordered_set>
 constexpr double MIN_DISTANCE_SQUARED = 1.0;
@@ -12,9 +21,115 @@ constexpr double EPSILON_TOLERANCE = 1e-9;
 constexpr double RIGHT_ANGLE = std::numbers::pi / 2.0;
 constexpr double ANGLE_TOLERANCE =
     1.0; // ~57 degrees - tolerant for rotated rectangles
+// Opposite sides of a quadrilateral count as parallel above this |cosine|
+constexpr double PARALLEL_SIDE_COSINE = 0.65;
+// Boundaries longer than this come from meshes, noise and ragged blobs far
+// more often than from rectangles. Several classifier steps grow faster
+// than linearly with the point count, so longer contours are subsampled.
+constexpr size_t MAX_CLASSIFIED_CONTOUR_POINTS = 4096;
+// Radial spread below which the corner finders treat a contour as a circle
+constexpr double RADIAL_SPREAD_LIMIT = 0.15;
+// Steps of the corner approximation chain before the final fallback
+constexpr ApproximationBranch DEFAULT_APPROXIMATION_ORDER[] = {
+    ApproximationBranch::Moments, ApproximationBranch::Hough,
+    ApproximationBranch::Curvature, ApproximationBranch::DouglasPeucker,
+    ApproximationBranch::ConvexHull};
+
+namespace {
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+size_t ImageBytes(const Image &image) {
+  return static_cast<size_t>(image.height) *
+         (image.width * sizeof(int) + sizeof(std::vector<int>));
+}
+
+// Buffers of the contour classifier. Contours are classified on OpenMP
+// workers, so each thread keeps its own set; the buffers grow to the
+// largest contour the thread has seen and are reused for every later one.
+struct ClassifierBuffers {
+  ContourSet decimated;
+  ContourSet smoothed;
+  ContourSet canonical;
+  std::vector<Point> approx;
+  std::vector<Point> corners;
+  std::vector<Point> rotated;
+  std::vector<Point> sorted;
+  std::vector<Point> upper;
+  std::vector<Point> hull;
+  std::vector<Point> best;
+  std::vector<bool> keep;
+  std::vector<std::pair<int, int>> pending;
+  std::vector<double> curvatures;
+  std::vector<double> distances;
+  std::vector<std::pair<double, size_t>> peaks;
+  std::vector<size_t> indices;
+  std::vector<std::pair<Point, Point>> lines;
+  std::vector<std::pair<Point, Point>> selectedLines;
+  std::vector<std::pair<double, Point>> rankedCorners;
+};
+
+ClassifierBuffers &LocalBuffers() {
+  thread_local ClassifierBuffers buffers;
+  return buffers;
+}
+
+// Orders points by quadrant around a center, then by angle within each
+// quadrant, which walks around a traced boundary
+struct AngularOrder {
+  int centerX;
+  int centerY;
+
+  bool operator()(const Point &a, const Point &b) const {
+    int dxa = a.x - centerX;
+    int dya = a.y - centerY;
+    int dxb = b.x - centerX;
+    int dyb = b.y - centerY;
+
+    // Determine quadrants
+    int qa = (dxa >= 0) ? ((dya >= 0) ? 0 : 3) : ((dya >= 0) ? 1 : 2);
+    int qb = (dxb >= 0) ? ((dyb >= 0) ? 0 : 3) : ((dyb >= 0) ? 1 : 2);
+
+    if (qa != qb)
+      return qa < qb;
+
+    // Same quadrant - use cross product for ordering
+    return dxa * dyb > dya * dxb;
+  }
+};
+
+} // namespace
+
+// Buffers of one frame, kept by the detector between calls. They grow to
+// the largest frame seen, after which detecting at that resolution
+// allocates nothing.
+struct RectangleDetector::FrameBuffers {
+  Image processed{0, 0};
+  ContourSet contours;
+  std::vector<std::vector<bool>> visited;
+  std::vector<Point> region;
+  std::vector<ScanlineSegment> segments;
+  std::vector<ContourFeatures> features;
+  std::vector<Rectangle> candidates;
+  std::vector<char> accepted;
+  std::vector<bool> duplicates;
+  std::vector<Rectangle> found;
+};
 
 RectangleDetector::RectangleDetector()
-    : minArea_(500.0), maxArea_(10000.0), approxEpsilon_(0.02) {
+    : minArea_(500.0), maxArea_(10000.0), approxEpsilon_(0.02),
+      frame_(std::make_unique<FrameBuffers>()) {
+  for (int s = 0; s < static_cast<int>(RectangleStrategy::Count); ++s) {
+    strategies_.push_back(static_cast<RectangleStrategy>(s));
+  }
+  branches_.set();
+  approximationOrder_.assign(std::begin(DEFAULT_APPROXIMATION_ORDER),
+                             std::end(DEFAULT_APPROXIMATION_ORDER));
+
   // Pre-allocate caches for better performance
   distanceCache_.reserve(1000);
   angleCache_.reserve(100);
@@ -30,55 +145,298 @@ void RectangleDetector::SetApproxEpsilon(double epsilon) {
   approxEpsilon_ = epsilon;
 }
 
+void RectangleDetector::SetStrategies(
+    const std::vector<RectangleStrategy> &strategies) {
+  strategies_.clear();
+  for (RectangleStrategy strategy : strategies) {
+    if (strategy == RectangleStrategy::Count) {
+      std::cerr << "Warning: Ignoring invalid rectangle strategy"
+                << std::endl;
+      continue;
+    }
+    strategies_.push_back(strategy);
+  }
+}
+
+void RectangleDetector::SetApproximationBranch(ApproximationBranch branch,
+                                               bool enabled) {
+  if (branch == ApproximationBranch::Count ||
+      branch == ApproximationBranch::FinalDouglasPeucker)
+    return;
+  branches_[static_cast<size_t>(branch)] = enabled;
+}
+
+void RectangleDetector::SetApproximationOrder(
+    const std::vector<ApproximationBranch> &order) {
+  std::vector<ApproximationBranch> chain;
+  for (ApproximationBranch branch : order) {
+    if (branch == ApproximationBranch::Count ||
+        branch == ApproximationBranch::FinalDouglasPeucker) {
+      std::cerr << "Warning: Ignoring approximation branch that cannot be "
+                   "reordered"
+                << std::endl;
+      continue;
+    }
+    if (std::find(chain.begin(), chain.end(), branch) == chain.end())
+      chain.push_back(branch);
+  }
+  // Branches left out keep their default order after the listed ones
+  for (ApproximationBranch branch : DEFAULT_APPROXIMATION_ORDER) {
+    if (std::find(chain.begin(), chain.end(), branch) == chain.end())
+      chain.push_back(branch);
+  }
+  approximationOrder_ = chain;
+}
+
+bool RectangleDetector::ApproximationBranchEnabled(
+    ApproximationBranch branch) const {
+  return branch != ApproximationBranch::Count &&
+         branches_[static_cast<size_t>(branch)];
+}
+
+const char *RectangleDetector::StrategyName(RectangleStrategy strategy) {
+  switch (strategy) {
+  case RectangleStrategy::Standard:
+    return "standard";
+  case RectangleStrategy::Enhanced:
+    return "enhanced";
+  case RectangleStrategy::Morphological:
+    return "morphological";
+  case RectangleStrategy::MultiThreshold:
+    return "multithreshold";
+  case RectangleStrategy::Aggressive:
+    return "aggressive";
+  default:
+    return "unknown";
+  }
+}
+
 std::vector<Rectangle> RectangleDetector::DetectRectangles(const Image &image) {
   std::vector<Rectangle> rectangles;
-  rectangles.reserve(60);
+  Detect(image, nullptr, rectangles);
+  return rectangles;
+}
+
+void RectangleDetector::DetectRectangles(const Image &image,
+                                         std::vector<Rectangle> &rectangles) {
+  Detect(image, nullptr, rectangles);
+}
+
+std::vector<Rectangle>
+RectangleDetector::DetectRectangles(const Image &image, DetectionStats &stats) {
+  std::vector<Rectangle> rectangles;
+  Detect(image, &stats, rectangles);
+  return rectangles;
+}
 
-  // Strategy 1: Standard contour-based detection
-  Image processed1 = PreprocessImage(image);
-  std::vector<std::vector<Point>> contours1 = FindContours(processed1);
-  ProcessContoursAtScale(contours1, rectangles, 1.0, image);
+std::vector<Rectangle> RectangleDetector::DetectRectangles(
+    const Image &image, const std::vector<RegionOfInterest> &regions) {
+  return DetectInRegions(image, regions, nullptr);
+}
 
-  // Strategy 2: Enhanced edge detection for steep angles
-  Image processed2 = PreprocessImageEnhanced(image);
-  std::vector<std::vector<Point>> contours2 = FindContours(processed2);
-  ProcessContoursAtScale(contours2, rectangles, 1.0, image);
+std::vector<Rectangle> RectangleDetector::DetectRectangles(
+    const Image &image, const std::vector<RegionOfInterest> &regions,
+    DetectionStats &stats) {
+  return DetectInRegions(image, regions, &stats);
+}
 
-  // Strategy 3: Morphological operations for broken contours
-  Image processed3 = PreprocessImageMorphological(image);
-  std::vector<std::vector<Point>> contours3 = FindContours(processed3);
-  ProcessContoursAtScale(contours3, rectangles, 1.0, image);
+void RectangleDetector::Detect(const Image &image, DetectionStats *stats,
+                               std::vector<Rectangle> &rectangles) {
+  TRACE_SPAN("DetectRectangles", "detect");
+  rectangles.clear();
+  rectangles.reserve(60);
 
-  // Strategy 4: Multi-threshold detection for critical angles
-  Image processed4 = PreprocessImageMultiThreshold(image);
-  std::vector<std::vector<Point>> contours4 = FindContours(processed4);
-  ProcessContoursAtScale(contours4, rectangles, 1.0, image);
+  stats_ = DETECTION_STATS_ENABLED ? stats : nullptr;
+  const auto start = stats_ ? std::chrono::steady_clock::now()
+                            : std::chrono::steady_clock::time_point();
+  std::optional<AllocationScope> allocations;
+  if (stats_)
+    allocations.emplace();
 
-  // Strategy 5: Aggressive edge-preserving filter for problematic angles
-  Image processed5 = PreprocessImageAggressive(image);
-  std::vector<std::vector<Point>> contours5 = FindContours(processed5);
-  ProcessContoursAtScale(contours5, rectangles, 1.0, image);
+  // Each strategy preprocesses differently to recover contours the others
+  // miss; see Preprocess
+  for (RectangleStrategy strategy : strategies_) {
+    RunStrategy(strategy, image, rectangles);
+  }
 
   // Remove duplicates from multiple strategies
+  const int candidates = static_cast<int>(rectangles.size());
   RemoveDuplicateRectangles(rectangles);
 
+  if (DETECTION_STATS_ENABLED && stats_) {
+    stats_->duplicateInput += candidates;
+    stats_->duplicateOutput += static_cast<int>(rectangles.size());
+    stats_->totalMs += ElapsedMs(start);
+    const AllocationCounts counts = allocations->Counts();
+    stats_->heapAllocations += counts.allocations;
+    stats_->heapBytes += counts.bytes;
+    stats_ = nullptr;
+  }
+}
+
+void RectangleDetector::Preprocess(RectangleStrategy strategy,
+                                   const Image &image, Image &output) const {
+  output.Resize(image.width, image.height);
+  switch (strategy) {
+  // Enhanced edge detection for steep angles
+  case RectangleStrategy::Enhanced:
+    return PreprocessImageEnhanced(image, output);
+  // Morphological operations for broken contours
+  case RectangleStrategy::Morphological:
+    return PreprocessImageMorphological(image, output);
+  // Multi-threshold detection for critical angles
+  case RectangleStrategy::MultiThreshold:
+    return PreprocessImageMultiThreshold(image, output);
+  // Aggressive edge-preserving filter for problematic angles
+  case RectangleStrategy::Aggressive:
+    return PreprocessImageAggressive(image, output);
+  // Standard contour-based detection
+  default:
+    return PreprocessImage(image, output);
+  }
+}
+
+void RectangleDetector::RunStrategy(RectangleStrategy strategy,
+                                    const Image &image,
+                                    std::vector<Rectangle> &rectangles) {
+  const char *name = StrategyName(strategy);
+  TRACE_SPAN(name, "strategy");
+  Image &processed = frame_->processed;
+  ContourSet &contours = frame_->contours;
+  if (!DETECTION_STATS_ENABLED || !stats_) {
+    Preprocess(strategy, image, processed);
+    FindContours(processed, contours);
+    ProcessContoursAtScale(contours, rectangles, 1.0, image);
+    return;
+  }
+
+  const int index = static_cast<int>(strategy);
+  StrategyStats &timing = stats_->strategies[index];
+  timing.name = name;
+  stats_->strategyCount = std::max(stats_->strategyCount, index + 1);
+  const AllocationScope allocations;
+
+  auto start = std::chrono::steady_clock::now();
+  Preprocess(strategy, image, processed);
+  timing.preprocessMs += ElapsedMs(start);
+
+  start = std::chrono::steady_clock::now();
+  FindContours(processed, contours);
+  timing.contoursMs += ElapsedMs(start);
+
+  start = std::chrono::steady_clock::now();
+  const size_t before = rectangles.size();
+  ProcessContoursAtScale(contours, rectangles, 1.0, image);
+  timing.classifyMs += ElapsedMs(start);
+
+  timing.contours += static_cast<int>(contours.Size());
+  timing.accepted += static_cast<int>(rectangles.size() - before);
+
+  // Binary image, visited bitmap and traced boundaries of this strategy
+  stats_->bytesAllocated +=
+      ImageBytes(processed) +
+      static_cast<size_t>(processed.width) * processed.height / 8 +
+      contours.CapacityBytes();
+
+  const AllocationCounts counts = allocations.Counts();
+  timing.allocations += counts.allocations;
+  timing.allocatedBytes += counts.bytes;
+}
+
+bool RectangleDetector::Reject([[maybe_unused]] RejectReason reason) const {
+  DETECTION_STATS_INCREMENT(stats_, rejections[static_cast<int>(reason)]);
+  return false;
+}
+
+std::vector<Rectangle> RectangleDetector::DetectInRegions(
+    const Image &image, const std::vector<RegionOfInterest> &regions,
+    DetectionStats *stats) {
+  std::vector<Rectangle> rectangles;
+
+  for (const auto &region : regions) {
+    RegionOfInterest clipped =
+        ImageProcessor::ClipRegion(region, image.width, image.height);
+    if (clipped.width <= 0 || clipped.height <= 0)
+      continue;
+
+    // Run the full pipeline on the region only, so cost scales with its area
+    Image window = ImageProcessor::ExtractRegion(image, clipped);
+    std::vector<Rectangle> &found = frame_->found;
+    Detect(window, stats, found);
+
+    // Translate back to full-frame coordinates
+    for (auto &rect : found) {
+      rect.center.x += clipped.x;
+      rect.center.y += clipped.y;
+      rectangles.push_back(rect);
+    }
+  }
+
+  // Overlapping regions may report the same rectangle more than once. The
+  // pass takes the regions' outputs as input, so only what it removes
+  // changes the duplicate counts.
+  if (regions.size() > 1) {
+    const bool timed = DETECTION_STATS_ENABLED && stats;
+    const auto start = timed ? std::chrono::steady_clock::now()
+                             : std::chrono::steady_clock::time_point();
+    const int candidates = static_cast<int>(rectangles.size());
+    RemoveDuplicateRectangles(rectangles);
+    if (timed) {
+      stats->duplicateOutput -=
+          candidates - static_cast<int>(rectangles.size());
+      stats->totalMs += ElapsedMs(start);
+    }
+  }
+
   return rectangles;
 }
 
+// The points the classifier sees of one traced contour: the arena's own
+// coordinates, except for oversized contours, which keep every k-th point
+// in a per-thread copy so at most MAX_CLASSIFIED_CONTOUR_POINTS remain, in
+// order; corners of anything the size of a rectangle survive at a few
+// pixels' resolution. Those are measured again into features.
+ContourView RectangleDetector::LoadContour(const ContourSet &contours,
+                                           size_t index,
+                                           ContourFeatures &features) const {
+  const size_t count = contours.PointCount(index);
+  if (count <= MAX_CLASSIFIED_CONTOUR_POINTS)
+    return contours.View(index);
+
+  DETECTION_STATS_INCREMENT(stats_, decimatedContours);
+  const size_t stride = (count + MAX_CLASSIFIED_CONTOUR_POINTS - 1) /
+                        MAX_CLASSIFIED_CONTOUR_POINTS;
+  ContourSet &decimated = LocalBuffers().decimated;
+  decimated.Clear();
+  decimated.Append(contours, index, stride);
+  features = ContourGeometry::Measure(decimated, 0);
+  return decimated.View(0);
+}
+
 void RectangleDetector::ProcessContoursAtScale(
-    const std::vector<std::vector<Point>> &contours,
-    std::vector<Rectangle> &rectangles, double scale,
-    const Image &scaledImage) {
+    const ContourSet &contours, std::vector<Rectangle> &rectangles,
+    double scale, const Image &scaledImage) {
 
-  // Parallel processing for large number of contours
-  if (contours.size() > 10) {
-    std::vector<Rectangle> tempRectangles(contours.size());
-    std::vector<bool> validRectangles(contours.size(), false);
+  // Features of every contour in one batched pass, in the geometry
+  // precision of the build
+  std::vector<ContourFeatures> &features = frame_->features;
+  ContourGeometry::Measure(contours, features);
 
+  // Parallel processing for large number of contours
+  if (contours.Size() > 10) {
+    // Bytes rather than a bit vector: workers write neighbouring flags
+    std::vector<Rectangle> &tempRectangles = frame_->candidates;
+    std::vector<char> &validRectangles = frame_->accepted;
+    tempRectangles.resize(contours.Size());
+    validRectangles.assign(contours.Size(), 0);
+
+    // Workers classify straight from the traced arena
 #pragma omp parallel for schedule(dynamic)
-    for (size_t i = 0; i < contours.size(); ++i) {
-      if (IsRectangle(contours[i])) {
-        Rectangle rect = CreateRectangle(contours[i]);
+    for (size_t i = 0; i < contours.Size(); ++i) {
+      TRACE_SPAN("ClassifyContour", "classify");
+      const ContourView contour = LoadContour(contours, i, features[i]);
+      if (IsRectangle(contour, &features[i])) {
+        Rectangle rect = CreateRectangle(contour, &features[i]);
         // Scale coordinates back to original image size
         if (scale != 1.0) {
           rect.center.x = static_cast<int>(rect.center.x / scale);
@@ -89,21 +447,25 @@ void RectangleDetector::ProcessContoursAtScale(
         if (rect.width > 0 && rect.height > 0) {
           tempRectangles[i] = rect;
           validRectangles[i] = true;
+        } else {
+          Reject(RejectReason::Degenerate);
         }
       }
     }
 
     // Collect valid rectangles
-    for (size_t i = 0; i < contours.size(); ++i) {
+    for (size_t i = 0; i < contours.Size(); ++i) {
       if (validRectangles[i]) {
         rectangles.push_back(tempRectangles[i]);
       }
     }
   } else {
     // Sequential processing for small number of contours
-    for (const auto &contour : contours) {
-      if (IsRectangle(contour)) {
-        Rectangle rect = CreateRectangle(contour);
+    for (size_t i = 0; i < contours.Size(); ++i) {
+      TRACE_SPAN("ClassifyContour", "classify");
+      const ContourView contour = LoadContour(contours, i, features[i]);
+      if (IsRectangle(contour, &features[i])) {
+        Rectangle rect = CreateRectangle(contour, &features[i]);
         // Scale coordinates back to original image size
         if (scale != 1.0) {
           rect.center.x = static_cast<int>(rect.center.x / scale);
@@ -113,64 +475,67 @@ void RectangleDetector::ProcessContoursAtScale(
         }
         if (rect.width > 0 && rect.height > 0) {
           rectangles.push_back(rect);
+        } else {
+          Reject(RejectReason::Degenerate);
         }
       }
     }
   }
 }
 
-Image RectangleDetector::PreprocessImage(const Image &image) const {
-  Image result = image;
+void RectangleDetector::PreprocessImage(const Image &image,
+                                        Image &output) const {
+  TRACE_SPAN("PreprocessImage", "kernel");
+  using P = PixelPipeline;
 
-  // Apply minimal Gaussian blur for noise reduction
-  Image blurred =
-      ApplyGaussianBlur(result, 0.8); // Reduced sigma to preserve edges
-
-// Simple thresholding - keep it simple to avoid losing rectangles
-#pragma omp parallel for
-  for (int y = 0; y < blurred.height; ++y) {
-    for (int x = 0; x < blurred.width; ++x) {
-      result.pixels[y][x] = (blurred.pixels[y][x] > 127) ? 255 : 0;
-    }
-  }
-
-  return result;
+  // Minimal blur for noise reduction (sigma kept low to preserve edges),
+  // then a simple threshold to avoid losing rectangles
+  P::Evaluate(P::Threshold(P::GaussianBlur<0.8>(P::Input(image)), 127),
+              output);
 }
 
-std::vector<std::vector<Point>>
-RectangleDetector::FindContours(const Image &image) const {
-  std::vector<std::vector<Point>> contours;
-  contours.reserve(100); // Pre-allocate for typical number of contours
-  std::vector<std::vector<bool>> visited(image.height,
-                                         std::vector<bool>(image.width, false));
+void RectangleDetector::FindContours(const Image &image,
+                                     ContourSet &contours) const {
+  TRACE_SPAN("FindContours", "contours");
+  contours.Clear();
+  contours.Reserve(100, 8192); // Typical contour and boundary point counts
+  std::vector<std::vector<bool>> &visited = frame_->visited;
+  visited.resize(image.height);
+  for (auto &row : visited)
+    row.assign(image.width, false);
+
+  // The region buffer is reused for every component; boundaries are
+  // traced straight into the arena
+  std::vector<Point> &region = frame_->region;
+  region.reserve(1000); // Pre-allocate for typical region size
 
   // Find all connected white regions
   for (int y = 0; y < image.height; ++y) {
     for (int x = 0; x < image.width; ++x) {
       if (!visited[y][x] && image.pixels[y][x] == 255) {
-        std::vector<Point> region;
-        region.reserve(1000); // Pre-allocate for typical region size
+        region.clear();
         ScanlineFillContour(image, x, y, region, visited);
 
         if (region.size() >= 50) { // Minimum size for a rectangle
           // Convert filled region to boundary contour
-          std::vector<Point> boundary = ExtractBoundary(region, image);
-          if (boundary.size() >= 8) {
-            contours.push_back(std::move(boundary));
+          ExtractBoundary(region, image, contours);
+          if (contours.OpenPointCount() >= 8) {
+            contours.Close();
+          } else {
+            contours.Discard();
           }
         }
       }
     }
   }
-
-  return contours;
 }
 
 void RectangleDetector::ScanlineFillContour(
     const Image &image, int startX, int startY, std::vector<Point> &contour,
     std::vector<std::vector<bool>> &visited) const {
-  // Efficient scanline flood fill algorithm
-  std::stack<ScanlineSegment> stack;
+  // Efficient scanline flood fill algorithm, on a stack kept between calls
+  std::vector<ScanlineSegment> &stack = frame_->segments;
+  stack.clear();
 
   // Find initial horizontal segment
   int x1 = startX, x2 = startX;
@@ -181,11 +546,11 @@ void RectangleDetector::ScanlineFillContour(
          !visited[startY][x2 + 1])
     x2++;
 
-  stack.push(ScanlineSegment(startY, x1, x2, -1));
+  stack.emplace_back(startY, x1, x2, -1);
 
   while (!stack.empty()) {
-    ScanlineSegment seg = stack.top();
-    stack.pop();
+    ScanlineSegment seg = stack.back();
+    stack.pop_back();
 
     // Process scanline - batch mark visited pixels for better cache performance
     for (int x = seg.x1; x <= seg.x2; x++) {
@@ -227,43 +592,47 @@ void RectangleDetector::ScanlineFillContour(
                !visited[newY][newX2 + 1])
           newX2++;
 
-        stack.push(ScanlineSegment(newY, newX1, newX2, seg.y));
+        stack.emplace_back(newY, newX1, newX2, seg.y);
       }
     }
   }
 }
 
-bool RectangleDetector::IsRectangle(const std::vector<Point> &contour) const {
+bool RectangleDetector::IsRectangle(const ContourView &contour,
+                                    const ContourFeatures *features) const {
   if (contour.size() < 4)
-    return false;
+    return Reject(RejectReason::TooFewPoints);
 
-  std::vector<Point> approx = ApproximateContour(contour, approxEpsilon_);
+  ApproximationBranch branch;
+  std::vector<Point> &approx = LocalBuffers().approx;
+  ApproximateContour(contour, approxEpsilon_, approx, &branch, features);
+  DETECTION_STATS_INCREMENT(stats_, branches[static_cast<int>(branch)]);
 
   // Allow 4-6 vertices for rectangles (more tolerance for imperfect shapes)
   if (approx.size() < 4 || approx.size() > 6)
-    return false;
+    return Reject(RejectReason::VertexCount);
 
   // If we have more than 4 vertices, try to find the best 4 corners
   if (approx.size() > 4) {
     auto corners = SelectBestCorners(approx);
-    approx = std::vector<Point>(corners.begin(), corners.end());
+    approx.assign(corners.begin(), corners.end());
     if (approx.size() != 4)
-      return false;
+      return Reject(RejectReason::VertexCount);
   }
 
   // Check area constraints
   double area = CalculateArea(approx);
   if (area < minArea_ || area > maxArea_)
-    return false;
+    return Reject(RejectReason::Area);
 
   // Check if it's a valid quadrilateral (parallel sides)
   if (!IsValidQuadrilateral(approx))
-    return false;
+    return Reject(RejectReason::NotQuadrilateral);
 
   // Additional check: reject shapes that are too circular
   // Calculate the convexity defects to detect circular shapes
-  if (IsCircularShape(contour, approx))
-    return false;
+  if (IsCircularShape(contour, approx, features))
+    return Reject(RejectReason::Circular);
 
   // Additional check: verify corner angles are close to π/2 radians (90
   // degrees)
@@ -296,12 +665,13 @@ bool RectangleDetector::IsRectangle(const std::vector<Point> &contour) const {
 
   // Level 2: Moderate validation with geometry checks
   if (validCorners >= 2 && avgAngleDeviation < 0.6) {
-    return IsValidQuadrilateral(approx);
+    return IsValidQuadrilateral(approx) ||
+           Reject(RejectReason::NotQuadrilateral);
   }
 
   // Level 3: Relaxed validation with moment-based analysis
   if (validCorners >= 1 && avgAngleDeviation < 0.8) {
-    return IsRectangleUsingMoments(contour);
+    return IsRectangleUsingMoments(contour) || Reject(RejectReason::Moments);
   }
 
   // Check rectangularity: compare area with bounding box area
@@ -329,7 +699,7 @@ bool RectangleDetector::IsRectangle(const std::vector<Point> &contour) const {
   // For a perfect rectangle, this ratio should be close to 1
   // Reasonable tolerance for rotated rectangles (45° rotation gives ~0.71)
   if (rectangularity < 0.25) {
-    return false;
+    return Reject(RejectReason::Rectangularity);
   }
 
   return true;
@@ -337,9 +707,10 @@ bool RectangleDetector::IsRectangle(const std::vector<Point> &contour) const {
 
 // Helper function to detect circular shapes
 bool RectangleDetector::IsCircularShape(
-    const std::vector<Point> &contour, const std::vector<Point> &approx) const {
+    const ContourView &contour, const std::vector<Point> &approx,
+    const ContourFeatures *features) const {
   // Calculate the area ratio between the original contour and its convex hull
-  double contourArea = CalculateArea(contour);
+  double contourArea = features ? features->area : CalculateArea(contour);
   double approxArea = CalculateArea(approx);
 
   // For circles approximated as 4-sided polygons, the area ratio will be very
@@ -353,7 +724,8 @@ bool RectangleDetector::IsCircularShape(
   }
 
   // Calculate the perimeter-to-area ratio (circularity test)
-  double perimeter = CalculatePerimeter(contour);
+  double perimeter =
+      features ? features->perimeter : CalculatePerimeter(contour);
   if (contourArea > 0 && perimeter > 0) {
     double circularity =
         (perimeter * perimeter) / (4.0 * std::numbers::pi * contourArea);
@@ -371,158 +743,167 @@ bool RectangleDetector::IsValidQuadrilateral(
   if (quad.size() != 4)
     return false;
 
-  // Pre-calculate side vectors for better cache performance
   double sides[4][2]; // [side][x,y]
-  double lengths[4];
-
-  // Calculate all sides in one pass
   for (int i = 0; i < 4; ++i) {
     const int next = (i + 1) % 4;
-    const double dx = quad[next].x - quad[i].x;
-    const double dy = quad[next].y - quad[i].y;
-    lengths[i] = std::sqrt(dx * dx + dy * dy);
+    sides[i][0] = quad[next].x - quad[i].x;
+    sides[i][1] = quad[next].y - quad[i].y;
 
-    if (lengths[i] < EPSILON_TOLERANCE)
+    if (sides[i][0] == 0.0 && sides[i][1] == 0.0)
       return false; // Degenerate side
-
-    const double invLength = 1.0 / lengths[i];
-    sides[i][0] = dx * invLength;
-    sides[i][1] = dy * invLength;
   }
 
-  // Check if opposite sides are roughly parallel (dot product close to ±1)
-  const double dot1 = sides[0][0] * sides[2][0] + sides[0][1] * sides[2][1];
-  const double dot2 = sides[1][0] * sides[3][0] + sides[1][1] * sides[3][1];
-
-  // Allow more tolerance for rotation and imperfect detection
-  return (std::abs(std::abs(dot1) - 1.0) < 0.35) &&
-         (std::abs(std::abs(dot2) - 1.0) < 0.35);
+  // Opposite sides roughly parallel, tolerant of rotation and imperfect
+  // detection; compared through squared cosines, without normalizing
+  return FastMath::AbsCosineAbove(sides[0][0], sides[0][1], sides[2][0],
+                                  sides[2][1], PARALLEL_SIDE_COSINE) &&
+         FastMath::AbsCosineAbove(sides[1][0], sides[1][1], sides[3][0],
+                                  sides[3][1], PARALLEL_SIDE_COSINE);
 }
 
-std::vector<Point>
-RectangleDetector::ApproximateContour(const std::vector<Point> &contour,
-                                      double epsilon) const {
-  if (contour.size() < 4)
-    return contour;
-
-  const double perimeter = CalculatePerimeter(contour);
-
-  // Try moment-based detection first - completely rotation invariant
-  // But only for contours that pass additional shape tests
-  if (contour.size() > 20 && !IsLikelyCircularContour(contour)) {
-    std::vector<Point> momentApprox = FindRectangleCornersMomentBased(contour);
-    if (momentApprox.size() == 4) {
-      // Additional validation: check if detected corners make sense
-      double area = CalculateArea(momentApprox);
-      if (area >= minArea_ && area <= maxArea_) {
-        return momentApprox;
-      }
-    }
-  }
-
-  // Try Hough-based line detection for steep angles - but only for
-  // rectangular-like shapes
-  if (contour.size() > 30 && !IsLikelyCircularContour(contour)) {
-    std::vector<Point> houghApprox = FindRectangleUsingHoughLines(contour);
-    if (houghApprox.size() == 4) {
-      return houghApprox;
-    }
+// The branches write their corners into approx
+void RectangleDetector::ApproximateContour(
+    const ContourView &contour, double epsilon, std::vector<Point> &approx,
+    ApproximationBranch *branch, const ContourFeatures *features) const {
+  auto taken = [branch](ApproximationBranch which) {
+    if (branch)
+      *branch = which;
+  };
+
+  taken(ApproximationBranch::FinalDouglasPeucker);
+  if (contour.size() < 4) {
+    approx.clear();
+    for (size_t i = 0; i < contour.count; ++i)
+      approx.push_back(contour[i]);
+    return;
   }
 
-  // Try smoothed contour for better rotation handling
-  std::vector<Point> smoothedContour = SmoothContourForRotation(contour);
-
-  // Try rotation-invariant corner detection first for larger contours
-  if (smoothedContour.size() > 50) {
-    std::vector<Point> rotationInvariantApprox =
-        FindCornersRotationInvariant(smoothedContour);
-    if (rotationInvariantApprox.size() >= 4 &&
-        rotationInvariantApprox.size() <= 8) {
-      return rotationInvariantApprox;
+  const double perimeter =
+      features ? features->perimeter : CalculatePerimeter(contour);
+  auto enabled = [this](ApproximationBranch which) {
+    return branches_[static_cast<size_t>(which)];
+  };
+  // Shared by the moment and Hough gates, evaluated at most once
+  std::optional<bool> circular;
+  auto likelyCircular = [&] {
+    if (!circular) {
+      circular = features ? contour.size() >= 8 &&
+                                features->radialSpread < RADIAL_SPREAD_LIMIT
+                          : IsLikelyCircularContour(contour);
     }
-  }
-
-  // Try multiple epsilon values to find the best 4-corner approximation
-  std::vector<double> epsilonMultipliers = {0.05, 0.1, 0.15, 0.2, 0.3, 0.5,
-                                            0.8,  1.0, 1.5,  2.0, 3.0};
-
-  for (double multiplier : epsilonMultipliers) {
-    double epsilonValue = std::max(epsilon * perimeter * multiplier, 2.0);
-
-    std::vector<Point> approx;
-    approx.reserve(8);
-
-    std::vector<bool> keep(contour.size(), false);
+    return *circular;
+  };
+
+  // One keep mask serves every Douglas-Peucker pass
+  ClassifierBuffers &buffers = LocalBuffers();
+  std::vector<bool> &keep = buffers.keep;
+  auto simplify = [&](double epsilonValue) {
+    approx.clear();
+    keep.assign(contour.size(), false);
     keep[0] = keep[contour.size() - 1] = true;
 
-    DouglasPeuckerRecursive(contour, 0, contour.size() - 1, epsilonValue, keep);
+    DouglasPeucker(contour, 0, contour.size() - 1, epsilonValue, keep);
 
     for (size_t i = 0; i < contour.size(); ++i) {
       if (keep[i]) {
         approx.push_back(contour[i]);
       }
     }
-
-    // If we get exactly 4 corners, that's ideal
-    if (approx.size() == 4) {
-      return approx;
+  };
+
+  // Each branch leaves its corners in approx and tells whether they are
+  // good enough to stop at
+  auto attempt = [&](ApproximationBranch which) {
+    switch (which) {
+    // Moment-based detection is completely rotation invariant, but only
+    // for contours that pass additional shape tests
+    case ApproximationBranch::Moments: {
+      if (contour.size() <= 20 || likelyCircular())
+        return false;
+      FindRectangleCornersMomentBased(contour, approx);
+      if (approx.size() != 4)
+        return false;
+      // Additional validation: check if detected corners make sense
+      const double area = CalculateArea(approx);
+      return area >= minArea_ && area <= maxArea_;
     }
-
-    // If we get 5-12 corners, we can work with that (increased for rotated
-    // rectangles)
-    if (approx.size() >= 5 && approx.size() <= 12) {
-      return approx;
+    // Hough-based line detection for steep angles - but only for
+    // rectangular-like shapes
+    case ApproximationBranch::Hough:
+      if (contour.size() <= 30 || likelyCircular())
+        return false;
+      FindRectangleUsingHoughLines(contour, approx);
+      return approx.size() == 4;
+    // Rotation-invariant corner detection on a smoothed contour, for
+    // larger contours
+    case ApproximationBranch::Curvature: {
+      ContourSet &smoothed = buffers.smoothed;
+      SmoothContourForRotation(contour, smoothed);
+      if (smoothed.PointCount(0) <= 50)
+        return false;
+      FindCornersRotationInvariant(smoothed.View(0), approx);
+      return approx.size() >= 4 && approx.size() <= 8;
     }
-  }
-
-  // Fallback: use convex hull approach for difficult cases
-  std::vector<Point> hull = ConvexHull(std::vector<Point>(contour));
-  if (hull.size() >= 4 && hull.size() <= 8) {
-    return hull;
-  }
-
-  // Final fallback: original algorithm
-  std::vector<Point> approx;
-  approx.reserve(8);
-  double epsilonValue = std::max(epsilon * perimeter, 3.0);
-
-  std::vector<bool> keep(contour.size(), false);
-  keep[0] = keep[contour.size() - 1] = true;
-
-  DouglasPeuckerRecursive(contour, 0, contour.size() - 1, epsilonValue, keep);
+    // Multiple epsilon values to find the best 4-corner approximation;
+    // 5-12 corners are workable too (increased for rotated rectangles)
+    case ApproximationBranch::DouglasPeucker: {
+      constexpr double epsilonMultipliers[] = {0.05, 0.1, 0.15, 0.2,
+                                               0.3,  0.5, 0.8,  1.0,
+                                               1.5,  2.0, 3.0};
+      for (double multiplier : epsilonMultipliers) {
+        simplify(std::max(epsilon * perimeter * multiplier, 2.0));
+        if (approx.size() >= 4 && approx.size() <= 12)
+          return true;
+      }
+      return false;
+    }
+    // Convex hull approach for difficult cases
+    case ApproximationBranch::ConvexHull:
+      ConvexHull(contour, approx);
+      return approx.size() >= 4 && approx.size() <= 8;
+    default:
+      return false;
+    }
+  };
 
-  for (size_t i = 0; i < contour.size(); ++i) {
-    if (keep[i]) {
-      approx.push_back(contour[i]);
+  for (ApproximationBranch which : approximationOrder_) {
+    if (enabled(which) && attempt(which)) {
+      taken(which);
+      return;
     }
   }
 
-  return approx;
+  // Final fallback: original algorithm
+  simplify(std::max(epsilon * perimeter, 3.0));
 }
 
-void RectangleDetector::DouglasPeuckerRecursive(
-    const std::vector<Point> &contour, int start, int end, double epsilon,
-    std::vector<bool> &keep) const {
-  if (end - start <= 1)
-    return;
+// Explicit stack instead of recursion: spirals and ragged blobs split one
+// point at a time, which would nest as deep as the contour is long
+void RectangleDetector::DouglasPeucker(const ContourView &contour,
+                                       int start, int end, double epsilon,
+                                       std::vector<bool> &keep) const {
+  const ContourSet::Coordinate *xs = contour.xs;
+  const ContourSet::Coordinate *ys = contour.ys;
+  std::vector<std::pair<int, int>> &pending = LocalBuffers().pending;
+  pending.clear();
+  pending.emplace_back(start, end);
+
+  while (!pending.empty()) {
+    const auto [first, last] = pending.back();
+    pending.pop_back();
+    if (last - first <= 1)
+      continue;
 
-  double maxDist = 0.0;
-  int maxIndex = start;
+    double maxDist = 0.0;
+    const int maxIndex = static_cast<int>(
+        ContourGeometry::FarthestFromChord(xs, ys, first, last, maxDist));
 
-  for (int i = start + 1; i < end; ++i) {
-    double distSquared =
-        PointToLineDistanceSquared(contour[i], contour[start], contour[end]);
-    if (distSquared > maxDist) {
-      maxDist = distSquared;
-      maxIndex = i;
+    if (maxDist > epsilon * epsilon) {
+      keep[maxIndex] = true;
+      pending.emplace_back(maxIndex, last);
+      pending.emplace_back(first, maxIndex);
     }
   }
-
-  if (maxDist > epsilon * epsilon) {
-    keep[maxIndex] = true;
-    DouglasPeuckerRecursive(contour, start, maxIndex, epsilon, keep);
-    DouglasPeuckerRecursive(contour, maxIndex, end, epsilon, keep);
-  }
 }
 
 double
@@ -580,29 +961,45 @@ RectangleDetector::CalculateArea(const std::vector<Point> &contour) const {
   return std::abs(area) * 0.5;
 }
 
-double RectangleDetector::PointToLineDistanceSquared(
-    const Point &point, const Point &lineStart, const Point &lineEnd) const {
-  const double A = lineEnd.y - lineStart.y;
-  const double B = lineStart.x - lineEnd.x;
-  const double C = static_cast<double>(lineEnd.x) * lineStart.y -
-                   static_cast<double>(lineStart.x) * lineEnd.y;
+// The wrap padding closes the loop without wrapping the index
+double
+RectangleDetector::CalculatePerimeter(const ContourView &contour) const {
+  if (contour.count < 2)
+    return 0.0;
+
+  double perimeter = 0.0;
+  for (size_t i = 0; i < contour.count; ++i) {
+    const double dx = contour.xs[i + 1] - contour.xs[i];
+    const double dy = contour.ys[i + 1] - contour.ys[i];
+    perimeter += std::sqrt(dx * dx + dy * dy);
+  }
+  return perimeter;
+}
 
-  const double denominatorSquared = A * A + B * B;
-  if (denominatorSquared < EPSILON_TOLERANCE)
+double RectangleDetector::CalculateArea(const ContourView &contour) const {
+  if (contour.count < 3)
     return 0.0;
 
-  const double distance = A * point.x + B * point.y + C;
-  return (distance * distance) / denominatorSquared;
+  double area = 0.0;
+  for (size_t i = 0; i < contour.count; ++i) {
+    area += static_cast<double>(contour.xs[i]) * contour.ys[i + 1] -
+            static_cast<double>(contour.xs[i + 1]) * contour.ys[i];
+  }
+  return std::abs(area) * 0.5;
 }
 
 Rectangle
-RectangleDetector::CreateRectangle(const std::vector<Point> &contour) const {
-  Rectangle rect;
+RectangleDetector::CreateRectangle(const ContourView &contour,
+                                   const ContourFeatures *features) const {
+  Rectangle rect{};
 
-  std::vector<Point> approx = ApproximateContour(contour, approxEpsilon_);
+  ClassifierBuffers &buffers = LocalBuffers();
+  std::vector<Point> &approx = buffers.approx;
+  ApproximateContour(contour, approxEpsilon_, approx, nullptr, features);
 
   // Clean up the approximation - remove duplicate points
-  std::vector<Point> cleanCorners = CleanupCorners(approx);
+  std::vector<Point> &cleanCorners = buffers.corners;
+  CleanupCorners(approx, cleanCorners);
 
   // Try to form a proper rectangle with 4 corners
   if (cleanCorners.size() < 3) {
@@ -629,10 +1026,8 @@ RectangleDetector::CreateRectangle(const std::vector<Point> &contour) const {
     Point centroid = CalculateContourCentroid(contour);
     rect.center = centroid;
 
-    std::vector<double> edgeLengths;
-    edgeLengths.reserve(4);
-    std::vector<std::pair<double, double>> edgeVectors;
-    edgeVectors.reserve(4);
+    std::array<double, 4> edgeLengths;
+    std::array<std::pair<double, double>, 4> edgeVectors;
 
     for (int i = 0; i < 4; ++i) {
       const int nextIdx = (i + 1) % 4;
@@ -640,11 +1035,11 @@ RectangleDetector::CreateRectangle(const std::vector<Point> &contour) const {
       const double dy = cleanCorners[nextIdx].y - cleanCorners[i].y;
       const double length = std::sqrt(dx * dx + dy * dy);
 
-      edgeLengths.push_back(length);
+      edgeLengths[i] = length;
       if (length > 0) {
-        edgeVectors.push_back({dx / length, dy / length});
+        edgeVectors[i] = {dx / length, dy / length};
       } else {
-        edgeVectors.push_back({0, 0});
+        edgeVectors[i] = {0, 0};
       }
     }
 
@@ -657,23 +1052,24 @@ RectangleDetector::CreateRectangle(const std::vector<Point> &contour) const {
     if (avgLength1 > avgLength2) {
       rect.width = static_cast<int>(avgLength1);
       rect.height = static_cast<int>(avgLength2);
-      rect.angle = std::atan2(edgeVectors[0].second, edgeVectors[0].first);
+      rect.angle =
+          FastMath::Atan2(edgeVectors[0].second, edgeVectors[0].first);
     } else {
       rect.width = static_cast<int>(avgLength2);
       rect.height = static_cast<int>(avgLength1);
-      rect.angle = std::atan2(edgeVectors[1].second, edgeVectors[1].first);
+      rect.angle =
+          FastMath::Atan2(edgeVectors[1].second, edgeVectors[1].first);
     }
   }
 
   return rect;
 }
 
-std::vector<Point>
-RectangleDetector::CleanupCorners(const std::vector<Point> &corners) const {
+void RectangleDetector::CleanupCorners(const std::vector<Point> &corners,
+                                       std::vector<Point> &cleaned) const {
   const double minDistanceSquared =
       corners.size() <= 4 ? MIN_DISTANCE_SQUARED : MIN_DISTANCE_SQUARED_LARGE;
-  std::vector<Point> cleaned;
-  cleaned.reserve(corners.size());
+  cleaned.clear();
 
   for (const Point &corner : corners) {
     bool keepPoint = true;
@@ -693,8 +1089,6 @@ RectangleDetector::CleanupCorners(const std::vector<Point> &corners) const {
       cleaned.push_back(corner);
     }
   }
-
-  return cleaned;
 }
 
 std::array<Point, 4>
@@ -709,41 +1103,46 @@ RectangleDetector::SelectBestCorners(const std::vector<Point> &corners) const {
   }
 
   // Find the convex hull to get the outermost points
-  std::vector<Point> hull = ConvexHull(corners);
+  ClassifierBuffers &buffers = LocalBuffers();
+  std::vector<Point> &hull = buffers.hull;
+  ConvexHull(corners, hull);
 
   if (hull.size() == 4) {
     std::copy(hull.begin(), hull.end(), result.begin());
     return result;
   } else if (hull.size() > 4) {
     // If we have more than 4 points in the hull, select the 4 most corner-like
-    // by finding points with the largest angle changes
-    std::vector<std::pair<double, Point>> angleCorners;
-    angleCorners.reserve(hull.size());
+    // by finding points with the largest angle changes. Only the order of
+    // the angles matters, so they are ranked by signed squared cosine.
+    std::vector<std::pair<double, Point>> &angleCorners =
+        buffers.rankedCorners;
+    angleCorners.clear();
 
     for (size_t i = 0; i < hull.size(); ++i) {
       size_t prev = (i - 1 + hull.size()) % hull.size();
       size_t next = (i + 1) % hull.size();
 
-      // Calculate angle at this point
-      double angle = CalculateCornerAngleFast(hull[prev], hull[i], hull[next]);
-      angleCorners.push_back({angle, hull[i]});
+      const double cosineRank = FastMath::SignedCosineSquared(
+          hull[prev].x - hull[i].x, hull[prev].y - hull[i].y,
+          hull[next].x - hull[i].x, hull[next].y - hull[i].y);
+      angleCorners.push_back({cosineRank, hull[i]});
     }
 
-    // Partial sort to get top 4
+    // Partial sort to get the 4 widest angles, i.e. the smallest cosines
     std::partial_sort(
         angleCorners.begin(), angleCorners.begin() + 4, angleCorners.end(),
-        [](const auto &a, const auto &b) { return a.first > b.first; });
+        [](const auto &a, const auto &b) { return a.first < b.first; });
 
     // Take the 4 best corners
-    std::vector<Point> bestCorners;
-    bestCorners.reserve(4);
+    std::vector<Point> &bestCorners = buffers.best;
+    bestCorners.clear();
     for (int i = 0; i < 4; ++i) {
       bestCorners.push_back(angleCorners[i].second);
     }
 
     // Sort them in proper order around the shape
-    auto sorted = SortBoundaryPointsRadix(std::move(bestCorners));
-    std::copy(sorted.begin(), sorted.end(), result.begin());
+    SortBoundaryPointsRadix(bestCorners);
+    std::copy(bestCorners.begin(), bestCorners.end(), result.begin());
   }
 
   return result;
@@ -757,14 +1156,10 @@ double RectangleDetector::CalculateCornerAngle(const Point &prev,
   double dx2 = next.x - current.x;
   double dy2 = next.y - current.y;
 
-  double angle1 = std::atan2(dy1, dx1);
-  double angle2 = std::atan2(dy2, dx2);
-
-  double angleDiff = std::abs(angle2 - angle1);
-  if (angleDiff > std::numbers::pi)
-    angleDiff = 2 * std::numbers::pi - angleDiff;
-
-  return angleDiff;
+  // One arc tangent of |cross| and dot instead of one per direction
+  const double cross = dx1 * dy2 - dy1 * dx2;
+  const double dot = dx1 * dx2 + dy1 * dy2;
+  return FastMath::Atan2(std::abs(cross), dot);
 }
 
 double RectangleDetector::CalculateCornerAngleFast(const Point &prev,
@@ -786,14 +1181,14 @@ double RectangleDetector::CalculateCornerAngleFast(const Point &prev,
   // Angle between vectors
   double cosAngle = dot / (len1 * len2);
   cosAngle = std::max(-1.0, std::min(1.0, cosAngle)); // Clamp to [-1, 1]
-  return std::acos(cosAngle);
+  return FastMath::Acos(cosAngle);
 }
 
-std::vector<Point>
-RectangleDetector::ExtractBoundary(const std::vector<Point> &region,
-                                   const Image &image) const {
-  std::vector<Point> boundary;
-  boundary.reserve(region.size() / 4); // Typical boundary is ~1/4 of region
+void RectangleDetector::ExtractBoundary(const std::vector<Point> &region,
+                                        const Image &image,
+                                        ContourSet &contours) const {
+  // Summed while tracing, for the centroid the points are sorted around
+  int sumX = 0, sumY = 0;
 
   // Find all boundary points - pixels that are white but have at least one
   // black neighbor
@@ -820,22 +1215,22 @@ RectangleDetector::ExtractBoundary(const std::vector<Point> &region,
     }
 
     if (isBoundary) {
-      boundary.push_back(p);
+      contours.Push(p.x, p.y);
+      sumX += p.x;
+      sumY += p.y;
     }
   }
 
   // Sort boundary points to form a proper contour
-  if (boundary.size() > 0) {
-    return SortBoundaryPointsRadix(std::move(boundary));
-  }
-
-  return boundary;
+  const int count = static_cast<int>(contours.OpenPointCount());
+  if (count >= 3)
+    contours.SortOpen(AngularOrder{sumX / count, sumY / count});
 }
 
-std::vector<Point>
-RectangleDetector::SortBoundaryPointsRadix(std::vector<Point> boundary) const {
+void RectangleDetector::SortBoundaryPointsRadix(
+    std::vector<Point> &boundary) const {
   if (boundary.size() < 3)
-    return boundary;
+    return;
 
   // Find centroid
   int centerX = 0, centerY = 0;
@@ -847,29 +1242,11 @@ RectangleDetector::SortBoundaryPointsRadix(std::vector<Point> boundary) const {
   centerY /= boundary.size();
 
   // Sort points by quadrant and then by angle approximation
-  std::sort(boundary.begin(), boundary.end(),
-            [centerX, centerY](const Point &a, const Point &b) {
-              int dxa = a.x - centerX;
-              int dya = a.y - centerY;
-              int dxb = b.x - centerX;
-              int dyb = b.y - centerY;
-
-              // Determine quadrants
-              int qa = (dxa >= 0) ? ((dya >= 0) ? 0 : 3) : ((dya >= 0) ? 1 : 2);
-              int qb = (dxb >= 0) ? ((dyb >= 0) ? 0 : 3) : ((dyb >= 0) ? 1 : 2);
-
-              if (qa != qb)
-                return qa < qb;
-
-              // Same quadrant - use cross product for ordering
-              return dxa * dyb > dya * dxb;
-            });
-
-  return boundary;
+  std::sort(boundary.begin(), boundary.end(), AngularOrder{centerX, centerY});
 }
 
 Point RectangleDetector::CalculateContourCentroid(
-    const std::vector<Point> &contour) const {
+    const ContourView &contour) const {
   if (contour.empty()) {
     return Point(0, 0);
   }
@@ -878,22 +1255,22 @@ Point RectangleDetector::CalculateContourCentroid(
   double centroidX = 0.0;
   double centroidY = 0.0;
 
-  for (size_t i = 0; i < contour.size(); ++i) {
-    const size_t j = (i + 1) % contour.size();
-    const double cross =
-        contour[i].x * contour[j].y - contour[j].x * contour[i].y;
+  const ContourSet::Coordinate *xs = contour.xs;
+  const ContourSet::Coordinate *ys = contour.ys;
+  for (size_t i = 0; i < contour.count; ++i) {
+    const double cross = xs[i] * ys[i + 1] - xs[i + 1] * ys[i];
     area += cross;
-    centroidX += (contour[i].x + contour[j].x) * cross;
-    centroidY += (contour[i].y + contour[j].y) * cross;
+    centroidX += (xs[i] + xs[i + 1]) * cross;
+    centroidY += (ys[i] + ys[i + 1]) * cross;
   }
 
   area *= 0.5;
 
   if (std::abs(area) < 1e-6) {
     double sumX = 0.0, sumY = 0.0;
-    for (const Point &p : contour) {
-      sumX += p.x;
-      sumY += p.y;
+    for (size_t i = 0; i < contour.count; ++i) {
+      sumX += xs[i];
+      sumY += ys[i];
     }
     const double size = static_cast<double>(contour.size());
     return Point(static_cast<int>(sumX / size), static_cast<int>(sumY / size));
@@ -904,13 +1281,35 @@ Point RectangleDetector::CalculateContourCentroid(
                static_cast<int>(centroidY * factor));
 }
 
-std::vector<Point>
-RectangleDetector::ConvexHull(std::vector<Point> points) const {
-  if (points.size() < 3)
-    return points;
+// hull must not be points
+void RectangleDetector::ConvexHull(const std::vector<Point> &points,
+                                   std::vector<Point> &hull) const {
+  if (points.size() < 3) {
+    hull = points;
+    return;
+  }
 
-  std::vector<Point> sortedPoints = points;
+  std::vector<Point> &sortedPoints = LocalBuffers().sorted;
+  sortedPoints = points;
+  SortedConvexHull(sortedPoints, hull);
+}
+
+void RectangleDetector::ConvexHull(const ContourView &points,
+                                   std::vector<Point> &hull) const {
+  std::vector<Point> &sortedPoints = LocalBuffers().sorted;
+  sortedPoints.clear();
+  for (size_t i = 0; i < points.count; ++i)
+    sortedPoints.emplace_back(points.xs[i], points.ys[i]);
+  if (sortedPoints.size() < 3) {
+    hull = sortedPoints;
+    return;
+  }
+  SortedConvexHull(sortedPoints, hull);
+}
 
+// hull must not be sortedPoints
+void RectangleDetector::SortedConvexHull(std::vector<Point> &sortedPoints,
+                                         std::vector<Point> &hull) const {
   // Sort points lexicographically (by x, then by y)
   std::sort(sortedPoints.begin(), sortedPoints.end(),
             [](const Point &a, const Point &b) {
@@ -918,8 +1317,8 @@ RectangleDetector::ConvexHull(std::vector<Point> points) const {
             });
 
   // Build lower hull
-  std::vector<Point> lower;
-  lower.reserve(sortedPoints.size() / 2);
+  std::vector<Point> &lower = hull;
+  lower.clear();
   for (const auto &p : sortedPoints) {
     while (lower.size() >= 2 &&
            Cross(lower[lower.size() - 2], lower[lower.size() - 1], p) <= 0) {
@@ -929,8 +1328,8 @@ RectangleDetector::ConvexHull(std::vector<Point> points) const {
   }
 
   // Build upper hull
-  std::vector<Point> upper;
-  upper.reserve(sortedPoints.size() / 2);
+  std::vector<Point> &upper = LocalBuffers().upper;
+  upper.clear();
   for (auto it = sortedPoints.rbegin(); it != sortedPoints.rend(); ++it) {
     while (upper.size() >= 2 &&
            Cross(upper[upper.size() - 2], upper[upper.size() - 1], *it) <= 0) {
@@ -945,8 +1344,6 @@ RectangleDetector::ConvexHull(std::vector<Point> points) const {
 
   // Concatenate lower and upper hull
   lower.insert(lower.end(), upper.begin(), upper.end());
-
-  return lower;
 }
 
 double RectangleDetector::Cross(const Point &O, const Point &A,
@@ -955,15 +1352,15 @@ double RectangleDetector::Cross(const Point &O, const Point &A,
 }
 
 // Rotation-invariant corner detection using curvature analysis
-std::vector<Point> RectangleDetector::FindCornersRotationInvariant(
-    const std::vector<Point> &contour) const {
+void RectangleDetector::FindCornersRotationInvariant(
+    const ContourView &contour, std::vector<Point> &corners) const {
+  corners.clear();
   if (contour.size() < 8)
-    return std::vector<Point>(); // Too few points for reliable curvature
-                                 // analysis
+    return; // Too few points for reliable curvature analysis
 
-  std::vector<Point> corners;
-  std::vector<double> curvatures;
-  curvatures.reserve(contour.size());
+  ClassifierBuffers &buffers = LocalBuffers();
+  std::vector<double> &curvatures = buffers.curvatures;
+  curvatures.clear();
 
   // Calculate curvature at each point
   for (size_t i = 0; i < contour.size(); ++i) {
@@ -973,7 +1370,8 @@ std::vector<Point> RectangleDetector::FindCornersRotationInvariant(
   }
 
   // Find local maxima in curvature (potential corners)
-  std::vector<std::pair<double, size_t>> curvaturePeaks;
+  std::vector<std::pair<double, size_t>> &curvaturePeaks = buffers.peaks;
+  curvaturePeaks.clear();
   const int minDistance =
       static_cast<int>(contour.size() / 12); // Minimum distance between corners
 
@@ -1001,7 +1399,8 @@ std::vector<Point> RectangleDetector::FindCornersRotationInvariant(
             std::greater<std::pair<double, size_t>>());
 
   // Extract the strongest corner candidates, ensuring minimum distance
-  std::vector<size_t> selectedIndices;
+  std::vector<size_t> &selectedIndices = buffers.indices;
+  selectedIndices.clear();
   for (const auto &peak : curvaturePeaks) {
     size_t currentIdx = peak.second;
     bool tooClose = false;
@@ -1035,12 +1434,10 @@ std::vector<Point> RectangleDetector::FindCornersRotationInvariant(
   for (size_t idx : selectedIndices) {
     corners.push_back(contour[idx]);
   }
-
-  return corners;
 }
 
 // Calculate curvature at a specific point using discrete approximation
-double RectangleDetector::CalculateCurvature(const std::vector<Point> &contour,
+double RectangleDetector::CalculateCurvature(const ContourView &contour,
                                              size_t index,
                                              int windowSize) const {
   if (contour.size() < 3 || windowSize < 1)
@@ -1050,15 +1447,11 @@ double RectangleDetector::CalculateCurvature(const std::vector<Point> &contour,
   const int prevIdx = (index - windowSize + n) % n;
   const int nextIdx = (index + windowSize) % n;
 
-  const Point &prev = contour[prevIdx];
-  const Point &curr = contour[index];
-  const Point &next = contour[nextIdx];
-
   // Calculate vectors
-  const double dx1 = curr.x - prev.x;
-  const double dy1 = curr.y - prev.y;
-  const double dx2 = next.x - curr.x;
-  const double dy2 = next.y - curr.y;
+  const double dx1 = contour.xs[index] - contour.xs[prevIdx];
+  const double dy1 = contour.ys[index] - contour.ys[prevIdx];
+  const double dx2 = contour.xs[nextIdx] - contour.xs[index];
+  const double dy2 = contour.ys[nextIdx] - contour.ys[index];
 
   // Calculate cross product (measures turn angle)
   const double cross = dx1 * dy2 - dy1 * dx2;
@@ -1075,13 +1468,15 @@ double RectangleDetector::CalculateCurvature(const std::vector<Point> &contour,
 }
 
 // Smooth contour to reduce staircase effects from pixel discretization
-std::vector<Point> RectangleDetector::SmoothContourForRotation(
-    const std::vector<Point> &contour) const {
-  if (contour.size() < 3)
-    return contour;
-
-  std::vector<Point> smoothed;
-  smoothed.reserve(contour.size());
+void RectangleDetector::SmoothContourForRotation(
+    const ContourView &contour, ContourSet &smoothed) const {
+  smoothed.Clear();
+  if (contour.size() < 3) {
+    for (size_t i = 0; i < contour.count; ++i)
+      smoothed.Push(contour.xs[i], contour.ys[i]);
+    smoothed.Close();
+    return;
+  }
 
   // Apply simple moving average to reduce pixel discretization artifacts
   const int windowSize = 3;
@@ -1091,33 +1486,36 @@ std::vector<Point> RectangleDetector::SmoothContourForRotation(
 
     for (int j = -windowSize; j <= windowSize; ++j) {
       size_t idx = (i + j + contour.size()) % contour.size();
-      sumX += contour[idx].x;
-      sumY += contour[idx].y;
+      sumX += contour.xs[idx];
+      sumY += contour.ys[idx];
       count++;
     }
 
-    smoothed.emplace_back(static_cast<int>(std::round(sumX / count)),
-                          static_cast<int>(std::round(sumY / count)));
+    smoothed.Push(static_cast<int>(std::round(sumX / count)),
+                  static_cast<int>(std::round(sumY / count)));
   }
-
-  return smoothed;
+  smoothed.Close();
 }
 
 // Find rectangle using Hough-like line detection approach
-std::vector<Point> RectangleDetector::FindRectangleUsingHoughLines(
-    const std::vector<Point> &contour) const {
+void RectangleDetector::FindRectangleUsingHoughLines(
+    const ContourView &contour, std::vector<Point> &corners) const {
+  corners.clear();
   if (contour.size() < 8)
-    return std::vector<Point>();
+    return;
 
   // Detect dominant lines in the contour
-  std::vector<std::pair<Point, Point>> lines = DetectLines(contour);
+  ClassifierBuffers &buffers = LocalBuffers();
+  std::vector<std::pair<Point, Point>> &lines = buffers.lines;
+  DetectLines(contour, lines);
 
   if (lines.size() < 4)
-    return std::vector<Point>();
+    return;
 
   // Find pairs of perpendicular lines - need exactly 4 that form a closed
   // rectangle
-  std::vector<std::pair<Point, Point>> selectedLines;
+  std::vector<std::pair<Point, Point>> &selectedLines = buffers.selectedLines;
+  selectedLines.clear();
 
   // First pass: find lines that could form a rectangle
   for (size_t i = 0; i < lines.size() && selectedLines.size() < 4; ++i) {
@@ -1153,9 +1551,6 @@ std::vector<Point> RectangleDetector::FindRectangleUsingHoughLines(
 
   // If we have exactly 4 lines that form a rectangle, find their intersections
   if (selectedLines.size() == 4) {
-    std::vector<Point> corners;
-    corners.reserve(4);
-
     // Find intersections of adjacent lines to form corners
     for (size_t i = 0; i < 4; ++i) {
       size_t nextIdx = (i + 1) % 4;
@@ -1182,20 +1577,21 @@ std::vector<Point> RectangleDetector::FindRectangleUsingHoughLines(
     }
 
     if (corners.size() == 4) {
-      return corners;
+      return;
     }
   }
 
-  return std::vector<Point>();
+  corners.clear();
 }
 
 // Detect dominant lines in contour using simplified Hough approach
-std::vector<std::pair<Point, Point>>
-RectangleDetector::DetectLines(const std::vector<Point> &contour) const {
-  std::vector<std::pair<Point, Point>> lines;
+void RectangleDetector::DetectLines(
+    const ContourView &contour,
+    std::vector<std::pair<Point, Point>> &lines) const {
+  lines.clear();
 
   if (contour.size() < 6)
-    return lines;
+    return;
 
   // Use sliding window to detect line segments
   const size_t windowSize = std::max(size_t(6), contour.size() / 8);
@@ -1212,11 +1608,12 @@ RectangleDetector::DetectLines(const std::vector<Point> &contour) const {
     size_t count = endIdx - i;
 
     for (size_t j = i; j < endIdx; ++j) {
-      size_t idx = j % contour.size();
-      sumX += contour[idx].x;
-      sumY += contour[idx].y;
-      sumXX += contour[idx].x * contour[idx].x;
-      sumXY += contour[idx].x * contour[idx].y;
+      const int x = contour.xs[j];
+      const int y = contour.ys[j];
+      sumX += x;
+      sumY += y;
+      sumXX += x * x;
+      sumXY += x * y;
     }
 
     double meanX = sumX / count;
@@ -1243,8 +1640,6 @@ RectangleDetector::DetectLines(const std::vector<Point> &contour) const {
       }
     }
   }
-
-  return lines;
 }
 
 // Check if two lines are perpendicular within tolerance
@@ -1279,25 +1674,25 @@ bool RectangleDetector::AreLinesPerpendicular(
 // Quick check if contour is likely circular to avoid Hough processing on
 // circles
 bool RectangleDetector::IsLikelyCircularContour(
-    const std::vector<Point> &contour) const {
+    const ContourView &contour) const {
   if (contour.size() < 8)
     return false;
 
   // Calculate center of mass
   double centerX = 0, centerY = 0;
-  for (const auto &point : contour) {
-    centerX += point.x;
-    centerY += point.y;
+  for (size_t i = 0; i < contour.count; ++i) {
+    centerX += contour.xs[i];
+    centerY += contour.ys[i];
   }
   centerX /= contour.size();
   centerY /= contour.size();
 
   // Calculate distances from center
-  std::vector<double> distances;
-  distances.reserve(contour.size());
-  for (const auto &point : contour) {
-    double dx = point.x - centerX;
-    double dy = point.y - centerY;
+  std::vector<double> &distances = LocalBuffers().distances;
+  distances.clear();
+  for (size_t i = 0; i < contour.count; ++i) {
+    double dx = contour.xs[i] - centerX;
+    double dy = contour.ys[i] - centerY;
     distances.push_back(std::sqrt(dx * dx + dy * dy));
   }
 
@@ -1319,26 +1714,28 @@ bool RectangleDetector::IsLikelyCircularContour(
 
   // If standard deviation is small relative to mean distance, it's likely
   // circular
-  return (stdDev / meanDist) < 0.15;
+  return (stdDev / meanDist) < RADIAL_SPREAD_LIMIT;
 }
 
 // Moment-based rectangle detection - completely rotation invariant
-std::vector<Point> RectangleDetector::FindRectangleCornersMomentBased(
-    const std::vector<Point> &contour) const {
+void RectangleDetector::FindRectangleCornersMomentBased(
+    const ContourView &contour, std::vector<Point> &corners) const {
+  corners.clear();
   if (contour.size() < 8)
-    return std::vector<Point>();
+    return;
 
   // First check if this is actually rectangular using Hu moments
   if (!IsRectangleUsingMoments(contour)) {
-    return std::vector<Point>();
+    return;
   }
 
   // Calculate principal orientation
   double orientation = CalculateOrientation(contour);
 
   // Rotate contour to canonical position (axis-aligned)
-  std::vector<Point> rotatedContour =
-      RotateContourToCanonical(contour, -orientation);
+  ClassifierBuffers &buffers = LocalBuffers();
+  std::vector<Point> &rotatedContour = buffers.rotated;
+  RotateContourToCanonical(contour, -orientation, rotatedContour);
 
   // Find bounding box of rotated contour with enhanced precision
   int minX = rotatedContour[0].x, maxX = rotatedContour[0].x;
@@ -1359,19 +1756,21 @@ std::vector<Point> RectangleDetector::FindRectangleCornersMomentBased(
   maxY += margin;
 
   // Create canonical rectangle corners with enhanced positioning
-  std::vector<Point> canonicalCorners = {Point(minX, minY), Point(maxX, minY),
-                                         Point(maxX, maxY), Point(minX, maxY)};
+  ContourSet &canonicalCorners = buffers.canonical;
+  canonicalCorners.Clear();
+  canonicalCorners.Push(minX, minY);
+  canonicalCorners.Push(maxX, minY);
+  canonicalCorners.Push(maxX, maxY);
+  canonicalCorners.Push(minX, maxY);
+  canonicalCorners.Close();
 
   // Rotate corners back to original orientation
-  std::vector<Point> corners =
-      RotateContourToCanonical(canonicalCorners, orientation);
-
-  return corners;
+  RotateContourToCanonical(canonicalCorners.View(0), orientation, corners);
 }
 
 // Check if shape is rectangular using rotation-invariant Hu moments
 bool RectangleDetector::IsRectangleUsingMoments(
-    const std::vector<Point> &contour) const {
+    const ContourView &contour) const {
   if (contour.size() < 8)
     return false;
 
@@ -1426,9 +1825,9 @@ bool RectangleDetector::IsRectangleUsingMoments(
     // Additional shape analysis for borderline cases
     Point centroid = CalculateCentroid(contour);
     double maxDist = 0.0;
-    for (const Point &p : contour) {
-      double dist = std::sqrt(std::pow(p.x - centroid.x, 2) +
-                              std::pow(p.y - centroid.y, 2));
+    for (size_t i = 0; i < contour.count; ++i) {
+      double dist = std::sqrt(std::pow(contour.xs[i] - centroid.x, 2) +
+                              std::pow(contour.ys[i] - centroid.y, 2));
       maxDist = std::max(maxDist, dist);
     }
     double compactness = area / (std::numbers::pi * maxDist * maxDist);
@@ -1445,7 +1844,7 @@ bool RectangleDetector::IsRectangleUsingMoments(
 }
 
 // Calculate normalized central moment (Hu moment component)
-double RectangleDetector::CalculateHuMoment(const std::vector<Point> &contour,
+double RectangleDetector::CalculateHuMoment(const ContourView &contour,
                                             int p, int q) const {
   if (contour.empty())
     return 0.0;
@@ -1454,9 +1853,9 @@ double RectangleDetector::CalculateHuMoment(const std::vector<Point> &contour,
 
   // Calculate central moment
   double moment = 0.0;
-  for (const auto &point : contour) {
-    double x = point.x - centroid.x;
-    double y = point.y - centroid.y;
+  for (size_t i = 0; i < contour.count; ++i) {
+    double x = contour.xs[i] - centroid.x;
+    double y = contour.ys[i] - centroid.y;
     moment += std::pow(x, p) * std::pow(y, q);
   }
 
@@ -1471,15 +1870,14 @@ double RectangleDetector::CalculateHuMoment(const std::vector<Point> &contour,
 }
 
 // Calculate centroid of contour
-Point RectangleDetector::CalculateCentroid(
-    const std::vector<Point> &contour) const {
+Point RectangleDetector::CalculateCentroid(const ContourView &contour) const {
   if (contour.empty())
     return Point(0, 0);
 
   double sumX = 0, sumY = 0;
-  for (const auto &point : contour) {
-    sumX += point.x;
-    sumY += point.y;
+  for (size_t i = 0; i < contour.count; ++i) {
+    sumX += contour.xs[i];
+    sumY += contour.ys[i];
   }
 
   return Point(static_cast<int>(std::round(sumX / contour.size())),
@@ -1488,7 +1886,7 @@ Point RectangleDetector::CalculateCentroid(
 
 // Calculate principal orientation using second moments
 double RectangleDetector::CalculateOrientation(
-    const std::vector<Point> &contour) const {
+    const ContourView &contour) const {
   if (contour.size() < 3)
     return 0.0;
 
@@ -1497,9 +1895,9 @@ double RectangleDetector::CalculateOrientation(
   // Calculate second central moments
   double m20 = 0, m02 = 0, m11 = 0;
 
-  for (const auto &point : contour) {
-    double x = point.x - centroid.x;
-    double y = point.y - centroid.y;
+  for (size_t i = 0; i < contour.count; ++i) {
+    double x = contour.xs[i] - centroid.x;
+    double y = contour.ys[i] - centroid.y;
 
     m20 += x * x;
     m02 += y * y;
@@ -1511,29 +1909,33 @@ double RectangleDetector::CalculateOrientation(
     return 0.0; // Already axis-aligned
   }
 
-  return 0.5 * std::atan2(2.0 * m11, m20 - m02);
+  return 0.5 * FastMath::Atan2(2.0 * m11, m20 - m02);
 }
 
 // Rotate contour points by given angle around centroid with enhanced precision
-std::vector<Point>
-RectangleDetector::RotateContourToCanonical(const std::vector<Point> &contour,
-                                            double angle) const {
-  if (contour.empty() || std::abs(angle) < EPSILON_TOLERANCE)
-    return contour;
+void RectangleDetector::RotateContourToCanonical(
+    const ContourView &contour, double angle,
+    std::vector<Point> &rotated) const {
+  rotated.clear();
+  if (contour.empty() || std::abs(angle) < EPSILON_TOLERANCE) {
+    for (size_t i = 0; i < contour.count; ++i)
+      rotated.push_back(contour[i]);
+    return;
+  }
 
   Point centroid = CalculateCentroid(contour);
-  std::vector<Point> rotated;
-  rotated.reserve(contour.size());
 
   // Use higher precision rotation for critical angles
-  double cosAngle = std::cos(angle);
-  double sinAngle = std::sin(angle);
+  double sinAngle, cosAngle;
+  FastMath::SinCos(angle, sinAngle, cosAngle);
 
   // Apply smoothing for better rotation accuracy at steep angles
-  for (const auto &point : contour) {
+  for (size_t i = 0; i < contour.count; ++i) {
     // Translate to origin with subpixel precision
-    double x = static_cast<double>(point.x) - static_cast<double>(centroid.x);
-    double y = static_cast<double>(point.y) - static_cast<double>(centroid.y);
+    double x = static_cast<double>(contour.xs[i]) -
+               static_cast<double>(centroid.x);
+    double y = static_cast<double>(contour.ys[i]) -
+               static_cast<double>(centroid.y);
 
     // Rotate with high precision
     double rotX = x * cosAngle - y * sinAngle;
@@ -1545,73 +1947,12 @@ RectangleDetector::RotateContourToCanonical(const std::vector<Point> &contour,
                          static_cast<int>(std::floor(
                              rotY + static_cast<double>(centroid.y) + 0.5)));
   }
-
-  return rotated;
-}
-
-// Apply Gaussian blur for image smoothing
-Image RectangleDetector::ApplyGaussianBlur(const Image &image,
-                                           double sigma) const {
-  if (sigma <= 0.1)
-    return image; // Skip blur if sigma is too small
-
-  Image result = image;
-
-  // Calculate kernel size (should be odd)
-  int kernelSize = static_cast<int>(2 * std::ceil(3 * sigma) + 1);
-  if (kernelSize % 2 == 0)
-    kernelSize++;
-  int halfKernel = kernelSize / 2;
-
-  // Create Gaussian kernel
-  std::vector<double> kernel(kernelSize);
-  double sum = 0.0;
-  for (int i = 0; i < kernelSize; ++i) {
-    int x = i - halfKernel;
-    kernel[i] = std::exp(-(x * x) / (2 * sigma * sigma));
-    sum += kernel[i];
-  }
-
-  // Normalize kernel
-  for (double &k : kernel) {
-    k /= sum;
-  }
-
-  // Apply horizontal blur
-  Image temp = image;
-#pragma omp parallel for
-  for (int y = 0; y < image.height; ++y) {
-    for (int x = 0; x < image.width; ++x) {
-      double blurredValue = 0.0;
-      for (int k = 0; k < kernelSize; ++k) {
-        int sourceX = x + k - halfKernel;
-        sourceX = std::max(0, std::min(sourceX, image.width - 1)); // Clamp
-        blurredValue += image.pixels[y][sourceX] * kernel[k];
-      }
-      temp.pixels[y][x] = static_cast<int>(std::round(blurredValue));
-    }
-  }
-
-// Apply vertical blur
-#pragma omp parallel for
-  for (int y = 0; y < image.height; ++y) {
-    for (int x = 0; x < image.width; ++x) {
-      double blurredValue = 0.0;
-      for (int k = 0; k < kernelSize; ++k) {
-        int sourceY = y + k - halfKernel;
-        sourceY = std::max(0, std::min(sourceY, image.height - 1)); // Clamp
-        blurredValue += temp.pixels[sourceY][x] * kernel[k];
-      }
-      result.pixels[y][x] = static_cast<int>(std::round(blurredValue));
-    }
-  }
-
-  return result;
 }
 
 // Remove duplicate rectangles (simplified since we're using single-scale)
 void RectangleDetector::RemoveDuplicateRectangles(
     std::vector<Rectangle> &rectangles) const {
+  TRACE_SPAN("RemoveDuplicateRectangles", "nms");
   if (rectangles.size() <= 1)
     return;
 
@@ -1621,7 +1962,8 @@ void RectangleDetector::RemoveDuplicateRectangles(
               return a.width * a.height > b.width * b.height;
             });
 
-  std::vector<bool> toRemove(rectangles.size(), false);
+  std::vector<bool> &toRemove = frame_->duplicates;
+  toRemove.assign(rectangles.size(), false);
 
   for (size_t i = 0; i < rectangles.size(); ++i) {
     if (toRemove[i])
@@ -1653,10 +1995,8 @@ void RectangleDetector::RemoveDuplicateRectangles(
                                                         rectangles[j].height));
 
         // Also check angle similarity for rotated rectangles
-        double angleDiff = std::abs(rectangles[i].angle - rectangles[j].angle);
-        while (angleDiff > std::numbers::pi)
-          angleDiff -= std::numbers::pi;
-        angleDiff = std::min(angleDiff, std::numbers::pi - angleDiff);
+        const double angleDiff = FastMath::LineAngleDifference(
+            rectangles[i].angle, rectangles[j].angle);
 
         if (sizeRatio > 0.4 || angleDiff < 0.2) { // More aggressive removal
           toRemove[j] = true;                     // Remove smaller/later one
@@ -1675,228 +2015,56 @@ void RectangleDetector::RemoveDuplicateRectangles(
 }
 
 // Enhanced preprocessing for steep angles
-Image RectangleDetector::PreprocessImageEnhanced(const Image &image) const {
-  Image result = image;
-
-  // Apply edge enhancement before thresholding
-  Image enhanced(image.width, image.height);
-
-// Sobel edge detection for better edge preservation
-#pragma omp parallel for
-  for (int y = 1; y < image.height - 1; ++y) {
-    for (int x = 1; x < image.width - 1; ++x) {
-      // Sobel X kernel
-      int gx = -image.pixels[y - 1][x - 1] + image.pixels[y - 1][x + 1] +
-               -2 * image.pixels[y][x - 1] + 2 * image.pixels[y][x + 1] +
-               -image.pixels[y + 1][x - 1] + image.pixels[y + 1][x + 1];
-
-      // Sobel Y kernel
-      int gy = -image.pixels[y - 1][x - 1] - 2 * image.pixels[y - 1][x] -
-               image.pixels[y - 1][x + 1] + image.pixels[y + 1][x - 1] +
-               2 * image.pixels[y + 1][x] + image.pixels[y + 1][x + 1];
-
-      int magnitude = static_cast<int>(std::sqrt(gx * gx + gy * gy));
-      enhanced.pixels[y][x] = std::min(255, magnitude);
-    }
-  }
-
-  // Apply light Gaussian blur to reduce noise
-  Image blurred = ApplyGaussianBlur(enhanced, 0.5);
-
-// Enhanced thresholding with higher threshold for edges
-#pragma omp parallel for
-  for (int y = 0; y < blurred.height; ++y) {
-    for (int x = 0; x < blurred.width; ++x) {
-      result.pixels[y][x] = (blurred.pixels[y][x] > 100) ? 255 : 0;
-    }
-  }
-
-  return result;
+void RectangleDetector::PreprocessImageEnhanced(const Image &image,
+                                                Image &output) const {
+  TRACE_SPAN("PreprocessImageEnhanced", "kernel");
+  using P = PixelPipeline;
+
+  // Sobel edge magnitude for better edge preservation, a light blur to
+  // reduce noise, then a higher threshold for edges
+  P::Evaluate(
+      P::Threshold(P::GaussianBlur<0.5>(P::Sobel(P::Input(image))), 100),
+      output);
 }
 
 // Morphological preprocessing for broken contours
-Image RectangleDetector::PreprocessImageMorphological(
-    const Image &image) const {
-  Image result = image;
-
-// Standard thresholding first
-#pragma omp parallel for
-  for (int y = 0; y < image.height; ++y) {
-    for (int x = 0; x < image.width; ++x) {
-      result.pixels[y][x] = (image.pixels[y][x] > 127) ? 255 : 0;
-    }
-  }
-
-  // Apply morphological closing to connect broken rectangle edges
-  Image closed = ApplyMorphologyClose(result, 2);
-
-  // Apply morphological opening to remove small noise
-  Image opened = ApplyMorphologyOpen(closed, 1);
-
-  return opened;
-}
-
-// Morphological closing operation
-Image RectangleDetector::ApplyMorphologyClose(const Image &image,
-                                              int kernelSize) const {
-  if (kernelSize < 1)
-    return image;
-
-  // Closing = Dilation followed by Erosion
-  Image dilated = image;
-  Image result = image;
-
-  int halfKernel = kernelSize / 2;
-
-// Dilation
-#pragma omp parallel for
-  for (int y = halfKernel; y < image.height - halfKernel; ++y) {
-    for (int x = halfKernel; x < image.width - halfKernel; ++x) {
-      int maxVal = 0;
-      for (int dy = -halfKernel; dy <= halfKernel; ++dy) {
-        for (int dx = -halfKernel; dx <= halfKernel; ++dx) {
-          maxVal = std::max(maxVal, image.pixels[y + dy][x + dx]);
-        }
-      }
-      dilated.pixels[y][x] = maxVal;
-    }
-  }
-
-// Erosion
-#pragma omp parallel for
-  for (int y = halfKernel; y < image.height - halfKernel; ++y) {
-    for (int x = halfKernel; x < image.width - halfKernel; ++x) {
-      int minVal = 255;
-      for (int dy = -halfKernel; dy <= halfKernel; ++dy) {
-        for (int dx = -halfKernel; dx <= halfKernel; ++dx) {
-          minVal = std::min(minVal, dilated.pixels[y + dy][x + dx]);
-        }
-      }
-      result.pixels[y][x] = minVal;
-    }
-  }
-
-  return result;
-}
-
-// Morphological opening operation
-Image RectangleDetector::ApplyMorphologyOpen(const Image &image,
-                                             int kernelSize) const {
-  if (kernelSize < 1)
-    return image;
-
-  // Opening = Erosion followed by Dilation
-  Image eroded = image;
-  Image result = image;
-
-  int halfKernel = kernelSize / 2;
-
-// Erosion
-#pragma omp parallel for
-  for (int y = halfKernel; y < image.height - halfKernel; ++y) {
-    for (int x = halfKernel; x < image.width - halfKernel; ++x) {
-      int minVal = 255;
-      for (int dy = -halfKernel; dy <= halfKernel; ++dy) {
-        for (int dx = -halfKernel; dx <= halfKernel; ++dx) {
-          minVal = std::min(minVal, image.pixels[y + dy][x + dx]);
-        }
-      }
-      eroded.pixels[y][x] = minVal;
-    }
-  }
-
-// Dilation
-#pragma omp parallel for
-  for (int y = halfKernel; y < image.height - halfKernel; ++y) {
-    for (int x = halfKernel; x < image.width - halfKernel; ++x) {
-      int maxVal = 0;
-      for (int dy = -halfKernel; dy <= halfKernel; ++dy) {
-        for (int dx = -halfKernel; dx <= halfKernel; ++dx) {
-          maxVal = std::max(maxVal, eroded.pixels[y + dy][x + dx]);
-        }
-      }
-      result.pixels[y][x] = maxVal;
-    }
-  }
-
-  return result;
+void RectangleDetector::PreprocessImageMorphological(const Image &image,
+                                                     Image &output) const {
+  TRACE_SPAN("PreprocessImageMorphological", "kernel");
+  using P = PixelPipeline;
+
+  // Standard threshold, then a 3x3 closing (dilation followed by erosion)
+  // to connect broken rectangle edges. The 1x1 opening that used to
+  // follow leaves every pixel as it is.
+  P::Evaluate(P::Erode<3>(P::Dilate<3>(P::Threshold(P::Input(image), 127))),
+              output);
 }
 
 // Multi-threshold preprocessing for critical angles
-Image RectangleDetector::PreprocessImageMultiThreshold(
-    const Image &image) const {
-  Image result = image;
-
-  // Apply adaptive thresholding for better edge preservation at steep angles
-  Image blurred = ApplyGaussianBlur(image, 1.2);
-
-// Use lower threshold to catch more edge pixels at difficult angles
-#pragma omp parallel for
-  for (int y = 0; y < blurred.height; ++y) {
-    for (int x = 0; x < blurred.width; ++x) {
-      result.pixels[y][x] = (blurred.pixels[y][x] > 110) ? 255 : 0;
-    }
-  }
-
-  return result;
+void RectangleDetector::PreprocessImageMultiThreshold(const Image &image,
+                                                      Image &output) const {
+  TRACE_SPAN("PreprocessImageMultiThreshold", "kernel");
+  using P = PixelPipeline;
+
+  // Wider blur with a lower threshold to catch more edge pixels at
+  // difficult angles
+  P::Evaluate(P::Threshold(P::GaussianBlur<1.2>(P::Input(image)), 110),
+              output);
 }
 
 // Aggressive preprocessing for problematic angles (105°, 110°, 130°, 145°,
 // 160°, 165°)
-Image RectangleDetector::PreprocessImageAggressive(const Image &image) const {
-  Image result = image;
-
-  // Apply median filter to reduce noise while preserving edges
-  Image median = image;
-#pragma omp parallel for
-  for (int y = 1; y < image.height - 1; ++y) {
-    for (int x = 1; x < image.width - 1; ++x) {
-      std::vector<int> values;
-      for (int dy = -1; dy <= 1; ++dy) {
-        for (int dx = -1; dx <= 1; ++dx) {
-          values.push_back(image.pixels[y + dy][x + dx]);
-        }
-      }
-      std::sort(values.begin(), values.end());
-      median.pixels[y][x] = values[4]; // Median of 9 values
-    }
-  }
-
-  // Apply bilateral-like filtering to preserve edges
-  Image filtered = median;
-#pragma omp parallel for
-  for (int y = 2; y < image.height - 2; ++y) {
-    for (int x = 2; x < image.width - 2; ++x) {
-      int sum = 0;
-      int count = 0;
-      int centerVal = median.pixels[y][x];
-
-      for (int dy = -2; dy <= 2; ++dy) {
-        for (int dx = -2; dx <= 2; ++dx) {
-          int val = median.pixels[y + dy][x + dx];
-          int diff = std::abs(val - centerVal);
-          if (diff < 50) { // Only include similar intensity pixels
-            sum += val;
-            count++;
-          }
-        }
-      }
-
-      if (count > 0) {
-        filtered.pixels[y][x] = sum / count;
-      }
-    }
-  }
-
-// Very aggressive thresholding to capture weak edges
-#pragma omp parallel for
-  for (int y = 0; y < filtered.height; ++y) {
-    for (int x = 0; x < filtered.width; ++x) {
-      result.pixels[y][x] = (filtered.pixels[y][x] > 100) ? 255 : 0;
-    }
-  }
-
-  return result;
+void RectangleDetector::PreprocessImageAggressive(const Image &image,
+                                                  Image &output) const {
+  TRACE_SPAN("PreprocessImageAggressive", "kernel");
+  using P = PixelPipeline;
+
+  // Median filter to reduce noise while preserving edges, bilateral-like
+  // averaging of the pixels of similar intensity, then a very aggressive
+  // threshold to capture weak edges
+  P::Evaluate(
+      P::Threshold(P::RangeMean<5>(P::Median<3>(P::Input(image)), 50), 100),
+      output);
 }
 
 // Simplified Hough line-based rectangle detection for critical angles
@@ -0,0 +1,233 @@
+#include "ShapeDetector/SceneGenerator.hpp"
+#include "ShapeDetector/Rasterizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <omp.h>
+#include <random>
+
+namespace {
+
+// mt19937_64 output is fixed by the standard, but the std distributions are
+// not; map raw outputs ourselves so scenes are identical on every platform
+class SceneRandom {
+public:
+  explicit SceneRandom(uint64_t seed) : engine_(Mix(seed)) {}
+
+  int Int(int lo, int hi) {
+    if (hi <= lo)
+      return lo;
+    return lo + static_cast<int>(engine_() % static_cast<uint64_t>(hi - lo + 1));
+  }
+
+  double Real(double lo, double hi) {
+    return lo + (hi - lo) * ((engine_() >> 11) * 0x1.0p-53);
+  }
+
+private:
+  // SplitMix64 finalizer so consecutive seeds give unrelated streams
+  static uint64_t Mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  std::mt19937_64 engine_;
+};
+
+// Uniform grid of placed bounding circles. Cells are at least as large as
+// the biggest possible exclusion distance, so a candidate only has to be
+// checked against its own and the eight neighbouring cells.
+class PlacementGrid {
+public:
+  PlacementGrid(int width, int height, int cellSize)
+      : cellSize_(std::max(1, cellSize)),
+        columns_(width / cellSize_ + 1), rows_(height / cellSize_ + 1),
+        heads_(static_cast<size_t>(columns_) * rows_, -1) {}
+
+  bool Fits(double x, double y, double radius, double spacing) const {
+    const int cx = static_cast<int>(x) / cellSize_;
+    const int cy = static_cast<int>(y) / cellSize_;
+
+    for (int gy = std::max(0, cy - 1); gy <= std::min(rows_ - 1, cy + 1); ++gy) {
+      for (int gx = std::max(0, cx - 1); gx <= std::min(columns_ - 1, cx + 1);
+           ++gx) {
+        for (int i = heads_[gy * columns_ + gx]; i >= 0; i = next_[i]) {
+          const Circle &c = circles_[i];
+          const double minDistance = radius + c.radius + spacing;
+          const double dx = x - c.x;
+          const double dy = y - c.y;
+          if (dx * dx + dy * dy < minDistance * minDistance)
+            return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void Insert(double x, double y, double radius) {
+    const int cell = (static_cast<int>(y) / cellSize_) * columns_ +
+                     static_cast<int>(x) / cellSize_;
+    circles_.push_back({x, y, radius});
+    next_.push_back(heads_[cell]);
+    heads_[cell] = static_cast<int>(circles_.size()) - 1;
+  }
+
+private:
+  struct Circle {
+    double x, y, radius;
+  };
+
+  int cellSize_;
+  int columns_, rows_;
+  std::vector<int> heads_; // first circle in each cell, -1 when empty
+  std::vector<int> next_;  // intrusive per-cell linked lists
+  std::vector<Circle> circles_;
+};
+
+enum class ShapeKind { Rectangle, Circle, Ellipse, Distractor };
+
+} // namespace
+
+SceneGenerator::SceneGenerator(const SceneConfig &config) : config_(config) {}
+
+Scene SceneGenerator::Generate(uint64_t seed) const {
+  const SceneConfig &cfg = config_;
+  Scene scene(cfg.width, cfg.height);
+  SceneRandom random(seed);
+
+  if (cfg.background != 0) {
+    for (auto &row : scene.image.pixels) {
+      std::fill(row.begin(), row.end(), cfg.background);
+    }
+  }
+
+  const int minSize = std::max(4, cfg.minSize);
+  const int maxSize = std::max(minSize, cfg.maxSize);
+
+  // Interleave shape kinds so no kind is starved when the frame fills up
+  std::vector<ShapeKind> order;
+  order.insert(order.end(), std::max(0, cfg.rectangleCount),
+               ShapeKind::Rectangle);
+  order.insert(order.end(), std::max(0, cfg.circleCount), ShapeKind::Circle);
+  order.insert(order.end(), std::max(0, cfg.ellipseCount), ShapeKind::Ellipse);
+  order.insert(order.end(), std::max(0, cfg.distractorCount),
+               ShapeKind::Distractor);
+  for (size_t i = order.size(); i > 1; --i) {
+    std::swap(order[i - 1], order[random.Int(0, static_cast<int>(i) - 1)]);
+  }
+
+  scene.rectangles.reserve(cfg.rectangleCount);
+  scene.circles.reserve(cfg.circleCount);
+  scene.ellipses.reserve(cfg.ellipseCount);
+  scene.distractors.reserve(cfg.distractorCount);
+
+  // Largest bounding circle is a square of maxSize seen along its diagonal
+  const double maxRadius = maxSize * std::numbers::sqrt2 / 2.0;
+  PlacementGrid grid(cfg.width, cfg.height,
+                     static_cast<int>(std::ceil(2 * maxRadius)) + cfg.spacing);
+
+  std::vector<Span> spans;
+  for (ShapeKind kind : order) {
+    for (int attempt = 0; attempt < cfg.maxAttempts; ++attempt) {
+      // Draw the shape parameters first, then its bounding circle
+      int width = 0, height = 0;
+      double angle = 0.0, boundRadius = 0.0;
+
+      switch (kind) {
+      case ShapeKind::Rectangle:
+        width = random.Int(minSize, maxSize);
+        height = random.Int(minSize, width);
+        angle = random.Real(0.0, std::numbers::pi);
+        boundRadius = std::sqrt(width * width + height * height) / 2.0;
+        break;
+      case ShapeKind::Circle:
+        width = random.Int(minSize / 2, maxSize / 2);
+        boundRadius = width;
+        break;
+      case ShapeKind::Ellipse:
+        width = random.Int(minSize / 2, maxSize / 2);
+        height = random.Int(std::max(2, minSize / 4), std::max(2, width * 2 / 3));
+        angle = random.Real(0.0, std::numbers::pi);
+        boundRadius = width;
+        break;
+      case ShapeKind::Distractor:
+        boundRadius = random.Int(minSize / 2, maxSize / 2);
+        angle = random.Real(0.0, 2 * std::numbers::pi);
+        break;
+      }
+
+      const int margin = static_cast<int>(std::ceil(boundRadius)) + 1;
+      if (2 * margin >= cfg.width || 2 * margin >= cfg.height)
+        continue;
+
+      const int cx = random.Int(margin, cfg.width - margin - 1);
+      const int cy = random.Int(margin, cfg.height - margin - 1);
+      if (!grid.Fits(cx, cy, boundRadius, cfg.spacing))
+        continue;
+
+      grid.Insert(cx, cy, boundRadius);
+      spans.clear();
+
+      switch (kind) {
+      case ShapeKind::Rectangle: {
+        // Exact corners, not rounded ones, so truth matches the pixels
+        const double c = std::cos(angle), s = std::sin(angle);
+        const double hw = width / 2.0, hh = height / 2.0;
+        const std::pair<double, double> quad[4] = {
+            {cx - hw * c + hh * s, cy - hw * s - hh * c},
+            {cx + hw * c + hh * s, cy + hw * s - hh * c},
+            {cx + hw * c - hh * s, cy + hw * s + hh * c},
+            {cx - hw * c - hh * s, cy - hw * s + hh * c}};
+        Rasterizer::ConvexPolygon(quad, 4, cfg.width, cfg.height, spans);
+        scene.rectangles.push_back({Point(cx, cy), width, height, angle});
+        break;
+      }
+      case ShapeKind::Circle:
+        Rasterizer::FilledCircle(cx, cy, width, cfg.width, cfg.height, spans);
+        scene.circles.push_back({Point(cx, cy), width, 1.0});
+        break;
+      case ShapeKind::Ellipse:
+        Rasterizer::FilledEllipse(cx, cy, width, height, angle, cfg.width,
+                                  cfg.height, spans);
+        scene.ellipses.push_back({Point(cx, cy), width, height, angle});
+        break;
+      case ShapeKind::Distractor: {
+        // Irregular triangle with vertices on the bounding circle
+        std::array<Point, 3> triangle;
+        std::pair<double, double> vertices[3];
+        for (int v = 0; v < 3; ++v) {
+          const double theta = angle + v * 2.0 * std::numbers::pi / 3.0 +
+                               random.Real(-0.5, 0.5);
+          triangle[v] = Point(
+              cx + static_cast<int>(std::lround(boundRadius * std::cos(theta))),
+              cy + static_cast<int>(std::lround(boundRadius * std::sin(theta))));
+          vertices[v] = {static_cast<double>(triangle[v].x),
+                         static_cast<double>(triangle[v].y)};
+        }
+        Rasterizer::ConvexPolygon(vertices, 3, cfg.width, cfg.height, spans);
+        scene.distractors.push_back(triangle);
+        break;
+      }
+      }
+
+      Rasterizer::FillSpans(scene.image, spans, cfg.foreground);
+      break;
+    }
+  }
+
+  return scene;
+}
+
+std::vector<Scene> SceneGenerator::GenerateBatch(uint64_t firstSeed,
+                                                 int count) const {
+  std::vector<Scene> scenes(std::max(0, count), Scene(0, 0));
+
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < count; ++i) {
+    scenes[i] = Generate(firstSeed + static_cast<uint64_t>(i));
+  }
+
+  return scenes;
+}
@@ -1,9 +1,17 @@
 #include "ShapeDetector/SphereDetector.hpp"
+#include "ShapeDetector/AllocationTracker.hpp"
+#include "ShapeDetector/ContourSet.hpp"
+#include "ShapeDetector/GeometryPolicy.hpp"
+#include "ShapeDetector/ImageProcessor.hpp"
+#include "ShapeDetector/PixelPipeline.hpp"
+#include "ShapeDetector/Trace.hpp"
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <numbers>
 #include <omp.h>
+#include <optional>
 #include <queue>
 #include <stack>
 #include <unordered_set>
@@ -12,8 +20,37 @@ constexpr double MIN_DISTANCE_SQUARED = 4.0;
 constexpr double EPSILON_TOLERANCE = 1e-9;
 constexpr double PI = std::numbers::pi;
 
+namespace {
+
+// Distance of a contour point from a center, in the geometry precision of
+// the build
+double Distance(const ContourView &contour, size_t i, const Point &center) {
+  using Real = GeometryTypes<GEOMETRY_PRECISION>::Real;
+  const Real dx = static_cast<Real>(contour.xs[i] - center.x);
+  const Real dy = static_cast<Real>(contour.ys[i] - center.y);
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+} // namespace
+
+// Buffers of one frame, kept by the detector between calls. They grow to
+// the largest frame seen, after which detecting at that resolution
+// allocates nothing.
+struct ObloidDetector::FrameBuffers {
+  Image processed{0, 0};
+  ContourSet contours;
+  std::vector<std::vector<bool>> visited;
+  std::vector<Point> region;
+  std::vector<ScanlineSegment> segments;
+  std::vector<Obloid> candidates;
+  std::vector<char> accepted;
+  std::vector<bool> duplicates;
+  std::vector<Obloid> found;
+};
+
 ObloidDetector::ObloidDetector()
-    : minRadius_(10), maxRadius_(100), circularityThreshold_(0.8), confidenceThreshold_(0.7) {
+    : minRadius_(10), maxRadius_(100), circularityThreshold_(0.8), confidenceThreshold_(0.7),
+      frame_(std::make_unique<FrameBuffers>()) {
   // Pre-allocate caches for better performance
   distanceCache_.reserve(1000);
   radiusCache_.reserve(100);
@@ -35,24 +72,79 @@ void ObloidDetector::SetConfidenceThreshold(double threshold) {
 
 std::vector<Obloid> ObloidDetector::DetectObloids(const Image &image) {
   std::vector<Obloid> obloids;
+  Detect(image, nullptr, obloids);
+  return obloids;
+}
+
+void ObloidDetector::DetectObloids(const Image &image,
+                                   std::vector<Obloid> &obloids) {
+  Detect(image, nullptr, obloids);
+}
+
+std::vector<Obloid> ObloidDetector::DetectObloids(const Image &image,
+                                                  DetectionStats &stats) {
+  std::vector<Obloid> obloids;
+  Detect(image, &stats, obloids);
+  return obloids;
+}
+
+std::vector<Obloid> ObloidDetector::DetectObloids(
+    const Image &image, const std::vector<RegionOfInterest> &regions) {
+  return DetectInRegions(image, regions, nullptr);
+}
+
+std::vector<Obloid> ObloidDetector::DetectObloids(
+    const Image &image, const std::vector<RegionOfInterest> &regions,
+    DetectionStats &stats) {
+  return DetectInRegions(image, regions, &stats);
+}
+
+void ObloidDetector::Detect(const Image &image, DetectionStats *stats,
+                            std::vector<Obloid> &obloids) {
+  TRACE_SPAN("DetectObloids", "detect");
+  obloids.clear();
   obloids.reserve(20);
 
+  stats_ = DETECTION_STATS_ENABLED ? stats : nullptr;
+  using Clock = std::chrono::steady_clock;
+  auto now = [this] { return stats_ ? Clock::now() : Clock::time_point(); };
+  auto milliseconds = [](Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+  };
+  const Clock::time_point start = now();
+  std::optional<AllocationScope> allocations;
+  if (stats_)
+    allocations.emplace();
+
   // Preprocess image for obloid detection
-  Image processed = PreprocessImage(image);
-  std::vector<std::vector<Point>> contours = FindContours(processed);
+  Image &processed = frame_->processed;
+  processed.Resize(image.width, image.height);
+  PreprocessImage(image, processed);
+  const Clock::time_point preprocessed = now();
+  ContourSet &contours = frame_->contours;
+  FindContours(processed, contours);
+  const Clock::time_point traced = now();
 
   // Process contours to find obloids
-  if (contours.size() > 10) {
-    // Parallel processing for large number of contours
-    std::vector<Obloid> tempObloids(contours.size());
-    std::vector<bool> validObloids(contours.size(), false);
-
+  if (contours.Size() > 10) {
+    // Parallel processing for large number of contours. Bytes rather than
+    // a bit vector: workers write neighbouring flags.
+    std::vector<Obloid> &tempObloids = frame_->candidates;
+    std::vector<char> &validObloids = frame_->accepted;
+    tempObloids.resize(contours.Size());
+    validObloids.assign(contours.Size(), 0);
+
+    // Workers classify straight from the traced arena
 #pragma omp parallel for schedule(dynamic)
-    for (size_t i = 0; i < contours.size(); ++i) {
+    for (size_t i = 0; i < contours.Size(); ++i) {
+      TRACE_SPAN("ClassifyContour", "classify");
       Obloid obloid;
-      if (IsObloid(contours[i], obloid)) {
-        if (obloid.radius >= minRadius_ && obloid.radius <= maxRadius_ &&
-            obloid.confidence >= confidenceThreshold_) {
+      if (IsObloid(contours.View(i), obloid)) {
+        if (obloid.radius < minRadius_ || obloid.radius > maxRadius_) {
+          Reject(RejectReason::RadiusRange);
+        } else if (obloid.confidence < confidenceThreshold_) {
+          Reject(RejectReason::LowConfidence);
+        } else {
           tempObloids[i] = obloid;
           validObloids[i] = true;
         }
@@ -60,18 +152,22 @@ std::vector<Obloid> ObloidDetector::DetectObloids(const Image &image) {
     }
 
     // Collect valid obloids
-    for (size_t i = 0; i < contours.size(); ++i) {
+    for (size_t i = 0; i < contours.Size(); ++i) {
       if (validObloids[i]) {
         obloids.push_back(tempObloids[i]);
       }
     }
   } else {
     // Sequential processing for small number of contours
-    for (const auto &contour : contours) {
+    for (size_t i = 0; i < contours.Size(); ++i) {
+      TRACE_SPAN("ClassifyContour", "classify");
       Obloid obloid;
-      if (IsObloid(contour, obloid)) {
-        if (obloid.radius >= minRadius_ && obloid.radius <= maxRadius_ &&
-            obloid.confidence >= confidenceThreshold_) {
+      if (IsObloid(contours.View(i), obloid)) {
+        if (obloid.radius < minRadius_ || obloid.radius > maxRadius_) {
+          Reject(RejectReason::RadiusRange);
+        } else if (obloid.confidence < confidenceThreshold_) {
+          Reject(RejectReason::LowConfidence);
+        } else {
           obloids.push_back(obloid);
         }
       }
@@ -79,61 +175,139 @@ std::vector<Obloid> ObloidDetector::DetectObloids(const Image &image) {
   }
 
   // Remove duplicate obloids
+  const int candidates = static_cast<int>(obloids.size());
   RemoveDuplicateObloids(obloids);
 
-  return obloids;
+  if (DETECTION_STATS_ENABLED && stats_) {
+    const Clock::time_point end = Clock::now();
+    StrategyStats &strategy = stats_->strategies[0];
+    strategy.name = "obloid";
+    strategy.preprocessMs += milliseconds(start, preprocessed);
+    strategy.contoursMs += milliseconds(preprocessed, traced);
+    strategy.classifyMs += milliseconds(traced, end);
+    strategy.contours += static_cast<int>(contours.Size());
+    strategy.accepted += candidates;
+    stats_->strategyCount = std::max(stats_->strategyCount, 1);
+
+    stats_->duplicateInput += candidates;
+    stats_->duplicateOutput += static_cast<int>(obloids.size());
+    stats_->bytesAllocated +=
+        static_cast<size_t>(processed.height) *
+            (processed.width * sizeof(int) + sizeof(std::vector<int>)) +
+        static_cast<size_t>(processed.width) * processed.height / 8 +
+        contours.CapacityBytes();
+    stats_->totalMs += milliseconds(start, end);
+    const AllocationCounts counts = allocations->Counts();
+    strategy.allocations += counts.allocations;
+    strategy.allocatedBytes += counts.bytes;
+    stats_->heapAllocations += counts.allocations;
+    stats_->heapBytes += counts.bytes;
+    stats_ = nullptr;
+  }
+}
+
+bool ObloidDetector::Reject([[maybe_unused]] RejectReason reason) const {
+  DETECTION_STATS_INCREMENT(stats_, rejections[static_cast<int>(reason)]);
+  return false;
 }
 
-Image ObloidDetector::PreprocessImage(const Image &image) const {
-  Image result = image;
+std::vector<Obloid> ObloidDetector::DetectInRegions(
+    const Image &image, const std::vector<RegionOfInterest> &regions,
+    DetectionStats *stats) {
+  std::vector<Obloid> obloids;
+
+  for (const auto &region : regions) {
+    RegionOfInterest clipped =
+        ImageProcessor::ClipRegion(region, image.width, image.height);
+    if (clipped.width <= 0 || clipped.height <= 0)
+      continue;
 
-  // Apply Gaussian blur for noise reduction
-  Image blurred = ApplyGaussianBlur(result, 1.0);
+    // Run the full pipeline on the region only, so cost scales with its area
+    Image window = ImageProcessor::ExtractRegion(image, clipped);
+    std::vector<Obloid> &found = frame_->found;
+    Detect(window, stats, found);
 
-  // Apply thresholding optimized for circular shapes
-#pragma omp parallel for
-  for (int y = 0; y < blurred.height; ++y) {
-    for (int x = 0; x < blurred.width; ++x) {
-      result.pixels[y][x] = (blurred.pixels[y][x] > 127) ? 255 : 0;
+    // Translate back to full-frame coordinates
+    for (auto &obloid : found) {
+      obloid.center.x += clipped.x;
+      obloid.center.y += clipped.y;
+      obloids.push_back(obloid);
     }
   }
 
-  return result;
+  // Overlapping regions may report the same obloid more than once. The
+  // pass takes the regions' outputs as input, so only what it removes
+  // changes the duplicate counts.
+  if (regions.size() > 1) {
+    using Clock = std::chrono::steady_clock;
+    const bool timed = DETECTION_STATS_ENABLED && stats;
+    const Clock::time_point start =
+        timed ? Clock::now() : Clock::time_point();
+    const int candidates = static_cast<int>(obloids.size());
+    RemoveDuplicateObloids(obloids);
+    if (timed) {
+      stats->duplicateOutput -= candidates - static_cast<int>(obloids.size());
+      stats->totalMs +=
+          std::chrono::duration<double, std::milli>(Clock::now() - start)
+              .count();
+    }
+  }
+
+  return obloids;
 }
 
-std::vector<std::vector<Point>> ObloidDetector::FindContours(const Image &image) const {
-  std::vector<std::vector<Point>> contours;
-  contours.reserve(50);
-  std::vector<std::vector<bool>> visited(image.height,
-                                         std::vector<bool>(image.width, false));
+void ObloidDetector::PreprocessImage(const Image &image, Image &output) const {
+  TRACE_SPAN("PreprocessImage", "kernel");
+  using P = PixelPipeline;
+
+  // Blur for noise reduction, then threshold for circular shapes
+  P::Evaluate(P::Threshold(P::GaussianBlur<1.0>(P::Input(image)), 127),
+              output);
+}
+
+void ObloidDetector::FindContours(const Image &image,
+                                  ContourSet &contours) const {
+  TRACE_SPAN("FindContours", "contours");
+  contours.Clear();
+  contours.Reserve(50, 4096);
+  std::vector<std::vector<bool>> &visited = frame_->visited;
+  visited.resize(image.height);
+  for (auto &row : visited)
+    row.assign(image.width, false);
+
+  // The region buffer is reused for every component; boundaries are
+  // traced straight into the arena
+  std::vector<Point> &region = frame_->region;
+  region.reserve(500);
 
   // Find all connected white regions
   for (int y = 0; y < image.height; ++y) {
     for (int x = 0; x < image.width; ++x) {
       if (!visited[y][x] && image.pixels[y][x] == 255) {
-        std::vector<Point> region;
-        region.reserve(500);
+        region.clear();
         ScanlineFillContour(image, x, y, region, visited);
 
         if (region.size() >= 20) { // Minimum size for a circle
-          std::vector<Point> boundary = ExtractBoundary(region, image);
-          if (boundary.size() >= 8) {
-            contours.push_back(std::move(boundary));
+          ExtractBoundary(region, image, contours);
+          if (contours.OpenPointCount() >= 8) {
+            contours.Close();
+          } else {
+            contours.Discard();
           }
         }
       }
     }
   }
-
-  return contours;
 }
 
 void ObloidDetector::ScanlineFillContour(
     const Image &image, int startX, int startY, std::vector<Point> &contour,
     std::vector<std::vector<bool>> &visited) const {
   
-  // Efficient scanline flood fill algorithm (reusing from RectangleDetector)
-  std::stack<ScanlineSegment> stack;
+  // Efficient scanline flood fill algorithm (reusing from RectangleDetector),
+  // on a stack kept between calls
+  std::vector<ScanlineSegment> &stack = frame_->segments;
+  stack.clear();
 
   // Find initial horizontal segment
   int x1 = startX, x2 = startX;
@@ -144,11 +318,11 @@ void ObloidDetector::ScanlineFillContour(
          !visited[startY][x2 + 1])
     x2++;
 
-  stack.push(ScanlineSegment(startY, x1, x2, -1));
+  stack.emplace_back(startY, x1, x2, -1);
 
   while (!stack.empty()) {
-    ScanlineSegment seg = stack.top();
-    stack.pop();
+    ScanlineSegment seg = stack.back();
+    stack.pop_back();
 
     // Process scanline
     for (int x = seg.x1; x <= seg.x2; x++) {
@@ -185,40 +359,41 @@ void ObloidDetector::ScanlineFillContour(
                !visited[newY][newX2 + 1])
           newX2++;
 
-        stack.push(ScanlineSegment(newY, newX1, newX2, seg.y));
+        stack.emplace_back(newY, newX1, newX2, seg.y);
       }
     }
   }
 }
 
-bool ObloidDetector::IsObloid(const std::vector<Point> &contour, Obloid &obloid) const {
+bool ObloidDetector::IsObloid(const ContourView &contour, Obloid &obloid) const {
   if (contour.size() < 8)
-    return false;
+    return Reject(RejectReason::TooFewPoints);
 
   // Calculate basic shape properties
   double circularity = CalculateCircularity(contour);
   if (circularity < circularityThreshold_)
-    return false;
+    return Reject(RejectReason::NotCircular);
 
   // Fit a circle to the contour
   obloid = FitCircleToContour(contour);
   
   // Validate circle geometry
   if (!ValidateCircleGeometry(contour, obloid.center, obloid.radius))
-    return false;
+    return Reject(RejectReason::CircleGeometry);
 
   // Calculate confidence based on how well the contour fits a circle
   double fitError = CalculateCircleFitError(contour, obloid.center, obloid.radius);
   obloid.confidence = std::max(0.0, 1.0 - fitError / obloid.radius);
 
-  return obloid.confidence >= confidenceThreshold_;
+  return obloid.confidence >= confidenceThreshold_ ||
+         Reject(RejectReason::LowConfidence);
 }
 
-Obloid ObloidDetector::CreateObloid(const std::vector<Point> &contour) const {
+Obloid ObloidDetector::CreateObloid(const ContourView &contour) const {
   return FitCircleToContour(contour);
 }
 
-double ObloidDetector::CalculateCircularity(const std::vector<Point> &contour) const {
+double ObloidDetector::CalculateCircularity(const ContourView &contour) const {
   if (contour.size() < 3)
     return 0.0;
 
@@ -233,7 +408,7 @@ double ObloidDetector::CalculateCircularity(const std::vector<Point> &contour) c
   return (4.0 * PI * area) / (perimeter * perimeter);
 }
 
-double ObloidDetector::CalculatePerimeter(const std::vector<Point> &contour) const {
+double ObloidDetector::CalculatePerimeter(const ContourView &contour) const {
   if (contour.size() < 2)
     return 0.0;
 
@@ -244,7 +419,7 @@ double ObloidDetector::CalculatePerimeter(const std::vector<Point> &contour) con
   return 2.0 * PI * radius;
 }
 
-double ObloidDetector::CalculateArea(const std::vector<Point> &contour) const {
+double ObloidDetector::CalculateArea(const ContourView &contour) const {
   if (contour.size() < 3)
     return 0.0;
 
@@ -253,44 +428,40 @@ double ObloidDetector::CalculateArea(const std::vector<Point> &contour) const {
   return static_cast<double>(contour.size());
 }
 
-Point ObloidDetector::CalculateCentroid(const std::vector<Point> &contour) const {
+Point ObloidDetector::CalculateCentroid(const ContourView &contour) const {
   if (contour.empty())
     return Point(0, 0);
 
   double sumX = 0, sumY = 0;
-  for (const auto &point : contour) {
-    sumX += point.x;
-    sumY += point.y;
+  for (size_t i = 0; i < contour.count; ++i) {
+    sumX += contour.xs[i];
+    sumY += contour.ys[i];
   }
 
   return Point(static_cast<int>(std::round(sumX / contour.size())),
                static_cast<int>(std::round(sumY / contour.size())));
 }
 
-int ObloidDetector::EstimateRadius(const std::vector<Point> &contour, const Point &center) const {
+int ObloidDetector::EstimateRadius(const ContourView &contour, const Point &center) const {
   if (contour.empty())
     return 0;
 
   double sumRadius = 0.0;
-  for (const auto &point : contour) {
-    double dx = point.x - center.x;
-    double dy = point.y - center.y;
-    sumRadius += std::sqrt(dx * dx + dy * dy);
+  for (size_t i = 0; i < contour.count; ++i) {
+    sumRadius += Distance(contour, i, center);
   }
 
   return static_cast<int>(std::round(sumRadius / contour.size()));
 }
 
-double ObloidDetector::CalculateRadialVariance(const std::vector<Point> &contour, 
+double ObloidDetector::CalculateRadialVariance(const ContourView &contour, 
                                                const Point &center, int radius) const {
   if (contour.empty())
     return 0.0;
 
   double variance = 0.0;
-  for (const auto &point : contour) {
-    double dx = point.x - center.x;
-    double dy = point.y - center.y;
-    double distance = std::sqrt(dx * dx + dy * dy);
+  for (size_t i = 0; i < contour.count; ++i) {
+    double distance = Distance(contour, i, center);
     double diff = distance - radius;
     variance += diff * diff;
   }
@@ -298,7 +469,7 @@ double ObloidDetector::CalculateRadialVariance(const std::vector<Point> &contour
   return variance / contour.size();
 }
 
-bool ObloidDetector::IsCircularContour(const std::vector<Point> &contour) const {
+bool ObloidDetector::IsCircularContour(const ContourView &contour) const {
   if (contour.size() < 8)
     return false;
 
@@ -314,11 +485,9 @@ bool ObloidDetector::IsCircularContour(const std::vector<Point> &contour) const
   return normalizedVariance < 0.1; // Threshold for circular variance
 }
 
-std::vector<Point> ObloidDetector::ExtractBoundary(const std::vector<Point> &region,
-                                                   const Image &image) const {
-  std::vector<Point> boundary;
-  boundary.reserve(region.size() / 4);
-
+void ObloidDetector::ExtractBoundary(const std::vector<Point> &region,
+                                     const Image &image,
+                                     ContourSet &contours) const {
   for (const Point &p : region) {
     bool isBoundary = false;
 
@@ -342,14 +511,13 @@ std::vector<Point> ObloidDetector::ExtractBoundary(const std::vector<Point> &reg
     }
 
     if (isBoundary) {
-      boundary.push_back(p);
+      contours.Push(p.x, p.y);
     }
   }
-
-  return boundary;
 }
 
 void ObloidDetector::RemoveDuplicateObloids(std::vector<Obloid> &obloids) const {
+  TRACE_SPAN("RemoveDuplicateObloids", "nms");
   if (obloids.size() <= 1)
     return;
 
@@ -359,7 +527,8 @@ void ObloidDetector::RemoveDuplicateObloids(std::vector<Obloid> &obloids) const
               return a.radius > b.radius;
             });
 
-  std::vector<bool> toRemove(obloids.size(), false);
+  std::vector<bool> &toRemove = frame_->duplicates;
+  toRemove.assign(obloids.size(), false);
 
   for (size_t i = 0; i < obloids.size(); ++i) {
     if (toRemove[i])
@@ -392,65 +561,7 @@ void ObloidDetector::RemoveDuplicateObloids(std::vector<Obloid> &obloids) const
       obloids.end());
 }
 
-Image ObloidDetector::ApplyGaussianBlur(const Image &image, double sigma) const {
-  if (sigma <= 0.1)
-    return image;
-
-  Image result = image;
-
-  // Calculate kernel size (should be odd)
-  int kernelSize = static_cast<int>(2 * std::ceil(3 * sigma) + 1);
-  if (kernelSize % 2 == 0)
-    kernelSize++;
-  int halfKernel = kernelSize / 2;
-
-  // Create Gaussian kernel
-  std::vector<double> kernel(kernelSize);
-  double sum = 0.0;
-  for (int i = 0; i < kernelSize; ++i) {
-    int x = i - halfKernel;
-    kernel[i] = std::exp(-(x * x) / (2 * sigma * sigma));
-    sum += kernel[i];
-  }
-
-  // Normalize kernel
-  for (double &k : kernel) {
-    k /= sum;
-  }
-
-  // Apply horizontal blur
-  Image temp = image;
-#pragma omp parallel for
-  for (int y = 0; y < image.height; ++y) {
-    for (int x = 0; x < image.width; ++x) {
-      double blurredValue = 0.0;
-      for (int k = 0; k < kernelSize; ++k) {
-        int sourceX = x + k - halfKernel;
-        sourceX = std::max(0, std::min(sourceX, image.width - 1));
-        blurredValue += image.pixels[y][sourceX] * kernel[k];
-      }
-      temp.pixels[y][x] = static_cast<int>(std::round(blurredValue));
-    }
-  }
-
-  // Apply vertical blur
-#pragma omp parallel for
-  for (int y = 0; y < image.height; ++y) {
-    for (int x = 0; x < image.width; ++x) {
-      double blurredValue = 0.0;
-      for (int k = 0; k < kernelSize; ++k) {
-        int sourceY = y + k - halfKernel;
-        sourceY = std::max(0, std::min(sourceY, image.height - 1));
-        blurredValue += temp.pixels[sourceY][x] * kernel[k];
-      }
-      result.pixels[y][x] = static_cast<int>(std::round(blurredValue));
-    }
-  }
-
-  return result;
-}
-
-bool ObloidDetector::ValidateCircleGeometry(const std::vector<Point> &contour, 
+bool ObloidDetector::ValidateCircleGeometry(const ContourView &contour, 
                                             const Point &center, int radius) const {
   if (contour.empty() || radius <= 0)
     return false;
@@ -463,10 +574,8 @@ bool ObloidDetector::ValidateCircleGeometry(const std::vector<Point> &contour,
   int inliers = 0;
   double tolerance = std::max(3.0, radius * 0.15); // 15% tolerance or minimum 3 pixels
 
-  for (const auto &point : contour) {
-    double dx = point.x - center.x;
-    double dy = point.y - center.y;
-    double distance = std::sqrt(dx * dx + dy * dy);
+  for (size_t i = 0; i < contour.count; ++i) {
+    double distance = Distance(contour, i, center);
     
     if (std::abs(distance - radius) <= tolerance) {
       inliers++;
@@ -477,16 +586,14 @@ bool ObloidDetector::ValidateCircleGeometry(const std::vector<Point> &contour,
   return (static_cast<double>(inliers) / contour.size()) >= 0.7;
 }
 
-double ObloidDetector::CalculateCircleFitError(const std::vector<Point> &contour, 
+double ObloidDetector::CalculateCircleFitError(const ContourView &contour, 
                                                const Point &center, int radius) const {
   if (contour.empty())
     return std::numeric_limits<double>::max();
 
   double totalError = 0.0;
-  for (const auto &point : contour) {
-    double dx = point.x - center.x;
-    double dy = point.y - center.y;
-    double distance = std::sqrt(dx * dx + dy * dy);
+  for (size_t i = 0; i < contour.count; ++i) {
+    double distance = Distance(contour, i, center);
     double error = std::abs(distance - radius);
     totalError += error;
   }
@@ -494,7 +601,7 @@ double ObloidDetector::CalculateCircleFitError(const std::vector<Point> &contour
   return totalError / contour.size();
 }
 
-Obloid ObloidDetector::FitCircleToContour(const std::vector<Point> &contour) const {
+Obloid ObloidDetector::FitCircleToContour(const ContourView &contour) const {
   Obloid obloid;
   
   if (contour.size() < 3) {
@@ -508,9 +615,9 @@ Obloid ObloidDetector::FitCircleToContour(const std::vector<Point> &contour) con
   double sumX = 0, sumY = 0, sumX2 = 0, sumY2 = 0, sumXY = 0;
   double sumX3 = 0, sumY3 = 0, sumX2Y = 0, sumXY2 = 0;
   
-  for (const auto &point : contour) {
-    double x = point.x;
-    double y = point.y;
+  for (size_t i = 0; i < contour.count; ++i) {
+    double x = contour.xs[i];
+    double y = contour.ys[i];
     double x2 = x * x;
     double y2 = y * y;
     
@@ -571,24 +678,62 @@ void SphereDetector::SetMaxRadius(int maxRadius) { maxRadius_ = maxRadius; }
 void SphereDetector::SetCircularityThreshold(double threshold) { circularityThreshold_ = threshold; }
 void SphereDetector::SetConfidenceThreshold(double threshold) { confidenceThreshold_ = threshold; }
 
-std::vector<Sphere> SphereDetector::DetectSpheres(const Image &image) {
-  // For simplicity, convert Obloid results to Sphere
-  ObloidDetector obloidDetector;
-  obloidDetector.SetMinRadius(minRadius_);
-  obloidDetector.SetMaxRadius(maxRadius_);
-  obloidDetector.SetCircularityThreshold(circularityThreshold_);
-  obloidDetector.SetConfidenceThreshold(confidenceThreshold_);
-  
-  std::vector<Obloid> obloids = obloidDetector.DetectObloids(image);
-  std::vector<Sphere> spheres;
-  
-  for (const auto& obloid : obloids) {
+// The obloid detector keeps its buffers from call to call; the settings
+// are applied before each one
+ObloidDetector &SphereDetector::ConfiguredObloidDetector() {
+  obloidDetector_.SetMinRadius(minRadius_);
+  obloidDetector_.SetMaxRadius(maxRadius_);
+  obloidDetector_.SetCircularityThreshold(circularityThreshold_);
+  obloidDetector_.SetConfidenceThreshold(confidenceThreshold_);
+  return obloidDetector_;
+}
+
+void SphereDetector::ToSpheres(const std::vector<Obloid> &obloids,
+                               std::vector<Sphere> &spheres) {
+  spheres.clear();
+  spheres.reserve(obloids.size());
+
+  for (const auto &obloid : obloids) {
     Sphere sphere;
     sphere.center = obloid.center;
     sphere.radius = obloid.radius;
     sphere.confidence = obloid.confidence;
     spheres.push_back(sphere);
   }
-  
+}
+
+std::vector<Sphere>
+SphereDetector::ToSpheres(const std::vector<Obloid> &obloids) {
+  std::vector<Sphere> spheres;
+  ToSpheres(obloids, spheres);
   return spheres;
-}
\ No newline at end of file
+}
+
+std::vector<Sphere> SphereDetector::DetectSpheres(const Image &image) {
+  return ToSpheres(ConfiguredObloidDetector().DetectObloids(image));
+}
+
+void SphereDetector::DetectSpheres(const Image &image,
+                                   std::vector<Sphere> &spheres) {
+  ConfiguredObloidDetector().DetectObloids(image, obloids_);
+  ToSpheres(obloids_, spheres);
+}
+
+std::vector<Sphere> SphereDetector::DetectSpheres(const Image &image,
+                                                  DetectionStats &stats) {
+  return ToSpheres(ConfiguredObloidDetector().DetectObloids(image, stats));
+}
+
+std::vector<Sphere>
+SphereDetector::DetectSpheres(const Image &image,
+                              const std::vector<RegionOfInterest> &regions) {
+  return ToSpheres(ConfiguredObloidDetector().DetectObloids(image, regions));
+}
+
+std::vector<Sphere>
+SphereDetector::DetectSpheres(const Image &image,
+                              const std::vector<RegionOfInterest> &regions,
+                              DetectionStats &stats) {
+  return ToSpheres(
+      ConfiguredObloidDetector().DetectObloids(image, regions, stats));
+}
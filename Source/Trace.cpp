@@ -0,0 +1,126 @@
+#include "ShapeDetector/Trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+constexpr size_t INITIAL_EVENTS_PER_THREAD = 1 << 14;
+
+namespace {
+
+struct ThreadBuffer {
+  std::vector<TraceEvent> events;
+  uint64_t generation = 0; // trace the events belong to
+  int index = 0;
+};
+
+// Buffers are owned here rather than by their threads so OpenMP workers
+// that exit early do not take their events with them
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+std::atomic<uint64_t> generation{0};
+std::atomic<int64_t> origin{0};
+
+ThreadBuffer &LocalBuffer() {
+  thread_local ThreadBuffer *buffer = nullptr;
+  if (!buffer) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.push_back(std::make_unique<ThreadBuffer>());
+    buffer = registry.back().get();
+    buffer->index = static_cast<int>(registry.size()) - 1;
+    buffer->events.reserve(INITIAL_EVENTS_PER_THREAD);
+  }
+  return *buffer;
+}
+
+} // namespace
+
+std::atomic<bool> Trace::enabled_{false};
+
+int64_t Trace::Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Trace::Start() {
+  // Buffers notice the new generation and clear themselves on their next
+  // span, so no thread's buffer is touched from here
+  origin.store(Now(), std::memory_order_relaxed);
+  generation.fetch_add(1, std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_release);
+}
+
+void Trace::Stop() { enabled_.store(false, std::memory_order_release); }
+
+void Trace::Record(const char *name, const char *category, int64_t start,
+                   int64_t end) {
+  ThreadBuffer &buffer = LocalBuffer();
+  const uint64_t current = generation.load(std::memory_order_relaxed);
+  if (buffer.generation != current) {
+    buffer.events.clear();
+    buffer.generation = current;
+  }
+  const int64_t zero = origin.load(std::memory_order_relaxed);
+  buffer.events.push_back(
+      {name, category, start - zero, end - start, buffer.index});
+}
+
+std::vector<TraceEvent> Trace::Events() {
+  std::vector<TraceEvent> events;
+  const uint64_t current = generation.load(std::memory_order_acquire);
+
+  std::lock_guard<std::mutex> lock(registryMutex);
+  for (const auto &buffer : registry) {
+    if (buffer->generation == current) {
+      events.insert(events.end(), buffer->events.begin(),
+                    buffer->events.end());
+    }
+  }
+  std::stable_sort(events.begin(), events.end(),
+                   [](const TraceEvent &a, const TraceEvent &b) {
+                     return a.startNs < b.startNs;
+                   });
+  return events;
+}
+
+void Trace::WriteChromeJson(std::ostream &out) {
+  const std::vector<TraceEvent> events = Events();
+
+  int threads = 0;
+  for (const auto &event : events)
+    threads = std::max(threads, event.thread + 1);
+
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+  for (int t = 0; t < threads; ++t) {
+    out << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+           "\"tid\": "
+        << t << ", \"args\": {\"name\": \"thread " << t << "\"}},\n";
+  }
+
+  // Complete ("X") events carry start and duration in microseconds
+  out << std::fixed << std::setprecision(3);
+  for (size_t i = 0; i < events.size(); ++i) {
+    const TraceEvent &event = events[i];
+    out << "  {\"name\": \"" << event.name << "\", \"cat\": \""
+        << event.category << "\", \"ph\": \"X\", \"ts\": "
+        << event.startNs / 1e3 << ", \"dur\": " << event.durationNs / 1e3
+        << ", \"pid\": 1, \"tid\": " << event.thread << "}"
+        << (i + 1 < events.size() ? ",\n" : "\n");
+  }
+  out << "]}\n";
+}
+
+bool Trace::WriteChromeJson(const std::string &path) {
+  std::ofstream file(path);
+  if (!file) {
+    std::cerr << "Error: Cannot write trace " << path << std::endl;
+    return false;
+  }
+  WriteChromeJson(file);
+  return true;
+}
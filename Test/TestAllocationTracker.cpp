@@ -0,0 +1,118 @@
+#include "ShapeDetector/AllocationTracker.hpp"
+#include "ShapeDetector/ImageProcessor.hpp"
+#include "ShapeDetector/RectangleDetector.hpp"
+#include "ShapeDetector/SphereDetector.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <omp.h>
+
+class AllocationTrackerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    if (!AllocationTracker::Available())
+      GTEST_SKIP() << "operator new hooks compiled out";
+  }
+};
+
+TEST_F(AllocationTrackerTest, CountsAllocationsAndFrees) {
+  AllocationScope scope;
+  {
+    auto values = std::make_unique<int[]>(100);
+    values[0] = 1;
+  }
+  AllocationCounts counts = scope.Counts();
+  EXPECT_EQ(counts.allocations, 1u);
+  EXPECT_EQ(counts.frees, 1u);
+  EXPECT_EQ(counts.bytes, 100 * sizeof(int));
+}
+
+TEST_F(AllocationTrackerTest, IgnoresAllocationsWhileDisabled) {
+  AllocationTracker::Disable();
+  const AllocationCounts before = AllocationTracker::ThisThread();
+  auto value = std::make_unique<double>(1.0);
+  EXPECT_EQ((AllocationTracker::ThisThread() - before).allocations, 0u);
+}
+
+// As when two detectors with stats run concurrently: the first scope to
+// end must not switch off the other's counting
+TEST_F(AllocationTrackerTest, OverlappingScopesKeepCounting) {
+  std::optional<AllocationScope> first;
+  std::optional<AllocationScope> second;
+  first.emplace();
+  second.emplace();
+  first.reset();
+  auto value = std::make_unique<int>(1);
+  EXPECT_EQ(second->Counts().allocations, 1u);
+  second.reset();
+  EXPECT_FALSE(AllocationTracker::Enabled());
+}
+
+TEST_F(AllocationTrackerTest, SumsWorkerThreads) {
+  int threads = 0;
+  AllocationScope scope;
+#pragma omp parallel num_threads(4)
+  {
+#pragma omp single
+    threads = omp_get_num_threads();
+    auto value = std::make_unique<long>(omp_get_thread_num());
+    // Keep the compiler from eliding the allocation
+    asm volatile("" : : "g"(value.get()) : "memory");
+  }
+  EXPECT_GE(scope.Counts().allocations, static_cast<uint64_t>(threads));
+}
+
+// Steady state: once warmed up, a detection at a fixed resolution reuses
+// the buffers of the detectors and of the thread and allocates nothing. One
+// thread, so the first call warms every buffer the later ones touch; each
+// worker thread warms its own the same way.
+TEST_F(AllocationTrackerTest, RepeatedDetectionAllocatesNothing) {
+  const int threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  Image image = ImageProcessor::CreateTestImage(200, 150);
+  RectangleDetector rectangleDetector;
+  SphereDetector sphereDetector;
+  std::vector<Rectangle> rectangles;
+  std::vector<Sphere> spheres;
+  rectangleDetector.DetectRectangles(image, rectangles);
+  sphereDetector.DetectSpheres(image, spheres);
+  const size_t found = rectangles.size() + spheres.size();
+
+  for (int call = 0; call < 3; ++call) {
+    AllocationScope scope;
+    rectangleDetector.DetectRectangles(image, rectangles);
+    sphereDetector.DetectSpheres(image, spheres);
+    EXPECT_EQ(scope.Counts().allocations, 0u) << "call " << call;
+    EXPECT_EQ(rectangles.size() + spheres.size(), found) << "call " << call;
+  }
+  omp_set_num_threads(threads);
+}
+
+TEST_F(AllocationTrackerTest, RenderingIntoPreallocatedFrameAllocatesNothing) {
+  Image gray = ImageProcessor::CreateTestImage(200, 150);
+  std::vector<Rectangle> rectangles = {{Point(60, 50), 40, 20, 0.3}};
+  std::vector<Sphere> spheres = {{Point(140, 90), 15, 1.0}};
+  RgbImage rgb(gray.width, gray.height);
+  ImageProcessor::ExpandGrayToRgb(gray, rgb.View());
+
+  AllocationScope scope;
+  for (int frame = 0; frame < 5; ++frame) {
+    ImageProcessor::ExpandGrayToRgb(gray, rgb.View());
+    ImageProcessor::DrawOverlay(rgb.View(), rectangles, spheres);
+  }
+  EXPECT_EQ(scope.Counts().allocations, 0u);
+}
+
+TEST_F(AllocationTrackerTest, DetectionStatsReportHeapUse) {
+  Image image = ImageProcessor::CreateTestImage(200, 150);
+  RectangleDetector detector;
+  DetectionStats stats;
+  detector.DetectRectangles(image, stats);
+
+  uint64_t perStrategy = 0;
+  for (int s = 0; s < stats.strategyCount; ++s)
+    perStrategy += stats.strategies[s].allocations;
+  EXPECT_GT(stats.heapAllocations, 0u);
+  EXPECT_GT(stats.heapBytes, 0u);
+  EXPECT_LE(perStrategy, stats.heapAllocations);
+}
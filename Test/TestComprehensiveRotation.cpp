@@ -1,6 +1,9 @@
+#include "ShapeDetector/GeometryPolicy.hpp"
 #include "ShapeDetector/ImageProcessor.hpp"
 #include "ShapeDetector/RectangleDetector.hpp"
 #include <cmath>
+#include <cstdlib>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <iomanip>
 #include <iostream>
@@ -19,6 +22,10 @@ protected:
 
   // Test rectangle at specific angle
   bool TestAngle(double angleDegrees) {
+    return !DetectAtAngle(angleDegrees).empty();
+  }
+
+  std::vector<Rectangle> DetectAtAngle(double angleDegrees) {
     double angleRadians = angleDegrees * std::numbers::pi / 180.0;
 
     Image image(300, 300);
@@ -33,8 +40,7 @@ protected:
     ImageProcessor::CreateRotatedRectangle(image, 150, 150, 80, 50,
                                            angleRadians);
 
-    std::vector<Rectangle> rectangles = detector.DetectRectangles(image);
-    return rectangles.size() >= 1;
+    return detector.DetectRectangles(image);
   }
 };
 
@@ -245,4 +251,49 @@ TEST_F(ComprehensiveRotationTest, CompareWithBaseline) {
   // Should significantly outperform traditional methods
   EXPECT_GT(currentPerformance, 40.0)
       << "Should outperform traditional contour-based methods";
-}
\ No newline at end of file
+}
+// CTest runs this suite once per geometry precision: the double build
+// records what it detects at every angle to the file named by
+// SHAPE_DETECTOR_ROTATION_REFERENCE, and the float and fixed builds must
+// find the same rectangles
+TEST_F(ComprehensiveRotationTest, AgreesWithDoubleGeometry) {
+  const char *reference = std::getenv("SHAPE_DETECTOR_ROTATION_REFERENCE");
+  if (!reference)
+    GTEST_SKIP() << "no reference file named";
+
+  const bool recording = GEOMETRY_PRECISION == GeometryPrecision::Double;
+  std::ofstream record;
+  std::ifstream expected;
+  if (recording)
+    record.open(reference);
+  else
+    expected.open(reference);
+  ASSERT_TRUE(recording ? record.good() : expected.good()) << reference;
+
+  for (int angle = 0; angle <= 180; angle += 5) {
+    const std::vector<Rectangle> rectangles = DetectAtAngle(angle);
+    if (recording) {
+      record << rectangles.size() << std::setprecision(17);
+      for (const Rectangle &rect : rectangles) {
+        record << " " << rect.center.x << " " << rect.center.y << " "
+               << rect.width << " " << rect.height << " " << rect.angle;
+      }
+      record << "\n";
+      continue;
+    }
+
+    size_t count = 0;
+    ASSERT_TRUE(expected >> count) << "reference ends before " << angle;
+    ASSERT_EQ(rectangles.size(), count) << angle << " degrees";
+    for (const Rectangle &rect : rectangles) {
+      Rectangle recorded{};
+      expected >> recorded.center.x >> recorded.center.y >>
+          recorded.width >> recorded.height >> recorded.angle;
+      EXPECT_NEAR(rect.center.x, recorded.center.x, 1) << angle << " degrees";
+      EXPECT_NEAR(rect.center.y, recorded.center.y, 1) << angle << " degrees";
+      EXPECT_NEAR(rect.width, recorded.width, 1) << angle << " degrees";
+      EXPECT_NEAR(rect.height, recorded.height, 1) << angle << " degrees";
+      EXPECT_NEAR(rect.angle, recorded.angle, 0.01) << angle << " degrees";
+    }
+  }
+}
@@ -0,0 +1,218 @@
+#include "ShapeDetector/ContourGeometry.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numbers>
+
+class ContourGeometryTest : public ::testing::Test {
+protected:
+  // Closed outline of an axis-aligned square, one point per pixel step
+  static std::vector<Point> Square(int x0, int y0, int side) {
+    std::vector<Point> points;
+    for (int i = 0; i < side; ++i)
+      points.emplace_back(x0 + i, y0);
+    for (int i = 0; i < side; ++i)
+      points.emplace_back(x0 + side, y0 + i);
+    for (int i = 0; i < side; ++i)
+      points.emplace_back(x0 + side - i, y0 + side);
+    for (int i = 0; i < side; ++i)
+      points.emplace_back(x0, y0 + side - i);
+    return points;
+  }
+
+  // Polygon with a vertex every 5 degrees, coarse enough that rounding to
+  // pixels does not turn the outline into a staircase
+  static std::vector<Point> Circle(int cx, int cy, double radius) {
+    std::vector<Point> points;
+    for (int i = 0; i < 72; ++i) {
+      const double angle = i * std::numbers::pi / 36.0;
+      points.emplace_back(
+          static_cast<int>(std::lround(cx + radius * std::cos(angle))),
+          static_cast<int>(std::lround(cy + radius * std::sin(angle))));
+    }
+    return points;
+  }
+
+  ContourSet contours;
+};
+
+TEST_F(ContourGeometryTest, MeasuresSquare) {
+  contours.Append(Square(10, 20, 40));
+  const ContourFeatures features =
+      ContourGeometry::Measure<GeometryPrecision::Double>(contours, 0);
+
+  EXPECT_DOUBLE_EQ(features.area, 1600.0);
+  EXPECT_DOUBLE_EQ(features.perimeter, 160.0);
+  EXPECT_NEAR(features.centroidX, 30.0, 1e-9);
+  EXPECT_NEAR(features.centroidY, 40.0, 1e-9);
+  // 4 / pi for any square
+  EXPECT_NEAR(features.Circularity(), 4.0 / std::numbers::pi, 1e-9);
+  EXPECT_GT(features.radialSpread, 0.05);
+}
+
+TEST_F(ContourGeometryTest, CirclesHaveLowCircularityAndSpread) {
+  contours.Append(Circle(100, 100, 50.0));
+  const ContourFeatures features = ContourGeometry::Measure(contours, 0);
+
+  EXPECT_NEAR(features.area, std::numbers::pi * 2500.0, 100.0);
+  EXPECT_LT(features.Circularity(), 1.1);
+  EXPECT_LT(features.radialSpread, 0.02);
+}
+
+TEST_F(ContourGeometryTest, MeasuresEveryContourOfTheSet) {
+  contours.Append(Square(0, 0, 10));
+  contours.Append({{5, 5}, {6, 5}});
+  contours.Append(Square(100, 100, 20));
+
+  std::vector<ContourFeatures> features;
+  ContourGeometry::Measure(contours, features);
+
+  ASSERT_EQ(features.size(), 3u);
+  EXPECT_DOUBLE_EQ(features[0].area, 100.0);
+  // Two points enclose nothing; the closed polyline runs there and back
+  EXPECT_DOUBLE_EQ(features[1].area, 0.0);
+  EXPECT_DOUBLE_EQ(features[1].perimeter, 2.0);
+  EXPECT_DOUBLE_EQ(features[1].Circularity(), 0.0);
+  EXPECT_DOUBLE_EQ(features[2].area, 400.0);
+  EXPECT_NEAR(features[2].centroidX, 110.0, 1e-9);
+}
+
+TEST_F(ContourGeometryTest, FindsFarthestPointFromChord) {
+  // Pseudo-random points with repeated distances, long enough for the
+  // vector sweep and its scalar tail
+  std::vector<Point> points;
+  uint32_t state = 12345;
+  for (int i = 0; i < 203; ++i) {
+    state = state * 1664525u + 1013904223u;
+    points.emplace_back(static_cast<int>(state >> 24) % 40,
+                        static_cast<int>(state >> 16) % 40);
+  }
+  contours.Append(points);
+  const ContourSet::Coordinate *xs = contours.X(0);
+  const ContourSet::Coordinate *ys = contours.Y(0);
+
+  for (size_t first : {0u, 3u, 50u}) {
+    for (size_t last : {first + 1, first + 2, first + 9, first + 150}) {
+      const Point &a = points[first], &b = points[last];
+      const double dx = b.x - a.x, dy = b.y - a.y;
+      double expected = 0.0;
+      size_t expectedIndex = first;
+      // A chord of coincident ends has no direction to measure from
+      for (size_t i = first + 1; i < last && (dx != 0 || dy != 0); ++i) {
+        const double cross =
+            dx * (points[i].y - a.y) - dy * (points[i].x - a.x);
+        const double squared = cross * cross / (dx * dx + dy * dy);
+        if (squared > expected) {
+          expected = squared;
+          expectedIndex = i;
+        }
+      }
+
+      double distanceSquared = -1.0;
+      EXPECT_EQ(ContourGeometry::FarthestFromChord(xs, ys, first, last,
+                                                   distanceSquared),
+                expectedIndex)
+          << first << ".." << last;
+      EXPECT_NEAR(distanceSquared, expected, 1e-9 * (1.0 + expected));
+    }
+  }
+}
+
+TEST_F(ContourGeometryTest, ReducedPrecisionsMatchDouble) {
+  contours.Append(Square(900, 700, 300));
+  contours.Append(Circle(1500, 1000, 400.0));
+  contours.Append({{5, 5}, {6, 5}});
+
+  std::vector<ContourFeatures> reference, single, fixed;
+  ContourGeometry::Measure<GeometryPrecision::Double>(contours, reference);
+  ContourGeometry::Measure<GeometryPrecision::Float>(contours, single);
+  ContourGeometry::Measure<GeometryPrecision::Fixed>(contours, fixed);
+
+  for (size_t i = 0; i < reference.size(); ++i) {
+    for (const auto &features : {single[i], fixed[i]}) {
+      // Shoelace sums are exact in every precision at this scale
+      EXPECT_DOUBLE_EQ(features.area, reference[i].area) << i;
+      EXPECT_NEAR(features.perimeter, reference[i].perimeter,
+                  1e-5 * reference[i].perimeter)
+          << i;
+      EXPECT_NEAR(features.centroidX, reference[i].centroidX, 1e-3) << i;
+      EXPECT_NEAR(features.radialSpread, reference[i].radialSpread, 1e-3)
+          << i;
+    }
+  }
+}
+
+TEST_F(ContourGeometryTest, ReducedPrecisionsFindTheSameFarthestPoint) {
+  // Frame-sized coordinates with a unique farthest point per chord
+  std::vector<Point> points;
+  for (int i = 0; i < 400; ++i) {
+    const double angle = i * std::numbers::pi / 200.0;
+    points.emplace_back(
+        static_cast<int>(std::lround(2000 + 1500 * std::cos(angle))),
+        static_cast<int>(std::lround(1500 + 900 * std::sin(angle))));
+  }
+  contours.Append(points);
+  const ContourSet::Coordinate *xs = contours.X(0);
+  const ContourSet::Coordinate *ys = contours.Y(0);
+
+  for (size_t first : {0u, 37u, 120u}) {
+    for (size_t last : {first + 5, first + 64, first + 250}) {
+      double reference = 0.0, single = 0.0, fixed = 0.0;
+      const size_t index =
+          ContourGeometry::FarthestFromChord<GeometryPrecision::Double>(
+              xs, ys, first, last, reference);
+      EXPECT_EQ(ContourGeometry::FarthestFromChord<GeometryPrecision::Float>(
+                    xs, ys, first, last, single),
+                index);
+      EXPECT_EQ(ContourGeometry::FarthestFromChord<GeometryPrecision::Fixed>(
+                    xs, ys, first, last, fixed),
+                index);
+      EXPECT_NEAR(single, reference, 1e-4 * reference);
+      EXPECT_DOUBLE_EQ(fixed, reference);
+    }
+  }
+}
+
+TEST_F(ContourGeometryTest, FixedPointFallsBackBeyondTheCoordinateLimit) {
+  // A chord inside the limit with one point far outside it between its
+  // ends, then a chord whose ends are outside too; 32-bit residuals of
+  // either would wrap
+  std::vector<Point> points;
+  for (int i = 0; i < 64; ++i)
+    points.emplace_back(i * 250, i * 250 + (i % 3));
+  points[40] = Point(1000000, -1000000);
+  for (int i = 0; i < 64; ++i)
+    points.emplace_back(40000 + i * 1000, 40000 + i * 1000 + (i % 5) * 700);
+  points[100] = Point(150000, 20000);
+  contours.Append(points);
+  const ContourSet::Coordinate *xs = contours.X(0);
+  const ContourSet::Coordinate *ys = contours.Y(0);
+
+  for (auto [first, last] : {std::pair<size_t, size_t>{0, 63}, {64, 127}}) {
+    double reference = 0.0, fixed = 0.0;
+    const size_t index =
+        ContourGeometry::FarthestFromChord<GeometryPrecision::Double>(
+            xs, ys, first, last, reference);
+    EXPECT_EQ(ContourGeometry::FarthestFromChord<GeometryPrecision::Fixed>(
+                  xs, ys, first, last, fixed),
+              index);
+    EXPECT_DOUBLE_EQ(fixed, reference);
+  }
+}
+
+TEST_F(ContourGeometryTest, FixedPointSumsStayExact) {
+  // Partial shoelace and coordinate sums near the coordinate limit wrap
+  // 32 bits while the totals fit; far beyond it the totals do not
+  contours.Append(Square(15000, 15000, 1000));
+  contours.Append(Square(1000000, -3000000, 2000));
+
+  std::vector<ContourFeatures> reference, fixed;
+  ContourGeometry::Measure<GeometryPrecision::Double>(contours, reference);
+  ContourGeometry::Measure<GeometryPrecision::Fixed>(contours, fixed);
+
+  for (size_t i = 0; i < reference.size(); ++i) {
+    EXPECT_DOUBLE_EQ(fixed[i].area, reference[i].area) << i;
+    EXPECT_DOUBLE_EQ(fixed[i].centroidX, reference[i].centroidX) << i;
+    EXPECT_DOUBLE_EQ(fixed[i].centroidY, reference[i].centroidY) << i;
+  }
+  EXPECT_DOUBLE_EQ(fixed[0].area, 1000000.0);
+}
@@ -0,0 +1,126 @@
+#include "ShapeDetector/ContourSet.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+
+class ContourSetTest : public ::testing::Test {
+protected:
+  ContourSet contours;
+};
+
+TEST_F(ContourSetTest, StartsEmpty) {
+  EXPECT_TRUE(contours.Empty());
+  EXPECT_EQ(contours.Size(), 0u);
+  EXPECT_EQ(contours.TotalPoints(), 0u);
+}
+
+TEST_F(ContourSetTest, StoresContoursBackToBack) {
+  contours.Append({{1, 2}, {3, 4}, {5, 6}});
+  contours.Append({});
+  contours.Append({{-7, 8}, {9, -10}});
+
+  ASSERT_EQ(contours.Size(), 3u);
+  EXPECT_EQ(contours.TotalPoints(), 5u);
+  EXPECT_EQ(contours.PointCount(0), 3u);
+  EXPECT_EQ(contours.PointCount(1), 0u);
+  EXPECT_EQ(contours.PointCount(2), 2u);
+
+  // Consecutive contours are contiguous apart from the wrap padding, which
+  // repeats the first point
+  EXPECT_EQ(contours.X(2), contours.X(0) + 3 + 2 * ContourSet::WRAP_PADDING);
+  EXPECT_EQ(contours.X(0)[3], 1);
+  EXPECT_EQ(contours.Y(0)[3], 2);
+  EXPECT_EQ(contours.X(2)[0], -7);
+  EXPECT_EQ(contours.Y(2)[1], -10);
+  EXPECT_EQ(contours.At(0, 1).x, 3);
+  EXPECT_EQ(contours.At(0, 1).y, 4);
+}
+
+TEST_F(ContourSetTest, CopiesContourWithStride) {
+  std::vector<Point> points;
+  for (int i = 0; i < 10; ++i)
+    points.emplace_back(i, 2 * i);
+  contours.Append(points);
+
+  std::vector<Point> out = {{99, 99}};
+  contours.CopyTo(0, out);
+  ASSERT_EQ(out.size(), 10u);
+  EXPECT_EQ(out[9].x, 9);
+  EXPECT_EQ(out[9].y, 18);
+
+  contours.CopyTo(0, out, 4);
+  ASSERT_EQ(out.size(), 3u);
+  EXPECT_EQ(out[1].x, 4);
+  EXPECT_EQ(out[2].y, 16);
+}
+
+TEST_F(ContourSetTest, ClearKeepsCapacity) {
+  contours.Append({{1, 1}, {2, 2}, {3, 3}});
+  const size_t bytes = contours.CapacityBytes();
+  contours.Clear();
+
+  EXPECT_TRUE(contours.Empty());
+  EXPECT_EQ(contours.TotalPoints(), 0u);
+  EXPECT_EQ(contours.CapacityBytes(), bytes);
+  contours.Append({{4, 4}});
+  EXPECT_EQ(contours.At(0, 0).x, 4);
+}
+
+TEST_F(ContourSetTest, TracesOpenContourInPlace) {
+  contours.Append({{1, 1}, {2, 2}, {3, 3}});
+  contours.Push(5, 6);
+  contours.Push(7, 8);
+  EXPECT_EQ(contours.OpenPointCount(), 2u);
+  EXPECT_EQ(contours.Size(), 1u);
+  contours.Close();
+
+  ASSERT_EQ(contours.Size(), 2u);
+  EXPECT_EQ(contours.OpenPointCount(), 0u);
+  const ContourView view = contours.View(1);
+  ASSERT_EQ(view.count, 2u);
+  EXPECT_EQ(view.xs[1], 7);
+  EXPECT_EQ(view.ys[0], 6);
+  // Wrap padding follows the view's points
+  EXPECT_EQ(view.xs[2], 5);
+  EXPECT_EQ(view.ys[2], 6);
+
+  contours.Push(9, 9);
+  contours.Discard();
+  EXPECT_EQ(contours.Size(), 2u);
+  EXPECT_EQ(contours.TotalPoints(), 5u);
+}
+
+TEST_F(ContourSetTest, SortsOpenContourLikeVector) {
+  std::vector<Point> points;
+  for (int i = 0; i < 200; ++i)
+    points.emplace_back((i * 37) % 23, (i * 11) % 17);
+  auto byX = [](const Point &a, const Point &b) { return a.x < b.x; };
+
+  contours.Append({{1, 1}});
+  for (const Point &p : points)
+    contours.Push(p.x, p.y);
+  contours.SortOpen(byX);
+  contours.Close();
+  std::sort(points.begin(), points.end(), byX);
+
+  // Ties are left in the same order as std::sort leaves them
+  ASSERT_EQ(contours.PointCount(1), points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(contours.At(1, i).x, points[i].x);
+    EXPECT_EQ(contours.At(1, i).y, points[i].y);
+  }
+  EXPECT_EQ(contours.At(0, 0).x, 1);
+}
+
+TEST_F(ContourSetTest, AppendsStridedContourOfAnotherSet) {
+  ContourSet source;
+  std::vector<Point> points;
+  for (int i = 0; i < 10; ++i)
+    points.emplace_back(i, -i);
+  source.Append(points);
+
+  contours.Append(source, 0, 3);
+  ASSERT_EQ(contours.PointCount(0), 4u);
+  EXPECT_EQ(contours.At(0, 3).x, 9);
+  EXPECT_EQ(contours.At(0, 3).y, -9);
+  EXPECT_EQ(contours.View(0).xs[4], 0);
+}
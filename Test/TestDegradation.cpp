@@ -0,0 +1,178 @@
+#include "ShapeDetector/Degradation.hpp"
+#include "ShapeDetector/ImageProcessor.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <omp.h>
+
+class DegradationTest : public ::testing::Test {
+protected:
+  Image Uniform(int width, int height, int value) {
+    Image image(width, height);
+    for (auto &row : image.pixels) {
+      std::fill(row.begin(), row.end(), value);
+    }
+    return image;
+  }
+
+  double Mean(const Image &image) {
+    double sum = 0.0;
+    for (const auto &row : image.pixels) {
+      for (int value : row) {
+        sum += value;
+      }
+    }
+    return sum / (static_cast<double>(image.width) * image.height);
+  }
+};
+
+TEST_F(DegradationTest, SameSeedGivesIdenticalFrames) {
+  const Image clean = ImageProcessor::CreateTestImage(320, 240);
+  const DegradationConfig config = DegradationConfig::Production();
+
+  Image a = clean, b = clean, c = clean;
+  Degradation::Apply(a, config, 9);
+  Degradation::Apply(b, config, 9);
+  Degradation::Apply(c, config, 10);
+
+  EXPECT_EQ(a.pixels, b.pixels);
+  EXPECT_NE(a.pixels, c.pixels);
+  EXPECT_NE(a.pixels, clean.pixels);
+}
+
+TEST_F(DegradationTest, ResultDoesNotDependOnThreadCount) {
+  const Image clean = ImageProcessor::CreateTestImage(256, 256);
+  const DegradationConfig config = DegradationConfig::Production();
+  const int threads = omp_get_max_threads();
+
+  Image serial = clean, parallel = clean;
+  omp_set_num_threads(1);
+  Degradation::Apply(serial, config, 3);
+  omp_set_num_threads(4);
+  Degradation::Apply(parallel, config, 3);
+  omp_set_num_threads(threads);
+
+  EXPECT_EQ(serial.pixels, parallel.pixels);
+}
+
+TEST_F(DegradationTest, GaussianNoiseHasRequestedSpread) {
+  Image image = Uniform(512, 512, 128);
+  Degradation::AddGaussianNoise(image, 10.0, 1);
+
+  double sum = 0.0, sumSquares = 0.0;
+  for (const auto &row : image.pixels) {
+    for (int value : row) {
+      sum += value - 128;
+      sumSquares += (value - 128.0) * (value - 128.0);
+    }
+  }
+  const double count = 512.0 * 512.0;
+  EXPECT_NEAR(sum / count, 0.0, 0.2);
+  EXPECT_NEAR(std::sqrt(sumSquares / count), 10.0, 0.5);
+}
+
+TEST_F(DegradationTest, SaltAndPepperHitsRequestedFraction) {
+  Image image = Uniform(400, 400, 128);
+  Degradation::AddSaltAndPepper(image, 0.05, 2);
+
+  int salt = 0, pepper = 0;
+  for (const auto &row : image.pixels) {
+    for (int value : row) {
+      salt += value == 255;
+      pepper += value == 0;
+    }
+  }
+  EXPECT_NEAR((salt + pepper) / (400.0 * 400.0), 0.05, 0.005);
+  EXPECT_NEAR(salt, pepper, (salt + pepper) * 0.1);
+}
+
+TEST_F(DegradationTest, BlurPreservesFlatRegionsAndBorders) {
+  Image image = Uniform(64, 48, 200);
+  Degradation::ApplyBlur(image, 2.0);
+
+  for (const auto &row : image.pixels) {
+    for (int value : row) {
+      ASSERT_EQ(value, 200);
+    }
+  }
+
+  // A hard edge becomes a ramp
+  Image edge(64, 8);
+  for (auto &row : edge.pixels) {
+    std::fill(row.begin() + 32, row.end(), 255);
+  }
+  Degradation::ApplyBlur(edge, 2.0);
+  EXPECT_GT(edge.pixels[4][31], 0);
+  EXPECT_LT(edge.pixels[4][32], 255);
+  EXPECT_LT(edge.pixels[4][30], edge.pixels[4][33]);
+}
+
+TEST_F(DegradationTest, IlluminationGradientDarkensOneSide) {
+  Image image = Uniform(200, 200, 200);
+  Degradation::ApplyIlluminationGradient(image, 0.5, 4);
+
+  int brightest = 0, darkest = 255;
+  for (const auto &row : image.pixels) {
+    for (int value : row) {
+      brightest = std::max(brightest, value);
+      darkest = std::min(darkest, value);
+    }
+  }
+  EXPECT_EQ(brightest, 200);
+  EXPECT_EQ(darkest, 100);
+}
+
+TEST_F(DegradationTest, IlluminationStrengthIsClampedToTheUnitRange) {
+  auto extremes = [&](double strength) {
+    Image image = Uniform(64, 48, 200);
+    Degradation::ApplyIlluminationGradient(image, strength, 4);
+    int brightest = 0, darkest = 255;
+    for (const auto &row : image.pixels) {
+      for (int value : row) {
+        brightest = std::max(brightest, value);
+        darkest = std::min(darkest, value);
+      }
+    }
+    return std::pair(darkest, brightest);
+  };
+
+  EXPECT_EQ(extremes(1.5), std::pair(0, 200));
+  EXPECT_EQ(extremes(-0.5), std::pair(200, 200));
+}
+
+TEST_F(DegradationTest, BlockArtifactsKeepBlockMeans) {
+  Image image(64, 64);
+  for (int y = 0; y < 64; ++y) {
+    for (int x = 0; x < 64; ++x) {
+      image.pixels[y][x] = (x * 7 + y * 3) % 256;
+    }
+  }
+  const double before = Mean(image);
+
+  Degradation::ApplyBlockArtifacts(image, 8, 32);
+
+  EXPECT_NEAR(Mean(image), before, 2.0);
+  // Inside a block only a handful of levels survive the quantizer
+  std::vector<int> levels;
+  for (int y = 0; y < 8; ++y) {
+    for (int x = 0; x < 8; ++x) {
+      if (std::find(levels.begin(), levels.end(), image.pixels[y][x]) ==
+          levels.end())
+        levels.push_back(image.pixels[y][x]);
+    }
+  }
+  EXPECT_LE(levels.size(), 4);
+}
+
+TEST_F(DegradationTest, OcclusionsCoverPartOfFrame) {
+  Image image = Uniform(300, 300, 255);
+  Degradation::AddOcclusions(image, 3, 0.2, 11);
+
+  int covered = 0;
+  for (const auto &row : image.pixels) {
+    for (int value : row) {
+      covered += value != 255;
+    }
+  }
+  EXPECT_GT(covered, 0);
+  EXPECT_LE(covered, 3 * 60 * 60);
+}
@@ -0,0 +1,69 @@
+#include "ShapeDetector/Evaluation.hpp"
+#include <gtest/gtest.h>
+
+class EvaluationTest : public ::testing::Test {
+protected:
+  std::vector<Rectangle> truth = {{Point(100, 100), 60, 30, 0.0},
+                                  {Point(300, 200), 40, 40, 0.5}};
+};
+
+TEST_F(EvaluationTest, ExactDetectionsArePerfect) {
+  MatchCounts counts = Evaluation::MatchRectangles(truth, truth);
+  EXPECT_EQ(counts.truePositives, 2);
+  EXPECT_EQ(counts.falsePositives, 0);
+  EXPECT_EQ(counts.falseNegatives, 0);
+  EXPECT_DOUBLE_EQ(counts.Precision(), 1.0);
+  EXPECT_DOUBLE_EQ(counts.Recall(), 1.0);
+  EXPECT_DOUBLE_EQ(counts.F1(), 1.0);
+}
+
+TEST_F(EvaluationTest, ToleratesJitterAndSwappedSides) {
+  std::vector<Rectangle> detected = {{Point(102, 99), 32, 57, 1.57},
+                                     {Point(298, 203), 43, 38, 0.4}};
+  MatchCounts counts = Evaluation::MatchRectangles(detected, truth);
+  EXPECT_EQ(counts.truePositives, 2);
+}
+
+TEST_F(EvaluationTest, CountsMissesAndSpuriousDetections) {
+  std::vector<Rectangle> detected = {{Point(100, 100), 60, 30, 0.0},
+                                     {Point(500, 400), 40, 40, 0.0},
+                                     {Point(300, 200), 90, 90, 0.0}};
+  MatchCounts counts = Evaluation::MatchRectangles(detected, truth);
+  EXPECT_EQ(counts.truePositives, 1);
+  EXPECT_EQ(counts.falsePositives, 2);
+  EXPECT_EQ(counts.falseNegatives, 1);
+  EXPECT_DOUBLE_EQ(counts.Precision(), 1.0 / 3.0);
+  EXPECT_DOUBLE_EQ(counts.Recall(), 0.5);
+}
+
+TEST_F(EvaluationTest, DuplicateDetectionMatchesOnlyOnce) {
+  std::vector<Rectangle> detected = {truth[0], truth[0]};
+  MatchCounts counts = Evaluation::MatchRectangles(detected, {truth[0]});
+  EXPECT_EQ(counts.truePositives, 1);
+  EXPECT_EQ(counts.falsePositives, 1);
+}
+
+TEST_F(EvaluationTest, EllipseAcceptsRadiusBetweenAxes) {
+  std::vector<Ellipse> ellipses = {{Point(200, 200), 20, 40, 0.3}};
+  std::vector<Sphere> circles = {{Point(50, 50), 15, 1.0}};
+
+  std::vector<Sphere> detected = {{Point(201, 199), 30, 0.9},
+                                  {Point(50, 51), 16, 0.9}};
+  MatchCounts counts = Evaluation::MatchSpheres(detected, circles, ellipses);
+  EXPECT_EQ(counts.truePositives, 2);
+
+  detected = {{Point(200, 200), 80, 0.9}};
+  counts = Evaluation::MatchSpheres(detected, {}, ellipses);
+  EXPECT_EQ(counts.truePositives, 0);
+  EXPECT_EQ(counts.falsePositives, 1);
+}
+
+TEST_F(EvaluationTest, EmptySceneHasNothingToGetWrong) {
+  MatchCounts counts = Evaluation::MatchRectangles({}, {});
+  EXPECT_DOUBLE_EQ(counts.Precision(), 1.0);
+  EXPECT_DOUBLE_EQ(counts.Recall(), 1.0);
+
+  counts += Evaluation::MatchRectangles(truth, {});
+  EXPECT_EQ(counts.falsePositives, 2);
+  EXPECT_DOUBLE_EQ(counts.Precision(), 0.0);
+}
@@ -0,0 +1,95 @@
+#include "ShapeDetector/FastMath.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numbers>
+
+class FastMathTest : public ::testing::Test {
+protected:
+  static constexpr int SAMPLES = 20001;
+};
+
+TEST_F(FastMathTest, AcosStaysWithinItsErrorBound) {
+  double worst = 0.0;
+  for (int i = 0; i < SAMPLES; ++i) {
+    const double x = -1.0 + 2.0 * i / (SAMPLES - 1);
+    worst = std::max(worst, std::abs(FastMath::Acos(x) - std::acos(x)));
+  }
+  EXPECT_LT(worst, FastMath::ACOS_MAX_ERROR);
+  // Out of range inputs clamp instead of producing NaN
+  EXPECT_NEAR(FastMath::Acos(1.0 + 1e-12), 0.0, FastMath::ACOS_MAX_ERROR);
+  EXPECT_NEAR(FastMath::Acos(-2.0), std::numbers::pi,
+              FastMath::ACOS_MAX_ERROR);
+}
+
+TEST_F(FastMathTest, Atan2StaysWithinItsErrorBoundInEveryQuadrant) {
+  double worst = 0.0;
+  for (int i = 0; i < SAMPLES; ++i) {
+    const double angle = -std::numbers::pi + 2.0 * std::numbers::pi * i /
+                                                 (SAMPLES - 1);
+    for (double radius : {1e-3, 1.0, 4096.0}) {
+      const double x = radius * std::cos(angle);
+      const double y = radius * std::sin(angle);
+      worst = std::max(worst, std::abs(FastMath::Atan2(y, x) -
+                                       std::atan2(y, x)));
+    }
+  }
+  EXPECT_LT(worst, FastMath::ATAN2_MAX_ERROR);
+  EXPECT_EQ(FastMath::Atan2(0.0, 0.0), 0.0);
+  EXPECT_NEAR(FastMath::Atan2(0.0, -3.0), std::numbers::pi,
+              FastMath::ATAN2_MAX_ERROR);
+}
+
+TEST_F(FastMathTest, SinCosStaysWithinItsErrorBound) {
+  double worst = 0.0;
+  for (int i = 0; i < SAMPLES; ++i) {
+    const double angle = -100.0 + 200.0 * i / (SAMPLES - 1);
+    double sine, cosine;
+    FastMath::SinCos(angle, sine, cosine);
+    worst = std::max({worst, std::abs(sine - std::sin(angle)),
+                      std::abs(cosine - std::cos(angle))});
+  }
+  EXPECT_LT(worst, FastMath::SINCOS_MAX_ERROR);
+}
+
+TEST_F(FastMathTest, CosineTestsMatchAngleThresholds) {
+  // Unit vector at every whole degree against the x axis
+  const double limit = std::cos(30.0 * std::numbers::pi / 180.0);
+  for (int degrees = 0; degrees <= 180; ++degrees) {
+    if (degrees == 30 || degrees == 150)
+      continue; // on the threshold itself
+    const double angle = degrees * std::numbers::pi / 180.0;
+    const double vx = 5.0 * std::cos(angle), vy = 5.0 * std::sin(angle);
+    const bool nearAxis = degrees < 30 || degrees > 150;
+    EXPECT_EQ(FastMath::AbsCosineAbove(2.0, 0.0, vx, vy, limit), nearAxis)
+        << degrees;
+    EXPECT_EQ(FastMath::AbsCosineBelow(2.0, 0.0, vx, vy, limit), !nearAxis)
+        << degrees;
+  }
+
+  // A zero vector is parallel to everything
+  EXPECT_TRUE(FastMath::AbsCosineAbove(0.0, 0.0, 1.0, 2.0, 0.9));
+  EXPECT_FALSE(FastMath::AbsCosineBelow(0.0, 0.0, 1.0, 2.0, 0.9));
+}
+
+TEST_F(FastMathTest, SignedCosineSquaredOrdersLikeTheAngle) {
+  double previous = 2.0;
+  for (int degrees = 0; degrees <= 180; degrees += 5) {
+    const double angle = degrees * std::numbers::pi / 180.0;
+    const double rank = FastMath::SignedCosineSquared(
+        3.0, 0.0, std::cos(angle), std::sin(angle));
+    EXPECT_LT(rank, previous) << degrees;
+    previous = rank;
+  }
+}
+
+TEST_F(FastMathTest, FoldsLineAngleDifferences) {
+  const double pi = std::numbers::pi;
+  EXPECT_NEAR(FastMath::LineAngleDifference(0.1, -0.1), 0.2, 1e-12);
+  // Lines a half turn apart are the same line
+  EXPECT_NEAR(FastMath::LineAngleDifference(0.1, 0.1 + pi), 0.0, 1e-12);
+  EXPECT_NEAR(FastMath::LineAngleDifference(-pi, pi - 0.3), 0.3, 1e-12);
+  EXPECT_NEAR(FastMath::LineAngleDifference(0.0, 7.5 * pi), 0.5 * pi,
+              1e-12);
+  EXPECT_NEAR(FastMath::LineAngleDifference(0.0, 2.0 * pi + 3.0),
+              pi - 3.0, 1e-12);
+}
@@ -147,4 +147,131 @@ TEST_F(ImageProcessorTest, DrawsRectanglesOnImage) {
   }
 
   EXPECT_TRUE(hasDrawnPixels);
-}
\ No newline at end of file
+}
+
+TEST_F(ImageProcessorTest, ExpandsGrayToInterleavedRgb) {
+  // Odd width exercises both the vector body and the scalar tail
+  Image testImage(37, 5);
+  for (int y = 0; y < testImage.height; ++y) {
+    for (int x = 0; x < testImage.width; ++x) {
+      testImage.pixels[y][x] = (x * 7 + y * 31) % 256;
+    }
+  }
+
+  RgbImage rgbImage(37, 5);
+  ImageProcessor::ExpandGrayToRgb(testImage, rgbImage.View());
+
+  for (int y = 0; y < testImage.height; ++y) {
+    for (int x = 0; x < testImage.width; ++x) {
+      const unsigned char *p = &rgbImage.data[(y * 37 + x) * 3];
+      EXPECT_EQ(p[0], testImage.pixels[y][x]);
+      EXPECT_EQ(p[1], testImage.pixels[y][x]);
+      EXPECT_EQ(p[2], testImage.pixels[y][x]);
+    }
+  }
+}
+
+TEST_F(ImageProcessorTest, RgbImageMatchesColorImageRendering) {
+  Image testImage = ImageProcessor::CreateTestImageWithMixedShapes(120, 90);
+
+  Rectangle rect;
+  rect.center = Point(40, 30);
+  rect.width = 30;
+  rect.height = 20;
+  rect.angle = 0.4;
+  Sphere sphere;
+  sphere.center = Point(80, 60);
+  sphere.radius = 15;
+  sphere.confidence = 1.0;
+
+  ColorImage colorImage =
+      ImageProcessor::CreateColorImageWithSpheres(testImage, {rect}, {sphere});
+  RgbImage rgbImage =
+      ImageProcessor::CreateRgbImage(testImage, {rect}, {sphere});
+
+  for (int y = 0; y < testImage.height; ++y) {
+    for (int x = 0; x < testImage.width; ++x) {
+      const ColorPixel &expected = colorImage.pixels[y][x];
+      const unsigned char *p = &rgbImage.data[(y * 120 + x) * 3];
+      ASSERT_EQ(p[0], expected.r);
+      ASSERT_EQ(p[1], expected.g);
+      ASSERT_EQ(p[2], expected.b);
+    }
+  }
+}
+
+TEST_F(ImageProcessorTest, OverlayTouchesOnlyOutlinePixels) {
+  // Caller-owned frame with padded rows, pre-filled with a marker value
+  const int width = 60, height = 40, stride = width * 3 + 16;
+  std::vector<unsigned char> frame(stride * height, 7);
+  RgbView view{frame.data(), width, height, stride};
+
+  Sphere sphere;
+  sphere.center = Point(30, 20);
+  sphere.radius = 10;
+  sphere.confidence = 1.0;
+
+  ImageProcessor::DrawOverlay(view, {}, {sphere});
+
+  int outlinePixels = 0;
+  for (int y = 0; y < height; ++y) {
+    // Row padding must never be written
+    for (int i = width * 3; i < stride; ++i) {
+      EXPECT_EQ(frame[y * stride + i], 7);
+    }
+    for (int x = 0; x < width; ++x) {
+      const unsigned char *p = &frame[y * stride + x * 3];
+      if (p[2] == 255 && p[0] == 0) {
+        outlinePixels++;
+      } else {
+        EXPECT_EQ(p[0], 7);
+      }
+    }
+  }
+
+  EXPECT_GT(outlinePixels, 0);
+  EXPECT_LT(outlinePixels, width * height / 2);
+}
+
+TEST_F(ImageProcessorTest, OverlayEncodingMatchesColorImage) {
+  Image testImage = ImageProcessor::CreateTestImageWithMixedShapes(120, 90);
+
+  Rectangle rect;
+  rect.center = Point(40, 30);
+  rect.width = 30;
+  rect.height = 20;
+  rect.angle = 0.4;
+  Sphere sphere;
+  sphere.center = Point(110, 60);
+  sphere.radius = 15;
+  sphere.confidence = 1.0;
+
+  ColorImage colorImage =
+      ImageProcessor::CreateColorImageWithSpheres(testImage, {rect}, {sphere});
+  ImageProcessor::SavePPMImage(colorImage, "test_expected.ppm");
+
+  Overlay overlay(testImage.width, testImage.height);
+  ImageProcessor::DrawRectangles(overlay, {rect});
+  ImageProcessor::DrawSpheres(overlay, {sphere});
+  ImageProcessor::SavePPMImage(testImage, overlay, "test_overlay.ppm");
+
+  std::ifstream expectedFile("test_expected.ppm", std::ios::binary);
+  std::ifstream overlayFile("test_overlay.ppm", std::ios::binary);
+  std::string expected((std::istreambuf_iterator<char>(expectedFile)),
+                       std::istreambuf_iterator<char>());
+  std::string actual((std::istreambuf_iterator<char>(overlayFile)),
+                     std::istreambuf_iterator<char>());
+
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(expected, actual);
+
+  // Outlines are stored as runs, far fewer than one entry per pixel
+  size_t spans = 0;
+  for (const auto &row : overlay.rows) {
+    spans += row.size();
+  }
+  EXPECT_LT(spans, static_cast<size_t>(testImage.width * testImage.height / 4));
+
+  std::remove("test_expected.ppm");
+  std::remove("test_overlay.ppm");
+}
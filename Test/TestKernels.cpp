@@ -0,0 +1,117 @@
+#include "ShapeDetector/Kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numeric>
+
+class KernelsTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    uint32_t state = 2024;
+    for (auto &row : image.pixels) {
+      for (int &pixel : row) {
+        state = state * 1664525u + 1013904223u;
+        pixel = static_cast<int>(state >> 24);
+      }
+    }
+  }
+
+  // Brute-force window reduction over the interior, border left as filled
+  template <typename Reduce>
+  Image Reference(int size, int fill, Reduce reduce) const {
+    Image result(image.width, image.height);
+    for (auto &row : result.pixels)
+      std::fill(row.begin(), row.end(), fill);
+    const int half = size / 2;
+    for (int y = half; y < image.height - half; ++y) {
+      for (int x = half; x < image.width - half; ++x) {
+        std::vector<int> window;
+        for (int dy = -half; dy <= half; ++dy)
+          for (int dx = -half; dx <= half; ++dx)
+            window.push_back(image.pixels[y + dy][x + dx]);
+        result.pixels[y][x] = reduce(window, image.pixels[y][x]);
+      }
+    }
+    return result;
+  }
+
+  static Image Filled(const Image &like, int fill) {
+    Image result(like.width, like.height);
+    for (auto &row : result.pixels)
+      std::fill(row.begin(), row.end(), fill);
+    return result;
+  }
+
+  Image image{37, 23};
+};
+
+TEST_F(KernelsTest, BuildsGaussianWeightsAtCompileTime) {
+  static_assert(Kernels::GaussianSize(0.5) == 5);
+  static_assert(Kernels::GaussianSize(0.8) == 7);
+  static_assert(Kernels::GaussianSize(1.0) == 7);
+  static_assert(Kernels::GaussianSize(1.2) == 9);
+
+  constexpr auto weights = Kernels::GaussianWeights<7>(0.8);
+  static_assert(weights[3] > weights[2] && weights[2] > weights[1]);
+  EXPECT_NEAR(std::accumulate(weights.begin(), weights.end(), 0.0), 1.0,
+              1e-15);
+  EXPECT_DOUBLE_EQ(weights[0], weights[6]);
+
+  for (double x : {0.0, -0.3, -1.0, -4.5, -18.0, 2.0})
+    EXPECT_NEAR(Kernels::Exp(x), std::exp(x), 1e-14 * std::exp(x)) << x;
+}
+
+TEST_F(KernelsTest, UnrolledBlurMatchesGenericLoops) {
+  for (double sigma : {0.3, 0.5, 0.8, 1.0}) {
+    const std::vector<double> weights = Kernels::GaussianWeights(sigma);
+    const Image generic = Kernels::Convolve(image, weights);
+    const Image unrolled = Kernels::GaussianBlur(image, sigma);
+    EXPECT_EQ(unrolled.pixels, generic.pixels) << sigma;
+  }
+  EXPECT_EQ(Kernels::GaussianBlur<0.8>(image).pixels,
+            Kernels::GaussianBlur(image, 0.8).pixels);
+}
+
+TEST_F(KernelsTest, MorphologyMatchesBruteForce) {
+  for (int size : {3, 5, 7, 9}) {
+    Image dilated = Filled(image, -1);
+    Image eroded = Filled(image, -1);
+    Kernels::Dilate(image, dilated, size);
+    Kernels::Erode(image, eroded, size);
+
+    auto max = [](const std::vector<int> &w, int) {
+      return *std::max_element(w.begin(), w.end());
+    };
+    auto min = [](const std::vector<int> &w, int) {
+      return *std::min_element(w.begin(), w.end());
+    };
+    EXPECT_EQ(dilated.pixels, Reference(size, -1, max).pixels) << size;
+    EXPECT_EQ(eroded.pixels, Reference(size, -1, min).pixels) << size;
+  }
+}
+
+TEST_F(KernelsTest, MedianAndRangeMeanMatchBruteForce) {
+  auto median = [](std::vector<int> w, int) {
+    std::nth_element(w.begin(), w.begin() + w.size() / 2, w.end());
+    return w[w.size() / 2];
+  };
+  auto rangeMean = [](const std::vector<int> &w, int center) {
+    int sum = 0, count = 0;
+    for (int pixel : w) {
+      if (std::abs(pixel - center) < 50) {
+        sum += pixel;
+        count++;
+      }
+    }
+    return sum / count;
+  };
+
+  for (int size : {3, 5, 7, 9}) {
+    Image medians = Filled(image, -1);
+    Image means = Filled(image, -1);
+    Kernels::Median(image, medians, size);
+    Kernels::RangeMean(image, means, size, 50);
+    EXPECT_EQ(medians.pixels, Reference(size, -1, median).pixels) << size;
+    EXPECT_EQ(means.pixels, Reference(size, -1, rangeMean).pixels) << size;
+  }
+}
@@ -0,0 +1,88 @@
+#include "ShapeDetector/LatencyHistogram.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+
+class LatencyHistogramTest : public ::testing::Test {
+protected:
+  // Relative error allowed at 3 significant digits
+  static constexpr double PRECISION = 1e-3;
+
+  LatencyHistogram histogram;
+};
+
+TEST_F(LatencyHistogramTest, EmptyHistogramReportsZero) {
+  EXPECT_EQ(histogram.Count(), 0);
+  EXPECT_EQ(histogram.Max(), 0);
+  EXPECT_EQ(histogram.ValueAtPercentile(99.0), 0);
+  EXPECT_DOUBLE_EQ(histogram.Mean(), 0.0);
+}
+
+TEST_F(LatencyHistogramTest, PercentilesKeepSignificantDigits) {
+  // 1..10000 us in nanoseconds spans several power-of-two buckets
+  for (int64_t us = 1; us <= 10000; ++us)
+    histogram.Record(us * 1000);
+
+  EXPECT_EQ(histogram.Count(), 10000);
+  EXPECT_EQ(histogram.Min(), 1000);
+  EXPECT_EQ(histogram.Max(), 10'000'000);
+  EXPECT_NEAR(histogram.ValueAtPercentile(50.0), 5'000'000,
+              5'000'000 * PRECISION);
+  EXPECT_NEAR(histogram.ValueAtPercentile(99.0), 9'900'000,
+              9'900'000 * PRECISION);
+  EXPECT_NEAR(histogram.ValueAtPercentile(99.9), 9'990'000,
+              9'990'000 * PRECISION);
+  EXPECT_EQ(histogram.ValueAtPercentile(100.0), histogram.Max());
+  EXPECT_NEAR(histogram.Mean(), 5'000'500, 5'000'500 * PRECISION);
+}
+
+TEST_F(LatencyHistogramTest, SingleSpikeShowsOnlyInTheTail) {
+  for (int i = 0; i < 999; ++i)
+    histogram.Record(2'000'000);
+  histogram.Record(80'000'000);
+
+  EXPECT_NEAR(histogram.ValueAtPercentile(99.0), 2'000'000,
+              2'000'000 * PRECISION);
+  EXPECT_NEAR(histogram.ValueAtPercentile(99.95), 80'000'000,
+              80'000'000 * PRECISION);
+  EXPECT_EQ(histogram.Max(), 80'000'000);
+}
+
+TEST_F(LatencyHistogramTest, ClampsValuesOutsideTheRange) {
+  LatencyHistogram small(1, 1000, 2);
+  small.Record(-5);
+  small.Record(1'000'000);
+  EXPECT_EQ(small.Count(), 2);
+  EXPECT_EQ(small.Min(), 0);
+  EXPECT_EQ(small.Max(), 1000);
+}
+
+TEST_F(LatencyHistogramTest, MergeAddsCounts) {
+  LatencyHistogram other;
+  histogram.Record(1000, 3);
+  other.Record(5000, 1);
+  histogram.Merge(other);
+
+  EXPECT_EQ(histogram.Count(), 4);
+  EXPECT_EQ(histogram.Max(), 5000);
+  EXPECT_NEAR(histogram.ValueAtPercentile(75.0), 1000, 1000 * PRECISION);
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.Count(), 0);
+}
+
+TEST_F(LatencyHistogramTest, WritesHdrPercentileDistribution) {
+  for (int64_t i = 1; i <= 1000; ++i)
+    histogram.Record(i * 10'000);
+
+  std::ostringstream out;
+  histogram.WritePercentileDistribution(out, 1e6);
+  const std::string text = out.str();
+
+  EXPECT_EQ(text.find("       Value     Percentile TotalCount "
+                      "1/(1-Percentile)"),
+            0u);
+  EXPECT_NE(text.find("1.000000000000       1000\n"), std::string::npos);
+  EXPECT_NE(text.find("#[Mean    ="), std::string::npos);
+  EXPECT_NE(text.find("Total count    =         1000]"), std::string::npos);
+  EXPECT_NE(text.find("#[Buckets ="), std::string::npos);
+}
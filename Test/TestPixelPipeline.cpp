@@ -0,0 +1,136 @@
+#include "ShapeDetector/PixelPipeline.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+
+class PixelPipelineTest : public ::testing::Test {
+protected:
+  using P = PixelPipeline;
+
+  void SetUp() override {
+    uint32_t state = 7;
+    for (auto &row : image.pixels) {
+      for (int &pixel : row) {
+        state = state * 1664525u + 1013904223u;
+        pixel = static_cast<int>(state >> 24);
+      }
+    }
+  }
+
+  static Image Thresholded(const Image &source, int threshold) {
+    Image result = source;
+    for (auto &row : result.pixels)
+      for (int &pixel : row)
+        pixel = pixel > threshold ? 255 : 0;
+    return result;
+  }
+
+  Image image{41, 29};
+};
+
+TEST_F(PixelPipelineTest, PointwiseChainsRunInOnePass) {
+  const Image mapped = P::Evaluate(P::Threshold(
+      P::Map(P::Input(image), [](int value) { return 255 - value; }), 127));
+
+  for (int y = 0; y < image.height; ++y)
+    for (int x = 0; x < image.width; ++x)
+      EXPECT_EQ(mapped.pixels[y][x], 255 - image.pixels[y][x] > 127 ? 255 : 0);
+  EXPECT_EQ(P::Evaluate(P::Input(image)).pixels, image.pixels);
+}
+
+TEST_F(PixelPipelineTest, FusedBlurMatchesSeparatePasses) {
+  // Unrolled and generic kernel sizes
+  EXPECT_EQ(
+      P::Evaluate(P::Threshold(P::GaussianBlur<0.8>(P::Input(image)), 127))
+          .pixels,
+      Thresholded(Kernels::GaussianBlur<0.8>(image), 127).pixels);
+  EXPECT_EQ(
+      P::Evaluate(P::Threshold(P::GaussianBlur<1.2>(P::Input(image)), 110))
+          .pixels,
+      Thresholded(Kernels::GaussianBlur<1.2>(image), 110).pixels);
+  // Too narrow to blur
+  EXPECT_EQ(P::Evaluate(P::GaussianBlur<0.05>(P::Input(image))).pixels,
+            image.pixels);
+  // A point-wise step below the blur is applied to the values it loads
+  EXPECT_EQ(
+      P::Evaluate(P::GaussianBlur<0.5>(P::Threshold(P::Input(image), 90)))
+          .pixels,
+      Kernels::GaussianBlur<0.5>(Thresholded(image, 90)).pixels);
+}
+
+TEST_F(PixelPipelineTest, SobelFeedsBlurThroughAMaterializedImage) {
+  Image magnitude(image.width, image.height);
+  for (int y = 1; y < image.height - 1; ++y) {
+    for (int x = 1; x < image.width - 1; ++x) {
+      const auto &p = image.pixels;
+      const int gx = -p[y - 1][x - 1] + p[y - 1][x + 1] - 2 * p[y][x - 1] +
+                     2 * p[y][x + 1] - p[y + 1][x - 1] + p[y + 1][x + 1];
+      const int gy = -p[y - 1][x - 1] - 2 * p[y - 1][x] - p[y - 1][x + 1] +
+                     p[y + 1][x - 1] + 2 * p[y + 1][x] + p[y + 1][x + 1];
+      magnitude.pixels[y][x] =
+          std::min(255, static_cast<int>(std::sqrt(gx * gx + gy * gy)));
+    }
+  }
+
+  EXPECT_EQ(P::Evaluate(P::Sobel(P::Input(image))).pixels, magnitude.pixels);
+  EXPECT_EQ(
+      P::Evaluate(P::Threshold(P::GaussianBlur<0.5>(P::Sobel(P::Input(image))),
+                               100))
+          .pixels,
+      Thresholded(Kernels::GaussianBlur<0.5>(magnitude), 100).pixels);
+}
+
+TEST_F(PixelPipelineTest, WindowChainsMatchKernels) {
+  // Closing of a thresholded image; borders pass through each stage
+  const Image binary = Thresholded(image, 127);
+  Image dilated = binary;
+  Image closed = binary;
+  Kernels::Dilate<3>(binary, dilated);
+  Kernels::Erode<3>(dilated, closed);
+  EXPECT_EQ(
+      P::Evaluate(P::Erode<3>(P::Dilate<3>(P::Threshold(P::Input(image), 127))))
+          .pixels,
+      closed.pixels);
+
+  Image median = image;
+  Kernels::Median<3>(image, median);
+  Image filtered = median;
+  Kernels::RangeMean<5>(median, filtered, 50);
+  EXPECT_EQ(P::Evaluate(P::Threshold(
+                            P::RangeMean<5>(P::Median<3>(P::Input(image)), 50),
+                            100))
+                .pixels,
+            Thresholded(filtered, 100).pixels);
+
+  // Images smaller than the window are all border
+  Image thin(3, 2);
+  thin.pixels = {{1, 2, 3}, {4, 5, 6}};
+  EXPECT_EQ(P::Evaluate(P::Dilate<5>(P::Input(thin))).pixels, thin.pixels);
+}
+
+TEST_F(PixelPipelineTest, BandsOfAnyHeightMatchTheWholeFrame) {
+  // One band is the whole frame; thinner ones recompute halos, down to
+  // bands thinner than the halo itself
+  auto check = [&](const auto &expression) {
+    Image whole(image.width, image.height);
+    P::Evaluate(expression, whole, image.height);
+    for (int rows : {1, 2, 3, 5, 8, 13}) {
+      Image banded(image.width, image.height);
+      P::Evaluate(expression, banded, rows);
+      EXPECT_EQ(banded.pixels, whole.pixels) << rows;
+    }
+  };
+
+  check(P::Threshold(P::GaussianBlur<0.8>(P::Input(image)), 127));
+  check(P::Threshold(P::GaussianBlur<1.2>(P::Input(image)), 110));
+  check(P::Threshold(P::GaussianBlur<0.5>(P::Sobel(P::Input(image))), 100));
+  check(P::Erode<3>(P::Dilate<3>(P::Threshold(P::Input(image), 127))));
+  check(P::Threshold(P::RangeMean<5>(P::Median<3>(P::Input(image)), 50), 100));
+  check(P::GaussianBlur<0.8>(P::Erode<5>(P::GaussianBlur<0.5>(
+      P::Threshold(P::Input(image), 60)))));
+
+  using Enhanced = decltype(P::GaussianBlur<0.5>(P::Sobel(P::Input(image))));
+  static_assert(Enhanced::HALO == 3);
+  EXPECT_GE(P::BandRows<decltype(P::Input(image))>(image.width),
+            P::MIN_BAND_ROWS);
+}
@@ -0,0 +1,240 @@
+#include "ShapeDetector/ImageProcessor.hpp"
+#include "ShapeDetector/Rasterizer.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numbers>
+
+class RasterizerTest : public ::testing::Test {
+protected:
+  int CountPixels(const std::vector<Span> &spans) {
+    int count = 0;
+    for (const Span &span : spans) {
+      count += span.x2 - span.x1 + 1;
+    }
+    return count;
+  }
+
+  int CountWhite(const Image &image) {
+    int count = 0;
+    for (int y = 0; y < image.height; ++y) {
+      for (int x = 0; x < image.width; ++x) {
+        if (image.pixels[y][x] == 255)
+          count++;
+      }
+    }
+    return count;
+  }
+};
+
+TEST_F(RasterizerTest, AxisAlignedQuadProducesOneSpanPerRow) {
+  const std::pair<double, double> quad[4] = {
+      {10, 20}, {29, 20}, {29, 39}, {10, 39}};
+  std::vector<Span> spans;
+
+  Rasterizer::ConvexPolygon(quad, 4, 100, 100, spans);
+
+  ASSERT_EQ(spans.size(), 20);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(spans[i].y, 20 + i);
+    EXPECT_EQ(spans[i].x1, 10);
+    EXPECT_EQ(spans[i].x2, 29);
+  }
+}
+
+TEST_F(RasterizerTest, WindingOrderDoesNotMatter) {
+  const std::pair<double, double> clockwise[3] = {{5, 5}, {45, 10}, {20, 40}};
+  const std::pair<double, double> counter[3] = {{20, 40}, {45, 10}, {5, 5}};
+  std::vector<Span> a, b;
+
+  Rasterizer::ConvexPolygon(clockwise, 3, 50, 50, a);
+  Rasterizer::ConvexPolygon(counter, 3, 50, 50, b);
+
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i].x1, b[i].x1);
+    EXPECT_EQ(a[i].x2, b[i].x2);
+  }
+
+  // Area of the triangle is 612.5, pixel count should be close
+  EXPECT_NEAR(CountPixels(a), 612.5, 60);
+}
+
+TEST_F(RasterizerTest, ClipsSpansToImageBounds) {
+  const std::pair<double, double> quad[4] = {
+      {-20, -20}, {70, -20}, {70, 70}, {-20, 70}};
+  std::vector<Span> spans;
+
+  Rasterizer::ConvexPolygon(quad, 4, 50, 40, spans);
+
+  ASSERT_EQ(spans.size(), 40);
+  for (const Span &span : spans) {
+    EXPECT_EQ(span.x1, 0);
+    EXPECT_EQ(span.x2, 49);
+  }
+}
+
+TEST_F(RasterizerTest, ThickDiagonalLineHasNoGaps) {
+  std::vector<Span> spans;
+  Rasterizer::ThickLine(Point(10, 10), Point(80, 50), 4, 100, 100, spans);
+
+  Image image(100, 100);
+  for (const Span &span : spans) {
+    for (int x = span.x1; x <= span.x2; ++x) {
+      image.pixels[span.y][x] = 255;
+    }
+  }
+
+  // Every pixel within two pixels of the centre line must be covered
+  const double length = std::sqrt(70.0 * 70.0 + 40.0 * 40.0);
+  for (int y = 0; y < 100; ++y) {
+    for (int x = 0; x < 100; ++x) {
+      const double t = ((x - 10) * 70.0 + (y - 10) * 40.0) / (length * length);
+      const double distance =
+          std::abs((x - 10) * 40.0 - (y - 10) * 70.0) / length;
+      if (t >= 0.0 && t <= 1.0 && distance <= 2.0) {
+        EXPECT_EQ(image.pixels[y][x], 255) << "gap at " << x << "," << y;
+      }
+    }
+  }
+
+  // Spans on a row never overlap, so nothing is drawn twice
+  EXPECT_EQ(CountPixels(spans), CountWhite(image));
+}
+
+TEST_F(RasterizerTest, FilledShapesUseScanlineFill) {
+  Image image(200, 200);
+
+  ImageProcessor::CreateRotatedRectangle(image, 100, 100, 80, 40,
+                                         std::numbers::pi / 6);
+  EXPECT_NEAR(CountWhite(image), 80 * 40, 80 * 40 * 0.08);
+
+  Image triangle(100, 100);
+  ImageProcessor::DrawFilledTriangle(triangle, Point(10, 10), Point(90, 10),
+                                     Point(10, 90), 255);
+  // Edges are inclusive, so every lattice point of the triangle is covered
+  EXPECT_EQ(CountWhite(triangle), 81 * 82 / 2);
+}
+
+TEST_F(RasterizerTest, FilledCircleMatchesDistanceTest) {
+  for (int radius : {0, 1, 5, 17, 40}) {
+    std::vector<Span> spans;
+    Rasterizer::FilledCircle(50, 45, radius, 100, 90, spans);
+
+    Image image(100, 90);
+    for (const Span &span : spans) {
+      for (int x = span.x1; x <= span.x2; ++x) {
+        image.pixels[span.y][x] = 255;
+      }
+    }
+
+    for (int y = 0; y < 90; ++y) {
+      for (int x = 0; x < 100; ++x) {
+        const int dx = x - 50, dy = y - 45;
+        const bool inside = dx * dx + dy * dy <= radius * radius;
+        ASSERT_EQ(image.pixels[y][x] == 255, inside)
+            << "radius " << radius << " at " << x << "," << y;
+      }
+    }
+
+    // One span per row, in row order
+    for (size_t i = 1; i < spans.size(); ++i) {
+      EXPECT_EQ(spans[i].y, spans[i - 1].y + 1);
+    }
+  }
+}
+
+TEST_F(RasterizerTest, FilledEllipseMatchesRotatedQuadraticTest) {
+  for (double angle : {0.0, 0.3, std::numbers::pi / 4, 2.0}) {
+    Image image(120, 120);
+    ImageProcessor::DrawFilledEllipse(image, 60, 60, 40, 18, angle, 255);
+
+    const double cosA = std::cos(angle), sinA = std::sin(angle);
+    int mismatches = 0;
+    for (int y = 0; y < 120; ++y) {
+      for (int x = 0; x < 120; ++x) {
+        const double dx = x - 60, dy = y - 60;
+        const double u = dx * cosA + dy * sinA;
+        const double v = -dx * sinA + dy * cosA;
+        const bool inside = u * u / (40.0 * 40.0) + v * v / (18.0 * 18.0) <= 1.0;
+        if (inside != (image.pixels[y][x] == 255))
+          mismatches++;
+      }
+    }
+
+    // Only pixels lying exactly on the boundary may round differently
+    EXPECT_LE(mismatches, 2) << "angle " << angle;
+  }
+}
+
+TEST_F(RasterizerTest, AnnulusLeavesHoleAndUsesAtMostTwoSpansPerRow) {
+  std::vector<Span> spans;
+  Rasterizer::Annulus(50, 50, 17.5, 22.5, 100, 100, spans);
+
+  Image image(100, 100);
+  for (const Span &span : spans) {
+    for (int x = span.x1; x <= span.x2; ++x) {
+      image.pixels[span.y][x] = 255;
+    }
+  }
+
+  for (int y = 0; y < 100; ++y) {
+    int spansOnRow = 0;
+    for (const Span &span : spans) {
+      if (span.y == y)
+        spansOnRow++;
+    }
+    EXPECT_LE(spansOnRow, 2);
+
+    for (int x = 0; x < 100; ++x) {
+      const double distance = std::hypot(x - 50.0, y - 50.0);
+      if (distance > 17.5 && distance <= 22.5) {
+        EXPECT_EQ(image.pixels[y][x], 255);
+      } else {
+        EXPECT_EQ(image.pixels[y][x], 0);
+      }
+    }
+  }
+}
+
+TEST_F(RasterizerTest, EllipseOutlineIsClosedRing) {
+  Image image(120, 100);
+  ImageProcessor::DrawEllipse(image, 60, 50, 40, 25, 0.5, 255);
+
+  // A closed outline keeps a 4-connected fill from the centre off the border
+  std::vector<Point> stack = {Point(60, 50)};
+  std::vector<std::vector<bool>> seen(100, std::vector<bool>(120, false));
+  seen[50][60] = true;
+  bool escaped = false;
+  while (!stack.empty() && !escaped) {
+    Point p = stack.back();
+    stack.pop_back();
+    if (p.x == 0 || p.y == 0 || p.x == 119 || p.y == 99) {
+      escaped = true;
+      break;
+    }
+    const Point neighbours[4] = {Point(p.x + 1, p.y), Point(p.x - 1, p.y),
+                                 Point(p.x, p.y + 1), Point(p.x, p.y - 1)};
+    for (const Point &n : neighbours) {
+      if (!seen[n.y][n.x] && image.pixels[n.y][n.x] == 0) {
+        seen[n.y][n.x] = true;
+        stack.push_back(n);
+      }
+    }
+  }
+
+  EXPECT_EQ(image.pixels[50][60], 0);
+  EXPECT_FALSE(escaped);
+  EXPECT_LT(CountWhite(image), 2 * 2 * std::numbers::pi * 40);
+}
+
+TEST_F(RasterizerTest, FillSpansWritesExactlyTheCoveredPixels) {
+  std::vector<Span> spans;
+  Rasterizer::FilledCircle(30, 20, 12, 60, 40, spans);
+
+  Image image(60, 40);
+  Rasterizer::FillSpans(image, spans, 255);
+
+  EXPECT_EQ(CountWhite(image), CountPixels(spans));
+  EXPECT_EQ(image.pixels[20][30], 255);
+  EXPECT_EQ(image.pixels[0][0], 0);
+}
@@ -404,4 +404,219 @@ TEST_F(RectangleDetectorTest, DetectsOnlySquaresAsRectangles) {
     double aspectRatio = static_cast<double>(rect.width) / rect.height;
     EXPECT_NEAR(aspectRatio, 1.0, 0.3); // Squares should have aspect ratio ~1
   }
-}
\ No newline at end of file
+}
+
+TEST_F(RectangleDetectorTest, DetectsOnlyInsideRegionsOfInterest) {
+  Image testImage(300, 200);
+
+  // Rectangle inside the region
+  for (int y = 40; y < 80; ++y) {
+    for (int x = 40; x < 90; ++x) {
+      testImage.pixels[y][x] = 255;
+    }
+  }
+
+  // Rectangle outside the region
+  for (int y = 120; y < 160; ++y) {
+    for (int x = 200; x < 250; ++x) {
+      testImage.pixels[y][x] = 255;
+    }
+  }
+
+  std::vector<RegionOfInterest> regions = {{20, 20, 100, 80}};
+  std::vector<Rectangle> rectangles =
+      detector->DetectRectangles(testImage, regions);
+
+  ASSERT_EQ(rectangles.size(), 1);
+
+  // Results are reported in full-frame coordinates
+  EXPECT_NEAR(rectangles[0].center.x, 65, 3);
+  EXPECT_NEAR(rectangles[0].center.y, 60, 3);
+}
+
+TEST_F(RectangleDetectorTest, ClipsRegionsToImageBounds) {
+  Image testImage(100, 100);
+
+  for (int y = 20; y < 60; ++y) {
+    for (int x = 30; x < 70; ++x) {
+      testImage.pixels[y][x] = 255;
+    }
+  }
+
+  // Region extends beyond the frame, plus an empty region
+  std::vector<RegionOfInterest> regions = {{-50, -50, 200, 200},
+                                           {10, 10, 0, 0}};
+  std::vector<Rectangle> rectangles =
+      detector->DetectRectangles(testImage, regions);
+
+  ASSERT_EQ(rectangles.size(), 1);
+  EXPECT_NEAR(rectangles[0].center.x, 50, 3);
+  EXPECT_NEAR(rectangles[0].center.y, 40, 3);
+
+  EXPECT_TRUE(detector->DetectRectangles(testImage, {}).empty());
+}
+
+TEST_F(RectangleDetectorTest, CountsDuplicatesAcrossOverlappingRegions) {
+  if (!DETECTION_STATS_ENABLED)
+    GTEST_SKIP() << "stats compiled out";
+
+  Image testImage(200, 150);
+  for (int y = 40; y < 80; ++y) {
+    for (int x = 40; x < 90; ++x) {
+      testImage.pixels[y][x] = 255;
+    }
+  }
+
+  // Both regions see the whole rectangle
+  std::vector<RegionOfInterest> regions = {{20, 20, 100, 80},
+                                           {10, 10, 120, 100}};
+  DetectionStats stats;
+  std::vector<Rectangle> rectangles =
+      detector->DetectRectangles(testImage, regions, stats);
+
+  ASSERT_EQ(rectangles.size(), 1);
+  EXPECT_EQ(stats.duplicateOutput, 1);
+  EXPECT_GE(stats.duplicateInput, 2);
+  EXPECT_GT(stats.totalMs, 0.0);
+}
+
+TEST_F(RectangleDetectorTest, ReportsDetectionStats) {
+  if (!DETECTION_STATS_ENABLED)
+    GTEST_SKIP() << "DetectionStats compiled out";
+
+  Image testImage(200, 150);
+  ImageProcessor::CreateRotatedRectangle(testImage, 60, 60, 60, 40, 0.3);
+  ImageProcessor::DrawFilledCircle(testImage, 150, 90, 25, 255);
+
+  DetectionStats stats;
+  std::vector<Rectangle> rectangles =
+      detector->DetectRectangles(testImage, stats);
+
+  ASSERT_EQ(stats.strategyCount, DetectionStats::MAX_STRATEGIES);
+  int contours = 0, accepted = 0, branches = 0, rejections = 0;
+  for (int i = 0; i < stats.strategyCount; ++i) {
+    EXPECT_NE(stats.strategies[i].name, nullptr);
+    contours += stats.strategies[i].contours;
+    accepted += stats.strategies[i].accepted;
+  }
+  for (int count : stats.branches)
+    branches += count;
+  for (int count : stats.rejections)
+    rejections += count;
+
+  // Every classified contour took one approximation branch and was either
+  // accepted or rejected for exactly one reason
+  EXPECT_EQ(stats.duplicateInput, accepted);
+  EXPECT_EQ(stats.duplicateOutput, static_cast<int>(rectangles.size()));
+  EXPECT_EQ(branches, contours);
+  EXPECT_EQ(accepted + rejections, contours);
+  EXPECT_GT(accepted, 0);
+  EXPECT_GT(stats.bytesAllocated, 200u * 150u * sizeof(int));
+  EXPECT_GT(stats.totalMs, 0.0);
+}
+
+TEST_F(RectangleDetectorTest, StatsDoNotChangeResults) {
+  Image testImage = ImageProcessor::CreateTestImage(320, 240);
+
+  DetectionStats first;
+  std::vector<Rectangle> plain = detector->DetectRectangles(testImage);
+  std::vector<Rectangle> instrumented =
+      detector->DetectRectangles(testImage, first);
+  ASSERT_EQ(plain.size(), instrumented.size());
+
+  // A second call accumulates into the same stats
+  DetectionStats twice = first;
+  detector->DetectRectangles(testImage, twice);
+  EXPECT_EQ(twice.duplicateInput, 2 * first.duplicateInput);
+  EXPECT_EQ(twice.strategies[0].contours, 2 * first.strategies[0].contours);
+}
+
+TEST_F(RectangleDetectorTest, RunsOnlySelectedStrategies) {
+  if (!DETECTION_STATS_ENABLED)
+    GTEST_SKIP() << "stats compiled out";
+
+  Image testImage = ImageProcessor::CreateTestImage(200, 150);
+  detector->SetStrategies(
+      {RectangleStrategy::Morphological, RectangleStrategy::Standard});
+
+  DetectionStats stats;
+  detector->DetectRectangles(testImage, stats);
+  EXPECT_GT(stats.strategies[0].contours, 0);
+  EXPECT_EQ(stats.strategies[1].contours, 0);
+  EXPECT_GT(stats.strategies[2].contours, 0);
+  EXPECT_STREQ(stats.strategies[2].name, "morphological");
+
+  detector->SetStrategies({});
+  EXPECT_TRUE(detector->DetectRectangles(testImage).empty());
+}
+
+TEST_F(RectangleDetectorTest, SkipsDisabledApproximationBranches) {
+  if (!DETECTION_STATS_ENABLED)
+    GTEST_SKIP() << "stats compiled out";
+
+  Image testImage = ImageProcessor::CreateTestImage(200, 150);
+  for (ApproximationBranch branch :
+       {ApproximationBranch::Moments, ApproximationBranch::Hough,
+        ApproximationBranch::Curvature, ApproximationBranch::DouglasPeucker,
+        ApproximationBranch::ConvexHull,
+        ApproximationBranch::FinalDouglasPeucker}) {
+    detector->SetApproximationBranch(branch, false);
+  }
+  EXPECT_FALSE(
+      detector->ApproximationBranchEnabled(ApproximationBranch::Moments));
+  // The last fallback always stays on
+  EXPECT_TRUE(detector->ApproximationBranchEnabled(
+      ApproximationBranch::FinalDouglasPeucker));
+
+  DetectionStats stats;
+  detector->DetectRectangles(testImage, stats);
+  EXPECT_GT(stats.Branch(ApproximationBranch::FinalDouglasPeucker), 0);
+  EXPECT_EQ(stats.Branch(ApproximationBranch::Moments), 0);
+  EXPECT_EQ(stats.Branch(ApproximationBranch::Hough), 0);
+  EXPECT_EQ(stats.Branch(ApproximationBranch::Curvature), 0);
+  EXPECT_EQ(stats.Branch(ApproximationBranch::DouglasPeucker), 0);
+  EXPECT_EQ(stats.Branch(ApproximationBranch::ConvexHull), 0);
+}
+
+TEST_F(RectangleDetectorTest, TriesApproximationBranchesInConfiguredOrder) {
+  if (!DETECTION_STATS_ENABLED)
+    GTEST_SKIP() << "stats compiled out";
+
+  // Listed branches go first, the rest keep their default order, and
+  // duplicates and the final fallback are dropped
+  detector->SetApproximationOrder(
+      {ApproximationBranch::ConvexHull, ApproximationBranch::FinalDouglasPeucker,
+       ApproximationBranch::DouglasPeucker, ApproximationBranch::ConvexHull});
+  EXPECT_EQ(detector->ApproximationOrder(),
+            (std::vector<ApproximationBranch>{
+                ApproximationBranch::ConvexHull,
+                ApproximationBranch::DouglasPeucker,
+                ApproximationBranch::Moments, ApproximationBranch::Hough,
+                ApproximationBranch::Curvature}));
+
+  // The convex hull of an axis-aligned rectangle has its four corners, so
+  // it settles every contour before the default first choice is tried
+  Image testImage = ImageProcessor::CreateTestImage(200, 150);
+  DetectionStats stats;
+  EXPECT_FALSE(detector->DetectRectangles(testImage, stats).empty());
+  EXPECT_GT(stats.Branch(ApproximationBranch::ConvexHull), 0);
+  EXPECT_EQ(stats.Branch(ApproximationBranch::Moments), 0);
+}
+
+TEST_F(RectangleDetectorTest, RoutesCircularContoursPastCornerFitting) {
+  if (!DETECTION_STATS_ENABLED)
+    GTEST_SKIP() << "stats compiled out";
+
+  Image testImage(300, 200);
+  ImageProcessor::DrawFilledCircle(testImage, 60, 60, 25, 255);
+  ImageProcessor::DrawFilledCircle(testImage, 150, 100, 40, 255);
+
+  DetectionStats stats;
+  EXPECT_TRUE(detector->DetectRectangles(testImage, stats).empty());
+
+  // The measured radial spread marks both circles, so the moment and Hough
+  // corner fits never run on them
+  EXPECT_GT(stats.strategies[0].contours, 0);
+  EXPECT_EQ(stats.Branch(ApproximationBranch::Moments), 0);
+  EXPECT_EQ(stats.Branch(ApproximationBranch::Hough), 0);
+}
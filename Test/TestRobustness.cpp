@@ -392,4 +392,40 @@ TEST_F(RobustnessTest, HandlesIncompleteRectangles) {
   EXPECT_GE(rectangles.size(), 0);
   EXPECT_LE(rectangles.size(), 3)
       << "Incomplete rectangles should not cause excessive detections";
-}
\ No newline at end of file
+}
+TEST_F(RobustnessTest, CapsWorkOnHugeComponents) {
+  // A 1px mesh is one component whose boundary covers most of the frame
+  Image testImage(400, 400);
+  for (int y = 0; y < 400; ++y) {
+    for (int x = 0; x < 400; ++x) {
+      testImage.pixels[y][x] = (x % 4 && y % 4) ? 0 : 255;
+    }
+  }
+
+  DetectionStats stats;
+  std::vector<Rectangle> rectangles =
+      detector->DetectRectangles(testImage, stats);
+
+  EXPECT_LE(rectangles.size(), 1) << "A mesh is not a set of rectangles";
+  if (DETECTION_STATS_ENABLED) {
+    EXPECT_GT(stats.decimatedContours, 0)
+        << "Oversized boundaries should be subsampled before classification";
+  }
+}
+
+TEST_F(RobustnessTest, HandlesSpiralWithoutDeepRecursion) {
+  // One long thin arm; simplification splits it one point at a time
+  Image testImage(600, 600);
+  for (int y = 0; y < 600; ++y) {
+    for (int x = 0; x < 600; ++x) {
+      const double dx = x - 300.0, dy = y - 300.0;
+      const double turn = std::hypot(dx, dy) / 6.0 -
+                          std::atan2(dy, dx) / (2 * std::numbers::pi);
+      testImage.pixels[y][x] = turn - std::floor(turn) < 0.4 ? 255 : 0;
+    }
+  }
+
+  std::vector<Rectangle> rectangles = detector->DetectRectangles(testImage);
+  EXPECT_LE(rectangles.size(), 2)
+      << "A spiral should not produce many false rectangles";
+}
@@ -0,0 +1,122 @@
+#include "ShapeDetector/SceneGenerator.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+
+class SceneGeneratorTest : public ::testing::Test {
+protected:
+  struct Bound {
+    double x, y, radius;
+  };
+
+  std::vector<Bound> Bounds(const Scene &scene) {
+    std::vector<Bound> bounds;
+    for (const auto &rect : scene.rectangles) {
+      bounds.push_back({static_cast<double>(rect.center.x),
+                        static_cast<double>(rect.center.y),
+                        std::hypot(rect.width, rect.height) / 2.0});
+    }
+    for (const auto &circle : scene.circles) {
+      bounds.push_back({static_cast<double>(circle.center.x),
+                        static_cast<double>(circle.center.y),
+                        static_cast<double>(circle.radius)});
+    }
+    for (const auto &ellipse : scene.ellipses) {
+      bounds.push_back({static_cast<double>(ellipse.center.x),
+                        static_cast<double>(ellipse.center.y),
+                        static_cast<double>(ellipse.radiusX)});
+    }
+    return bounds;
+  }
+
+  int ShapeCount(const Scene &scene) {
+    return static_cast<int>(scene.rectangles.size() + scene.circles.size() +
+                            scene.ellipses.size() + scene.distractors.size());
+  }
+};
+
+TEST_F(SceneGeneratorTest, SameSeedGivesIdenticalScene) {
+  SceneGenerator generator;
+
+  Scene a = generator.Generate(42);
+  Scene b = generator.Generate(42);
+  Scene c = generator.Generate(43);
+
+  EXPECT_EQ(a.image.pixels, b.image.pixels);
+  ASSERT_EQ(a.rectangles.size(), b.rectangles.size());
+  for (size_t i = 0; i < a.rectangles.size(); ++i) {
+    EXPECT_EQ(a.rectangles[i].center.x, b.rectangles[i].center.x);
+    EXPECT_EQ(a.rectangles[i].center.y, b.rectangles[i].center.y);
+    EXPECT_EQ(a.rectangles[i].angle, b.rectangles[i].angle);
+  }
+  EXPECT_NE(a.image.pixels, c.image.pixels);
+}
+
+TEST_F(SceneGeneratorTest, PlacesRequestedShapesAtLowDensity) {
+  SceneGenerator generator;
+  const SceneConfig &config = generator.Config();
+
+  for (uint64_t seed = 0; seed < 10; ++seed) {
+    Scene scene = generator.Generate(seed);
+    EXPECT_EQ(scene.rectangles.size(), config.rectangleCount);
+    EXPECT_EQ(scene.circles.size(), config.circleCount);
+    EXPECT_EQ(scene.ellipses.size(), config.ellipseCount);
+    EXPECT_EQ(scene.distractors.size(), config.distractorCount);
+  }
+}
+
+TEST_F(SceneGeneratorTest, ShapesDoNotOverlapAndStayInFrame) {
+  SceneConfig config;
+  config.rectangleCount = 30;
+  config.circleCount = 30;
+  config.ellipseCount = 30;
+  SceneGenerator generator(config);
+
+  Scene scene = generator.Generate(7);
+  std::vector<Bound> bounds = Bounds(scene);
+
+  for (size_t i = 0; i < bounds.size(); ++i) {
+    EXPECT_GE(bounds[i].x - bounds[i].radius, 0);
+    EXPECT_GE(bounds[i].y - bounds[i].radius, 0);
+    EXPECT_LE(bounds[i].x + bounds[i].radius, config.width);
+    EXPECT_LE(bounds[i].y + bounds[i].radius, config.height);
+    for (size_t j = i + 1; j < bounds.size(); ++j) {
+      const double distance =
+          std::hypot(bounds[i].x - bounds[j].x, bounds[i].y - bounds[j].y);
+      EXPECT_GE(distance, bounds[i].radius + bounds[j].radius + config.spacing);
+    }
+  }
+}
+
+TEST_F(SceneGeneratorTest, FillsLargeFrameWithThousandsOfShapes) {
+  SceneConfig config;
+  config.width = 4096;
+  config.height = 4096;
+  config.rectangleCount = 2000;
+  config.circleCount = 2000;
+  config.ellipseCount = 1000;
+  config.distractorCount = 1000;
+  config.minSize = 12;
+  config.maxSize = 30;
+  config.spacing = 4;
+  SceneGenerator generator(config);
+
+  Scene scene = generator.Generate(1);
+
+  EXPECT_GT(ShapeCount(scene), 5000);
+  EXPECT_EQ(scene.image.pixels[scene.circles[0].center.y]
+                              [scene.circles[0].center.x],
+            config.foreground);
+}
+
+TEST_F(SceneGeneratorTest, BatchMatchesIndividualFrames) {
+  SceneGenerator generator;
+
+  std::vector<Scene> batch = generator.GenerateBatch(100, 6);
+
+  ASSERT_EQ(batch.size(), 6);
+  for (int i = 0; i < 6; ++i) {
+    Scene single = generator.Generate(100 + i);
+    EXPECT_EQ(batch[i].image.pixels, single.image.pixels);
+    EXPECT_EQ(ShapeCount(batch[i]), ShapeCount(single));
+  }
+}
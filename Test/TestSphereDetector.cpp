@@ -458,4 +458,63 @@ TEST_F(ObloidDetectorTest, VerifiesObloidGeometry) {
     EXPECT_GE(obloid.confidence, 0.0);
     EXPECT_LE(obloid.confidence, 1.0);
   }
-}
\ No newline at end of file
+}
+
+TEST_F(ObloidDetectorTest, DetectsOnlyInsideRegionsOfInterest) {
+  Image testImage = CreateImageWithCircle(300, 200, 70, 60, 25);
+  ImageProcessor::DrawFilledCircle(testImage, 220, 140, 25, 255);
+
+  std::vector<RegionOfInterest> regions = {{150, 90, 140, 100}};
+  std::vector<Sphere> spheres = detector->DetectSpheres(testImage, regions);
+
+  ASSERT_EQ(spheres.size(), 1);
+
+  // Results are reported in full-frame coordinates
+  EXPECT_NEAR(spheres[0].center.x, 220, 3);
+  EXPECT_NEAR(spheres[0].center.y, 140, 3);
+  EXPECT_NEAR(spheres[0].radius, 25, 5);
+}
+
+TEST_F(ObloidDetectorTest, CountsDuplicatesAcrossOverlappingRegions) {
+  if (!DETECTION_STATS_ENABLED)
+    GTEST_SKIP() << "DetectionStats compiled out";
+
+  Image testImage = CreateImageWithCircle(300, 200, 70, 60, 25);
+
+  // Both regions see the whole circle
+  std::vector<RegionOfInterest> regions = {{30, 20, 90, 90},
+                                           {20, 10, 110, 110}};
+  DetectionStats stats;
+  std::vector<Sphere> spheres =
+      detector->DetectSpheres(testImage, regions, stats);
+
+  ASSERT_EQ(spheres.size(), 1);
+  EXPECT_EQ(stats.duplicateOutput, 1);
+  EXPECT_GE(stats.duplicateInput, 2);
+  EXPECT_GT(stats.totalMs, 0.0);
+}
+
+TEST_F(ObloidDetectorTest, ReportsDetectionStats) {
+  if (!DETECTION_STATS_ENABLED)
+    GTEST_SKIP() << "DetectionStats compiled out";
+
+  Image testImage = CreateImageWithCircle(300, 200, 70, 60, 25);
+  ImageProcessor::DrawFilledCircle(testImage, 220, 140, 4, 255);
+  ImageProcessor::DrawFilledTriangle(testImage, Point(150, 20), Point(220, 20),
+                                     Point(185, 80), 255);
+
+  DetectionStats stats;
+  std::vector<Sphere> spheres = detector->DetectSpheres(testImage, stats);
+
+  ASSERT_EQ(stats.strategyCount, 1);
+  EXPECT_STREQ(stats.strategies[0].name, "obloid");
+  EXPECT_EQ(stats.duplicateOutput, static_cast<int>(spheres.size()));
+  EXPECT_EQ(stats.strategies[0].accepted, stats.duplicateInput);
+
+  int rejections = 0;
+  for (int count : stats.rejections)
+    rejections += count;
+  EXPECT_EQ(stats.strategies[0].accepted + rejections,
+            stats.strategies[0].contours);
+  EXPECT_GT(rejections, 0);
+}
@@ -0,0 +1,110 @@
+#include "ShapeDetector/ImageProcessor.hpp"
+#include "ShapeDetector/RectangleDetector.hpp"
+#include "ShapeDetector/Trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <omp.h>
+#include <set>
+#include <sstream>
+
+class TraceTest : public ::testing::Test {
+protected:
+  void TearDown() override { Trace::Stop(); }
+
+  int Count(const std::vector<TraceEvent> &events, const char *name) {
+    return static_cast<int>(
+        std::count_if(events.begin(), events.end(), [&](const TraceEvent &e) {
+          return std::strcmp(e.name, name) == 0;
+        }));
+  }
+};
+
+TEST_F(TraceTest, RecordsNestedSpans) {
+  Trace::Start();
+  {
+    TraceSpan outer("outer", "test");
+    TraceSpan inner("inner", "test");
+  }
+  Trace::Stop();
+
+  std::vector<TraceEvent> events = Trace::Events();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_STREQ(events[0].name, "outer");
+  EXPECT_STREQ(events[1].name, "inner");
+  EXPECT_GE(events[1].startNs, events[0].startNs);
+  EXPECT_LE(events[1].startNs + events[1].durationNs,
+            events[0].startNs + events[0].durationNs);
+}
+
+TEST_F(TraceTest, IgnoresSpansWhileStopped) {
+  Trace::Start();
+  Trace::Stop();
+  { TraceSpan span("ignored", "test"); }
+  EXPECT_TRUE(Trace::Events().empty());
+}
+
+TEST_F(TraceTest, StartDiscardsPreviousTrace) {
+  Trace::Start();
+  { TraceSpan span("first", "test"); }
+  Trace::Start();
+  { TraceSpan span("second", "test"); }
+  Trace::Stop();
+
+  std::vector<TraceEvent> events = Trace::Events();
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_STREQ(events[0].name, "second");
+}
+
+TEST_F(TraceTest, KeepsThreadsApart) {
+  int threads = 0;
+  Trace::Start();
+#pragma omp parallel num_threads(4)
+  {
+#pragma omp single
+    threads = omp_get_num_threads();
+    TraceSpan span("work", "test");
+  }
+  Trace::Stop();
+
+  std::vector<TraceEvent> events = Trace::Events();
+  std::set<int> ids;
+  for (const auto &event : events)
+    ids.insert(event.thread);
+  EXPECT_EQ(static_cast<int>(events.size()), threads);
+  EXPECT_EQ(static_cast<int>(ids.size()), threads);
+}
+
+TEST_F(TraceTest, DetectorEmitsPipelineSpans) {
+  if (!SHAPE_DETECTOR_TRACE)
+    GTEST_SKIP() << "spans compiled out";
+
+  Image image = ImageProcessor::CreateTestImage(200, 150);
+  RectangleDetector detector;
+  Trace::Start();
+  detector.DetectRectangles(image);
+  Trace::Stop();
+
+  std::vector<TraceEvent> events = Trace::Events();
+  EXPECT_EQ(Count(events, "DetectRectangles"), 1);
+  EXPECT_EQ(Count(events, "FindContours"), 5);
+  EXPECT_EQ(Count(events, "RemoveDuplicateRectangles"), 1);
+  EXPECT_EQ(Count(events, "standard"), 1);
+  EXPECT_EQ(Count(events, "aggressive"), 1);
+  EXPECT_GT(Count(events, "ClassifyContour"), 0);
+  EXPECT_GT(Count(events, "ApplyGaussianBlur"), 0);
+}
+
+TEST_F(TraceTest, WritesChromeTraceJson) {
+  Trace::Start();
+  { TraceSpan span("exported", "test"); }
+  Trace::Stop();
+
+  std::ostringstream out;
+  Trace::WriteChromeJson(out);
+  const std::string json = out.str();
+  EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(json.find("\"name\": \"exported\""), std::string::npos);
+  EXPECT_NE(json.find("\"ph\": \"X\""), std::string::npos);
+  EXPECT_NE(json.find("\"thread_name\""), std::string::npos);
+}